@@ -16,7 +16,9 @@
  * Author: Tim Schubert <ns-3-leo@timschubert.net>
  */
 
+#include <chrono>
 #include <iostream>
+#include <thread>
 
 #include "ns3/core-module.h"
 #include "ns3/mobility-module.h"
@@ -33,6 +35,12 @@ EchoTxRx (std::string context, const Ptr< const Packet > packet, const TcpHeader
   std::cout << Simulator::Now () << ":" << context << ":" << packet->GetUid() << ":" << socket->GetNode () << ":" << header.GetSequenceNumber () << std::endl;
 }
 
+static void
+CountPacket (uint64_t *count, Ptr<const Packet> packet)
+{
+  (*count) ++;
+}
+
 NS_LOG_COMPONENT_DEFINE ("LeoBulkSendTracingExample");
 
 int main (int argc, char *argv[])
@@ -51,6 +59,7 @@ int main (int argc, char *argv[])
   double duration = 100;
   bool islEnabled = true;
   bool pcap = false;
+  bool checksum = false;
   uint64_t ttlThresh = 0;
   std::string routingProto = "aodv";
 
@@ -61,6 +70,8 @@ int main (int argc, char *argv[])
   cmd.AddValue("source", "Traffic source", source);
   cmd.AddValue("destination", "Traffic destination", destination);
   cmd.AddValue("islRate", "ns3::MockNetDevice::DataRate");
+  cmd.AddValue("linkCache", "ns3::MockChannel::LinkCacheSize");
+  cmd.AddValue("framing", "ns3::MockNetDevice::FramingMode");
   cmd.AddValue("constellation", "LEO constellation link settings name", constellation);
   cmd.AddValue("routing", "Routing protocol", routingProto);
   cmd.AddValue("islEnabled", "Enable inter-satellite links", islEnabled);
@@ -70,8 +81,11 @@ int main (int argc, char *argv[])
   cmd.AddValue("destOnly", "ns3::aodv::RoutingProtocol::DestinationOnly");
   cmd.AddValue("routeTimeout", "ns3::aodv::RoutingProtocol::ActiveRouteTimeout");
   cmd.AddValue("pcap", "Enable packet capture", pcap);
+  cmd.AddValue("checksum", "Compute and check checksums and FCS", checksum);
   cmd.Parse (argc, argv);
 
+  GlobalValue::Bind ("ChecksumEnabled", BooleanValue (checksum));
+
   std::streambuf *coutbuf = std::cout.rdbuf();
   // redirect cout if traceFile
   std::ofstream out;
@@ -166,10 +180,32 @@ int main (int argc, char *argv[])
   std::cerr << "LOCAL =" << users.Get (0)->GetId () << std::endl;
   std::cerr << "REMOTE=" << users.Get (1)->GetId () << ",addr=" << Ipv4Address::ConvertFrom (remote) << std::endl;
 
+  uint64_t packets = 0;
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::MockNetDevice/PhyTxBegin",
+                                 MakeBoundCallback (&CountPacket, &packets));
+
   NS_LOG_INFO ("Run Simulation.");
   Simulator::Stop (Seconds (duration));
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
   Simulator::Run ();
+  double wall = std::chrono::duration<double, std::nano> (std::chrono::steady_clock::now () - start).count ();
   Simulator::Destroy ();
+
+  // compare runs with and without --checksum to see the cost of the FCS,
+  // only within the same build profile and on the same machine
+#if defined (NS3_BUILD_PROFILE_OPTIMIZED)
+  std::string profile = "optimized";
+#elif defined (NS3_BUILD_PROFILE_RELEASE)
+  std::string profile = "release";
+#elif defined (NS3_BUILD_PROFILE_DEBUG)
+  std::string profile = "debug";
+#else
+  std::string profile = "unknown";
+#endif
+  std::cerr << "CHECKSUM=" << checksum << ",PACKETS=" << packets
+            << ",NS_PER_PACKET=" << (packets > 0 ? wall / packets : 0)
+            << ",PROFILE=" << profile
+            << ",THREADS=" << std::thread::hardware_concurrency () << std::endl;
   NS_LOG_INFO ("Done.");
 
   Ptr<PacketSink> sink1 = DynamicCast<PacketSink> (sinkApps.Get (0));
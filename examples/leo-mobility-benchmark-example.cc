@@ -0,0 +1,130 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tim Schubert <ns-3-leo@timschubert.net>
+ */
+
+#include <chrono>
+#include <thread>
+
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/leo-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("LeoMobilityBenchmarkExample");
+
+/**
+ * Read the positions of some satellites, like the channels would do for
+ * transmissions
+ */
+static void
+Probe (NodeContainer satellites, uint32_t probes, Time interval, double *sum)
+{
+  for (uint32_t i = 0; i < probes; i ++)
+    {
+      Ptr<Node> node = satellites.Get ((i * 7919) % satellites.GetN ());
+      *sum += node->GetObject<MobilityModel> ()->GetPosition ().x;
+    }
+  Simulator::Schedule (interval, &Probe, satellites, probes, interval, sum);
+}
+
+/**
+ * Simulate the constellation with an update mode and print the number of
+ * events and the wall clock time
+ *
+ * Periodic uses one update event per satellite, Clock one per constellation.
+ */
+static void
+Run (std::string mode, std::string orbitFile, Time duration, uint32_t probes, Time interval)
+{
+  Config::SetDefault ("ns3::LeoCircularOrbitMobilityModel::UpdateMode",
+                      StringValue (mode == "Lazy" ? "Lazy" : "Periodic"));
+
+  LeoOrbitNodeHelper orbit;
+  orbit.SetUseClock (mode == "Clock");
+  NodeContainer satellites;
+  if (!orbitFile.empty())
+    {
+      satellites = orbit.Install (orbitFile);
+    }
+  else
+    {
+      satellites = orbit.Install ({ LeoOrbit (1200, 20, 32, 16),
+                                    LeoOrbit (1180, 30, 12, 10) });
+    }
+
+  double sum = 0;
+  if (probes > 0)
+    {
+      Simulator::Schedule (interval, &Probe, satellites, probes, interval, &sum);
+    }
+
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now ();
+  Simulator::Stop (duration);
+  Simulator::Run ();
+  double wall = std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+  uint64_t events = Simulator::GetEventCount ();
+  Simulator::Destroy ();
+
+  std::cout << mode << ","
+            << satellites.GetN () << ","
+            << events << ","
+            << wall << ","
+            << events / wall << ","
+            << duration.GetSeconds () / wall << std::endl;
+}
+
+/**
+ * Name of the build profile, the results are only comparable within the
+ * same profile
+ */
+static std::string
+BuildProfile (void)
+{
+#if defined (NS3_BUILD_PROFILE_OPTIMIZED)
+  return "optimized";
+#elif defined (NS3_BUILD_PROFILE_RELEASE)
+  return "release";
+#elif defined (NS3_BUILD_PROFILE_DEBUG)
+  return "debug";
+#else
+  return "unknown";
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+  CommandLine cmd;
+  std::string orbitFile;
+  std::string duration = "3600s";
+  std::string interval = "1s";
+  uint32_t probes = 100;
+  cmd.AddValue("orbitFile", "CSV file with orbit parameters", orbitFile);
+  cmd.AddValue("duration", "Duration of the simulation in seconds", duration);
+  cmd.AddValue("probes", "Number of satellites whose positions are read every interval", probes);
+  cmd.AddValue("interval", "Time between two reads of the positions", interval);
+  cmd.AddValue("precision", "ns3::LeoCircularOrbitMobilityModel::Precision");
+  cmd.Parse (argc, argv);
+
+  std::cout << "# build profile " << BuildProfile () << ", "
+            << std::thread::hardware_concurrency () << " hardware threads" << std::endl;
+  std::cout << "Mode,Satellites,Events,WallTime,EventsPerSecond,SimulatedSecondsPerSecond" << std::endl;
+  for (std::string mode : { "Periodic", "Clock", "Lazy" })
+    {
+      Run (mode, orbitFile, Time (duration), probes, Time (interval));
+    }
+}
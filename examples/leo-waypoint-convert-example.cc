@@ -0,0 +1,51 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tim Schubert <ns-3-leo@timschubert.net>
+ */
+
+#include <iostream>
+
+#include "ns3/core-module.h"
+#include "ns3/leo-module.h"
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("LeoWaypointConvertExample");
+
+int main (int argc, char *argv[])
+{
+  CommandLine cmd;
+  std::string input;
+  std::string output;
+  cmd.AddValue ("input", "Text waypoint file", input);
+  cmd.AddValue ("output", "Binary waypoint file, defaults to the input with the suffix .bin", output);
+  cmd.Parse (argc, argv);
+
+  if (input.empty ())
+    {
+      std::cerr << "No input file given" << std::endl;
+      return 1;
+    }
+  if (output.empty ())
+    {
+      output = input + ".bin";
+    }
+
+  uint64_t n = LeoWaypointBinaryFile::Convert (input, output);
+  std::cout << input << ": " << n << " waypoints" << std::endl;
+
+  return 0;
+}
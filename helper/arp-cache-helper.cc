@@ -16,11 +16,14 @@
  * Author: Tim Schubert <ns-3-leo@timschubert.net>
  */
 
+#include <map>
+
 #include "ns3/core-module.h"
 #include "ns3/network-module.h"
 #include "ns3/internet-module.h"
 #include "ns3/log.h"
 #include "../model/leo-mock-net-device.h"
+#include "../model/mock-arp-table.h"
 
 #include "arp-cache-helper.h"
 
@@ -34,33 +37,59 @@ ArpCacheHelper::Install (NetDeviceContainer &devices, Ipv4InterfaceContainer &in
 {
   NS_LOG_FUNCTION (this);
 
-  for (size_t i = 0; i < devices.GetN (); i ++)
+  // devices of the same type do not talk to each other, devices that are
+  // no LeoMockNetDevices all talk to each other
+  std::vector<int> types (devices.GetN ());
+  std::map<int, Ptr<MockArpTable> > tables;
+  for (uint32_t i = 0; i < devices.GetN (); i ++)
+    {
+      Ptr<LeoMockNetDevice> leoDev = DynamicCast<LeoMockNetDevice> (devices.Get (i));
+      types[i] = leoDev != 0 ? leoDev->GetDeviceType () : -1;
+      if (tables.find (types[i]) == tables.end ())
+        {
+          tables[types[i]] = CreateObject<MockArpTable> ();
+        }
+    }
+
+  // one table per side, so that the number of entries grows linearly
+  for (std::pair<const int, Ptr<MockArpTable> > &table : tables)
+    {
+      for (uint32_t j = 0; j < devices.GetN (); j ++)
+        {
+          if (types[j] == table.first && table.first != -1)
+            {
+              continue;
+            }
+          table.second->Add (interfaces.GetAddress (j, 0), devices.Get (j)->GetAddress ());
+        }
+      NS_LOG_INFO ("ARP table of side " << table.first << " with " << table.second->GetN () << " entries");
+    }
+
+  for (uint32_t i = 0; i < devices.GetN (); i ++)
     {
       Ptr<NetDevice> dev = devices.Get (i);
+      Ptr<MockNetDevice> mockDev = DynamicCast<MockNetDevice> (dev);
+      if (mockDev != 0)
+        {
+          // the cache is filled on demand from the table
+          mockDev->SetArpTable (tables[types[i]]);
+          continue;
+        }
+
       Ptr<Node> node = dev->GetNode ();
       NS_LOG_INFO ("Preparing ARP cache of " << node);
       Ptr<Ipv4L3Protocol> ipv4 = node->GetObject<Ipv4L3Protocol> ();
       int32_t ifIndex = ipv4->GetInterfaceForDevice (dev);
-      Ptr<Ipv4Interface> interface = ipv4->GetInterface (ifIndex);
-      Ptr<ArpCache> cache = interface->GetArpCache ();
+      Ptr<ArpCache> cache = ipv4->GetInterface (ifIndex)->GetArpCache ();
 
-      for (uint32_t j = 0; j < devices.GetN (); j++)
+      for (uint32_t j = 0; j < devices.GetN (); j ++)
         {
-          // every other device, that is not of same "type"
-          Ptr<NetDevice> otherDevice = devices.Get (j);
-          Ptr<LeoMockNetDevice> leoDev = DynamicCast<LeoMockNetDevice> (dev);
-          Ptr<LeoMockNetDevice> otherLeoDev = DynamicCast<LeoMockNetDevice> (otherDevice);
-          if (i == j || (leoDev != 0
-              && otherLeoDev != 0
-              && leoDev->GetDeviceType () == otherLeoDev->GetDeviceType ()))
+          if (j == i || (types[j] == types[i] && types[i] != -1))
             {
               continue;
             }
-          Address address = otherDevice->GetAddress (); // MAC
-
-          // and associated address
-          uint32_t otherIfIndex = otherDevice->GetIfIndex ();
-          Ipv4Address ipaddr = interfaces.GetAddress (otherIfIndex, 0); // IP
+          Address address = devices.Get (j)->GetAddress (); // MAC
+          Ipv4Address ipaddr = interfaces.GetAddress (j, 0); // IP
 
           // update cache
           ArpCache::Entry* entry = cache->Lookup (ipaddr);
@@ -70,8 +99,8 @@ ArpCacheHelper::Install (NetDeviceContainer &devices, Ipv4InterfaceContainer &in
             }
           entry->SetMacAddress (address);
 
-	  NS_LOG_DEBUG ("Added entry for " << address);
-      	}
+          NS_LOG_DEBUG ("Added entry for " << address);
+        }
     }
 }
 
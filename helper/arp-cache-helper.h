@@ -36,6 +36,14 @@ namespace ns3 {
 /**
  * \ingroup leo
  * \brief Prepares the ARP cache, so the addresses do not have to be queried
+ *
+ * Each MockNetDevice gets a MockArpTable with the addresses of all devices
+ * on the other side of the channel. The table is shared by all devices on
+ * the same side, and the device answers the ARP requests for these
+ * addresses itself. The entries of the ARP caches are only created for the
+ * neighbours that are actually used, so the memory grows linearly with the
+ * number of devices. Requests for other addresses are sent over the
+ * channel. The caches of other devices are filled with all addresses.
  */
 class ArpCacheHelper
 {
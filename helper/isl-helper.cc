@@ -28,9 +28,12 @@
 #include "ns3/names.h"
 #include "ns3/trace-helper.h"
 #include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/net-device-queue-interface.h"
 
 #include "../model/mock-net-device.h"
 #include "../model/isl-mock-channel.h"
+#include "../model/mock-tx-scheduler.h"
 #include "isl-helper.h"
 
 namespace ns3 {
@@ -38,12 +41,14 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("IslHelper");
 
 IslHelper::IslHelper ()
+  : m_nTxQueues (1)
 {
   m_queueFactory.SetTypeId ("ns3::DropTailQueue<Packet>");
   m_deviceFactory.SetTypeId ("ns3::MockNetDevice");
   m_channelFactory.SetTypeId ("ns3::IslMockChannel");
   m_channelFactory.Set ("PropagationDelay", StringValue ("ns3::ConstantSpeedPropagationDelayModel"));
   m_channelFactory.Set ("PropagationLoss", StringValue ("ns3::IslPropagationLossModel"));
+  m_queueInterfaceFactory.SetTypeId ("ns3::NetDeviceQueueInterface");
 }
 
 void
@@ -74,6 +79,31 @@ IslHelper::SetChannelAttribute (std::string n1, const AttributeValue &v1)
   m_channelFactory.Set (n1, v1);
 }
 
+void
+IslHelper::SetContactPlan (std::string n1, const AttributeValue &v1,
+                           std::string n2, const AttributeValue &v2,
+                           std::string n3, const AttributeValue &v3)
+{
+  m_contactPlanFactory.SetTypeId ("ns3::LeoContactPlan");
+  m_contactPlanFactory.Set (n1, v1);
+  m_contactPlanFactory.Set (n2, v2);
+  m_contactPlanFactory.Set (n3, v3);
+}
+
+void
+IslHelper::SetTxScheduler (uint32_t n,
+                           std::string type,
+                           std::string n1, const AttributeValue &v1,
+                           std::string n2, const AttributeValue &v2)
+{
+  NS_ASSERT_MSG (n > 0, "A device needs at least one transmit queue");
+  m_nTxQueues = n;
+  m_queueInterfaceFactory.Set ("NTxQueues", UintegerValue (n));
+  m_txSchedulerFactory.SetTypeId (type);
+  m_txSchedulerFactory.Set (n1, v1);
+  m_txSchedulerFactory.Set (n2, v2);
+}
+
 void
 IslHelper::EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, bool promiscuous, bool explicitFilename)
 {
@@ -228,24 +258,114 @@ IslHelper::Install (std::vector<Ptr<Node> > &nodes)
   NS_LOG_FUNCTION (this);
 
   Ptr<MockChannel> channel = m_channelFactory.Create<MockChannel> ();
+  if (m_contactPlanFactory.IsTypeIdSet ())
+    {
+      channel->SetContactPlan (m_contactPlanFactory.Create<LeoContactPlan> ());
+    }
+  channel->Reserve (nodes.size ());
 
   NetDeviceContainer container;
 
   for (Ptr<Node> node: nodes)
   {
     NS_LOG_DEBUG ("Adding device for node " << node->GetId ());
-    Ptr<MockNetDevice> dev = m_deviceFactory.Create<MockNetDevice> ();
-    dev->SetAddress (Mac48Address::Allocate ());
-    node->AddDevice (dev);
-    Ptr<Queue<Packet> > queue = m_queueFactory.Create<Queue<Packet> > ();
-    dev->SetQueue (queue);
-    dev->Attach (channel);
-    container.Add (dev);
+    container.Add (InstallDevice (node, channel));
   }
 
   return container;
 }
 
+Ptr<NetDevice>
+IslHelper::InstallDevice (Ptr<Node> node, Ptr<MockChannel> channel)
+{
+  Ptr<MockNetDevice> dev = m_deviceFactory.Create<MockNetDevice> ();
+  dev->SetAddress (Mac48Address::Allocate ());
+  node->AddDevice (dev);
+  if (m_nTxQueues == 1)
+    {
+      dev->SetQueue (m_queueFactory.Create<Queue<Packet> > ());
+    }
+  else
+    {
+      std::vector<Ptr<Queue<Packet> > > queues;
+      queues.reserve (m_nTxQueues);
+      for (uint32_t i = 0; i < m_nTxQueues; i ++)
+        {
+          queues.push_back (m_queueFactory.Create<Queue<Packet> > ());
+        }
+      dev->SetQueues (queues);
+      dev->AggregateObject (m_queueInterfaceFactory.Create<NetDeviceQueueInterface> ());
+    }
+  if (m_txSchedulerFactory.IsTypeIdSet ())
+    {
+      dev->SetTxScheduler (m_txSchedulerFactory.Create<MockTxScheduler> ());
+    }
+  dev->Attach (channel);
+  return dev;
+}
+
+void
+IslHelper::InstallLink (Ptr<Node> a, Ptr<Node> b, NetDeviceContainer &container)
+{
+  NS_LOG_DEBUG ("Adding link between nodes " << a->GetId () << " and " << b->GetId ());
+  Ptr<MockChannel> channel = m_channelFactory.Create<MockChannel> ();
+  container.Add (InstallDevice (a, channel));
+  container.Add (InstallDevice (b, channel));
+}
+
+NetDeviceContainer
+IslHelper::InstallGrid (NodeContainer c, uint32_t planes, uint32_t sats)
+{
+  NS_LOG_FUNCTION (this << planes << sats);
+  NS_ASSERT_MSG (c.GetN () == planes * sats,
+                 "expected " << planes * sats << " satellites, got " << c.GetN ());
+
+  NetDeviceContainer container;
+  for (uint32_t p = 0; p < planes; p ++)
+    {
+      for (uint32_t s = 0; s < sats; s ++)
+        {
+          Ptr<Node> node = c.Get (p * sats + s);
+          // each link is installed by the satellite with the lower index,
+          // unless the ring is too small to have two different neighbors
+          if (sats > 2 || (sats == 2 && s == 0))
+            {
+              InstallLink (node, c.Get (p * sats + (s + 1) % sats), container);
+            }
+          if (planes > 2 || (planes == 2 && p == 0))
+            {
+              InstallLink (node, c.Get (((p + 1) % planes) * sats + s), container);
+            }
+        }
+    }
+
+  return container;
+}
+
+NetDeviceContainer
+IslHelper::InstallGrid (NodeContainer c, const std::vector<LeoOrbit> &orbits)
+{
+  NS_LOG_FUNCTION (this);
+
+  NetDeviceContainer container;
+  uint32_t first = 0;
+  for (const LeoOrbit &orbit : orbits)
+    {
+      uint32_t planes = orbit.planes;
+      uint32_t sats = orbit.sats;
+      NodeContainer shell;
+      for (uint32_t i = first; i < first + planes * sats; i ++)
+        {
+          shell.Add (c.Get (i));
+        }
+      container.Add (InstallGrid (shell, planes, sats));
+      first += planes * sats;
+    }
+  NS_ASSERT_MSG (first == c.GetN (), "orbits do not match the satellites");
+
+  return container;
+}
+
 NetDeviceContainer
 IslHelper::Install (std::vector<std::string> &names)
 {
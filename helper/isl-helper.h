@@ -26,6 +26,7 @@
 #include <ns3/node-container.h>
 
 #include <ns3/trace-helper.h>
+#include <ns3/leo-orbit.h>
 
 /**
  * \file
@@ -37,6 +38,7 @@ namespace ns3 {
 
 class NetDevice;
 class Node;
+class MockChannel;
 
 /**
  * \ingroup leo
@@ -101,6 +103,43 @@ public:
    */
   void SetChannelAttribute (std::string name, const AttributeValue &value);
 
+  /**
+   * Use a contact plan to select the receivers of broadcasts.
+   *
+   * \param n1 the name of the attribute to set on the contact plan
+   * \param v1 the value of the attribute to set on the contact plan
+   * \param n2 the name of the attribute to set on the contact plan
+   * \param v2 the value of the attribute to set on the contact plan
+   * \param n3 the name of the attribute to set on the contact plan
+   * \param v3 the value of the attribute to set on the contact plan
+   *
+   * Each channel created by IslHelper::Install gets its own
+   * ns3::LeoContactPlan with these attributes.
+   */
+  void SetContactPlan (std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue (),
+                       std::string n2 = "", const AttributeValue &v2 = EmptyAttributeValue (),
+                       std::string n3 = "", const AttributeValue &v3 = EmptyAttributeValue ());
+
+  /**
+   * Set the number of transmit queues of each device and their scheduler.
+   *
+   * \param n the number of transmit queues of each device
+   * \param type the type of the scheduler, e.g. ns3::MockDrrTxScheduler
+   * \param n1 the name of the attribute to set on the scheduler
+   * \param v1 the value of the attribute to set on the scheduler
+   * \param n2 the name of the attribute to set on the scheduler
+   * \param v2 the value of the attribute to set on the scheduler
+   *
+   * By default, each device has a single transmit queue. With several
+   * queues, each of them is created like the single one and a
+   * NetDeviceQueueInterface with as many transmission queues is aggregated
+   * to the device.
+   */
+  void SetTxScheduler (uint32_t n,
+                       std::string type = "ns3::MockStrictPriorityTxScheduler",
+                       std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue (),
+                       std::string n2 = "", const AttributeValue &v2 = EmptyAttributeValue ());
+
   /**
    * \param c a set of nodes
    * \return a NetDeviceContainer for nodes
@@ -130,6 +169,35 @@ public:
    */
   NetDeviceContainer Install (std::vector<std::string> &nodes);
 
+  /**
+   * \brief Connect the satellites of a constellation in a +Grid
+   *
+   * Every satellite gets four point-to-point links, each with its own
+   * channel of two devices: to the previous and next satellite in its
+   * orbital plane and to the satellites in the same slot of the neighboring
+   * planes. The nodes must be ordered by plane and then by slot, as they are
+   * allocated by LeoCircularOrbitAllocator and installed by
+   * LeoOrbitNodeHelper, i.e. satellite s of plane p is node p * sats + s.
+   *
+   * The devices of link k are at indices 2k and 2k + 1 of the returned
+   * container, so that each link can be given its own subnet.
+   *
+   * \param c satellites
+   * \param planes number of orbital planes
+   * \param sats number of satellites per plane
+   * \return a NetDeviceContainer with two devices per link
+   */
+  NetDeviceContainer InstallGrid (NodeContainer c, uint32_t planes, uint32_t sats);
+
+  /**
+   * \brief Connect the satellites of multiple shells, each in its own +Grid
+   *
+   * \param c satellites of all shells in the order of the orbit definitions
+   * \param orbits orbit definitions
+   * \return a NetDeviceContainer with two devices per link
+   */
+  NetDeviceContainer InstallGrid (NodeContainer c, const std::vector<LeoOrbit> &orbits);
+
   /**
    * \brief Enable pcap output the indicated net device.
    *
@@ -161,9 +229,29 @@ public:
     bool explicitFilename);
 
 private:
+  /**
+   * \brief Create a device with a queue on a node and attach it to a channel
+   * \param node node
+   * \param channel channel
+   * \return device
+   */
+  Ptr<NetDevice> InstallDevice (Ptr<Node> node, Ptr<MockChannel> channel);
+
+  /**
+   * \brief Connect two satellites by a dedicated channel
+   * \param a first satellite
+   * \param b second satellite
+   * \param [out] container the devices are added to this container
+   */
+  void InstallLink (Ptr<Node> a, Ptr<Node> b, NetDeviceContainer &container);
+
   ObjectFactory m_queueFactory;         //!< Queue Factory
   ObjectFactory m_channelFactory;       //!< Channel Factory
   ObjectFactory m_deviceFactory;        //!< Device Factory
+  ObjectFactory m_contactPlanFactory;   //!< Contact Plan Factory
+  ObjectFactory m_txSchedulerFactory;   //!< Transmit Scheduler Factory
+  uint32_t m_nTxQueues;                 //!< Number of transmit queues per device
+  ObjectFactory m_queueInterfaceFactory; //!< NetDeviceQueueInterface Factory
 };
 
 } // namespace ns3
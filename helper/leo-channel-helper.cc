@@ -26,12 +26,15 @@
 #include "ns3/string.h"
 #include "ns3/data-rate.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/uinteger.h"
 
 #include "../model/leo-mock-channel.h"
 #include "../model/leo-mock-net-device.h"
 #include "../model/leo-starlink-constants.h"
 #include "../model/leo-telesat-constants.h"
 #include "../model/leo-propagation-loss-model.h"
+#include "../model/leo-spatial-index.h"
+#include "../model/mock-tx-scheduler.h"
 
 namespace ns3
 {
@@ -39,6 +42,7 @@ namespace ns3
 NS_LOG_COMPONENT_DEFINE ("LeoChannelHelper");
 
 LeoChannelHelper::LeoChannelHelper ()
+  : m_nTxQueues (1)
 {
   m_gndQueueFactory.SetTypeId ("ns3::DropTailQueue<Packet>");
  // m_gndQueueFactory.Set ("MaxSize", QueueSizeValue (QueueSize ("10000p")));
@@ -57,6 +61,8 @@ LeoChannelHelper::LeoChannelHelper ()
   m_propagationLossFactory.SetTypeId ("ns3::LeoPropagationLossModel");
   m_propagationDelayFactory.SetTypeId ("ns3::ConstantSpeedPropagationDelayModel");
   m_propagationDelayFactory.Set ("Speed", DoubleValue (LEO_SPEED_OF_LIGHT_IN_AIR));
+
+  m_queueInterfaceFactory.SetTypeId ("ns3::NetDeviceQueueInterface");
 }
 
 LeoChannelHelper::LeoChannelHelper (std::string constellation) :
@@ -207,6 +213,61 @@ LeoChannelHelper::SetChannelAttribute (std::string name, const AttributeValue &v
   m_channelFactory.Set (name, value);
 }
 
+void
+LeoChannelHelper::SetSpatialIndex (std::string type,
+                                   std::string n1, const AttributeValue &v1,
+                                   std::string n2, const AttributeValue &v2)
+{
+  m_spatialIndexFactory.SetTypeId (type);
+  m_spatialIndexFactory.Set (n1, v1);
+  m_spatialIndexFactory.Set (n2, v2);
+}
+
+void
+LeoChannelHelper::SetContactPlan (std::string n1, const AttributeValue &v1,
+                                  std::string n2, const AttributeValue &v2,
+                                  std::string n3, const AttributeValue &v3)
+{
+  m_contactPlanFactory.SetTypeId ("ns3::LeoContactPlan");
+  m_contactPlanFactory.Set (n1, v1);
+  m_contactPlanFactory.Set (n2, v2);
+  m_contactPlanFactory.Set (n3, v3);
+}
+
+void
+LeoChannelHelper::SetTxScheduler (uint32_t n,
+                                  std::string type,
+                                  std::string n1, const AttributeValue &v1,
+                                  std::string n2, const AttributeValue &v2)
+{
+  NS_ASSERT_MSG (n > 0, "A device needs at least one transmit queue");
+  m_nTxQueues = n;
+  m_queueInterfaceFactory.Set ("NTxQueues", UintegerValue (n));
+  m_txSchedulerFactory.SetTypeId (type);
+  m_txSchedulerFactory.Set (n1, v1);
+  m_txSchedulerFactory.Set (n2, v2);
+}
+
+void
+LeoChannelHelper::InstallQueues (Ptr<MockNetDevice> dev, ObjectFactory &queueFactory)
+{
+  std::vector<Ptr<Queue<Packet> > > queues;
+  queues.reserve (m_nTxQueues);
+  for (uint32_t i = 0; i < m_nTxQueues; i ++)
+    {
+      queues.push_back (queueFactory.Create<Queue<Packet> > ());
+    }
+  dev->SetQueues (queues);
+  if (m_txSchedulerFactory.IsTypeIdSet ())
+    {
+      dev->SetTxScheduler (m_txSchedulerFactory.Create<MockTxScheduler> ());
+    }
+
+  // Aggregate NetDeviceQueueInterface objects. The device connects the
+  // queues to them when it is initialized.
+  dev->AggregateObject (m_queueInterfaceFactory.Create<NetDeviceQueueInterface> ());
+}
+
 void
 LeoChannelHelper::EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, bool promiscuous, bool explicitFilename)
 {
@@ -356,6 +417,16 @@ LeoChannelHelper::Install (std::vector<Ptr<Node> > &satellites, std::vector<Ptr<
   Ptr<LeoMockChannel> channel = m_channelFactory.Create<LeoMockChannel> ();
   channel->SetPropagationLoss (m_propagationLossFactory.Create<LeoPropagationLossModel> ());
   channel->SetPropagationDelay (m_propagationDelayFactory.Create<ConstantSpeedPropagationDelayModel> ());
+  if (m_spatialIndexFactory.IsTypeIdSet ())
+    {
+      channel->SetSpatialIndex (m_spatialIndexFactory.Create<LeoSpatialIndex> (),
+                                m_spatialIndexFactory.Create<LeoSpatialIndex> ());
+    }
+  if (m_contactPlanFactory.IsTypeIdSet ())
+    {
+      channel->SetContactPlan (m_contactPlanFactory.Create<LeoContactPlan> ());
+    }
+  channel->Reserve (satellites.size () + stations.size ());
 
   NetDeviceContainer container;
 
@@ -364,13 +435,7 @@ LeoChannelHelper::Install (std::vector<Ptr<Node> > &satellites, std::vector<Ptr<
     Ptr<LeoMockNetDevice> dev = m_satDeviceFactory.Create<LeoMockNetDevice> ();
     dev->SetAddress (Mac48Address::Allocate ());
     node->AddDevice (dev);
-    Ptr<Queue<Packet> > queue = m_satQueueFactory.Create<Queue<Packet> > ();
-    dev->SetQueue (queue);
-
-    // Aggregate NetDeviceQueueInterface objects
-    Ptr<NetDeviceQueueInterface> ndqi = CreateObject<NetDeviceQueueInterface> ();
-    ndqi->GetTxQueue (0)->ConnectQueueTraces (queue);
-    dev->AggregateObject (ndqi);
+    InstallQueues (dev, m_satQueueFactory);
 
     dev->Attach (channel);
     container.Add (dev);
@@ -383,13 +448,7 @@ LeoChannelHelper::Install (std::vector<Ptr<Node> > &satellites, std::vector<Ptr<
     Ptr<LeoMockNetDevice> dev = m_gndDeviceFactory.Create<LeoMockNetDevice> ();
     dev->SetAddress (Mac48Address::Allocate ());
     node->AddDevice (dev);
-    Ptr<Queue<Packet> > queue = m_gndQueueFactory.Create<Queue<Packet> > ();
-    dev->SetQueue (queue);
-
-    // Aggregate NetDeviceQueueInterface objects
-    Ptr<NetDeviceQueueInterface> ndqi = CreateObject<NetDeviceQueueInterface> ();
-    ndqi->GetTxQueue (0)->ConnectQueueTraces (queue);
-    dev->AggregateObject (ndqi);
+    InstallQueues (dev, m_gndQueueFactory);
 
     dev->Attach (channel);
     container.Add (dev);
@@ -35,6 +35,8 @@
 
 namespace ns3 {
 
+class MockNetDevice;
+
 /**
  * \ingroup leo
  * \brief Build a channel for transmissions between ns3::LeoMockNetDevice s
@@ -159,6 +161,57 @@ public:
    */
   void SetChannelAttribute (std::string name, const AttributeValue &value);
 
+  /**
+   * \brief Set the type and attributes of the spatial indices of the channel
+   *
+   * By default, no spatial index is used and every transmission is evaluated
+   * for all devices on the opposing side of the channel.
+   *
+   * \param type type of the spatial index, e.g. ns3::LeoGridSpatialIndex
+   * \param n1 name of an attribute of the spatial index
+   * \param v1 value of an attribute of the spatial index
+   * \param n2 name of an attribute of the spatial index
+   * \param v2 value of an attribute of the spatial index
+   */
+  void SetSpatialIndex (std::string type,
+                        std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue (),
+                        std::string n2 = "", const AttributeValue &v2 = EmptyAttributeValue ());
+
+  /**
+   * \brief Set the attributes of the contact plans of the channels
+   *
+   * By default, no contact plan is used. Each installed channel gets its own
+   * plan.
+   *
+   * \param n1 name of an attribute of the contact plan
+   * \param v1 value of an attribute of the contact plan
+   * \param n2 name of an attribute of the contact plan
+   * \param v2 value of an attribute of the contact plan
+   * \param n3 name of an attribute of the contact plan
+   * \param v3 value of an attribute of the contact plan
+   */
+  void SetContactPlan (std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue (),
+                       std::string n2 = "", const AttributeValue &v2 = EmptyAttributeValue (),
+                       std::string n3 = "", const AttributeValue &v3 = EmptyAttributeValue ());
+
+  /**
+   * \brief Set the number of transmit queues of the devices and their scheduler
+   *
+   * By default, each device has a single transmit queue. Each of the queues
+   * is created like the single one.
+   *
+   * \param n number of transmit queues of each device
+   * \param type type of the scheduler, e.g. ns3::MockDrrTxScheduler
+   * \param n1 name of an attribute of the scheduler
+   * \param v1 value of an attribute of the scheduler
+   * \param n2 name of an attribute of the scheduler
+   * \param v2 value of an attribute of the scheduler
+   */
+  void SetTxScheduler (uint32_t n,
+                       std::string type = "ns3::MockStrictPriorityTxScheduler",
+                       std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue (),
+                       std::string n2 = "", const AttributeValue &v2 = EmptyAttributeValue ());
+
   virtual void EnablePcapInternal (std::string prefix, Ptr<NetDevice> nd, bool promiscuous, bool explicitFilename);
   virtual void EnableAsciiInternal (Ptr<OutputStreamWrapper> stream,
   				    std::string prefix,
@@ -191,6 +244,28 @@ private:
   /// Propagation delay models
   ObjectFactory m_propagationDelayFactory;
 
+  /// Spatial indices
+  ObjectFactory m_spatialIndexFactory;
+
+  /// Contact plans of the channels
+  ObjectFactory m_contactPlanFactory;
+
+  /// Number of transmit queues of each device
+  uint32_t m_nTxQueues;
+
+  /// Schedulers of the transmit queues
+  ObjectFactory m_txSchedulerFactory;
+
+  /// NetDeviceQueueInterface objects of the devices
+  ObjectFactory m_queueInterfaceFactory;
+
+  /**
+   * \brief Create the transmit queues of a device and its NetDeviceQueueInterface
+   * \param dev device
+   * \param queueFactory factory of the queues
+   */
+  void InstallQueues (Ptr<MockNetDevice> dev, ObjectFactory &queueFactory);
+
   /**
    * \brief Set the factory and attributes of the queue
    * \param factory queue factory
@@ -16,13 +16,22 @@
  * Author: Tim Schubert <ns-3-leo@timschubert.net>
  */
 
+#include <algorithm>
+
+#include <sys/stat.h>
+
+#include "ns3/log.h"
 #include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/boolean.h"
 #include "ns3/time-data-calculators.h"
 #include "leo-input-fstream-container.h"
 
 namespace ns3
 {
 
+NS_LOG_COMPONENT_DEFINE ("LeoWaypointInputFileStreamContainer");
+
 TypeId
 LeoWaypointInputFileStreamContainer::GetTypeId (void)
 {
@@ -40,33 +49,233 @@ LeoWaypointInputFileStreamContainer::GetTypeId (void)
     		   TimeValue (),
     		   MakeTimeAccessor (&LeoWaypointInputFileStreamContainer::m_lastTime),
     		   MakeTimeChecker ())
+    .AddAttribute ("IndexInterval",
+                   "The number of waypoints of a text file between two offsets recorded for seeking",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&LeoWaypointInputFileStreamContainer::m_indexInterval),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("IndexFile",
+                   "Whether to store the offsets of a text file in a file with the suffix .idx and load them from there",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&LeoWaypointInputFileStreamContainer::m_indexFile),
+                   MakeBooleanChecker ())
     ;
   return tid;
 }
 
 LeoWaypointInputFileStreamContainer::LeoWaypointInputFileStreamContainer () :
   m_filePath (),
-  m_lastTime (0)
+  m_lastTime (0),
+  m_binary (CreateObject<LeoWaypointBinaryFile> ()),
+  m_next (0),
+  m_seek (true),
+  m_indexInterval (64),
+  m_indexFile (false),
+  m_indexComplete (false),
+  m_sample (0),
+  m_suspended (false),
+  m_offset (0)
 {
 }
 
 LeoWaypointInputFileStreamContainer::LeoWaypointInputFileStreamContainer (string filePath, Time lastTime) :
   m_filePath (filePath),
-  m_lastTime (lastTime)
+  m_lastTime (lastTime),
+  m_binary (CreateObject<LeoWaypointBinaryFile> ()),
+  m_next (0),
+  m_seek (true),
+  m_indexInterval (64),
+  m_indexFile (false),
+  m_indexComplete (false),
+  m_sample (0),
+  m_suspended (false),
+  m_offset (0)
 {
 }
 
 LeoWaypointInputFileStreamContainer::~LeoWaypointInputFileStreamContainer ()
 {
   m_input.close ();
+  m_binary->Close ();
+}
+
+void
+LeoWaypointInputFileStreamContainer::Open (void)
+{
+  m_input.close ();
+  m_suspended = false;
+  m_index.clear ();
+  m_indexComplete = false;
+  m_sample = 0;
+  if (!m_binary->Open (m_filePath))
+    {
+      m_input.open (m_filePath);
+      if (m_indexFile && m_input.is_open ())
+        {
+          m_indexComplete = ReadIndex ();
+        }
+    }
+  m_seek = true;
+}
+
+void
+LeoWaypointInputFileStreamContainer::Suspend (void)
+{
+  if (!m_input.is_open ())
+    {
+      return;
+    }
+  // tellg fails after the end of the file
+  m_offset = m_input.tellg ();
+  m_input.close ();
+  m_suspended = true;
+}
+
+void
+LeoWaypointInputFileStreamContainer::Resume (void)
+{
+  if (!m_suspended)
+    {
+      return;
+    }
+  m_suspended = false;
+  m_input.clear ();
+  m_input.open (m_filePath);
+  if (!m_input.is_open ())
+    {
+      NS_ABORT_MSG ("Could not reopen " << m_filePath);
+    }
+  if (m_offset == std::streampos (-1))
+    {
+      m_input.seekg (0, std::ios::end);
+    }
+  else
+    {
+      m_input.seekg (m_offset);
+    }
+}
+
+bool
+LeoWaypointInputFileStreamContainer::ReadSample (Waypoint &sample)
+{
+  // offsets are only recorded in order, so that the number of each recorded
+  // waypoint is known from its position in the index
+  bool record = !m_indexComplete
+    && m_sample % m_indexInterval == 0
+    && m_sample / m_indexInterval == m_index.size ();
+  std::streampos offset;
+  if (record)
+    {
+      offset = m_input.tellg ();
+    }
+
+  if (!(m_input >> sample))
+    {
+      if (!m_indexComplete && m_index.size () == (m_sample + m_indexInterval - 1) / m_indexInterval)
+        {
+          m_indexComplete = true;
+          NS_LOG_INFO ("indexed " << m_sample << " waypoints of " << m_filePath);
+          if (m_indexFile)
+            {
+              WriteIndex ();
+            }
+        }
+      return false;
+    }
+
+  if (record)
+    {
+      m_index.push_back (std::make_pair (sample.time, offset));
+    }
+  m_sample ++;
+  return true;
+}
+
+string
+LeoWaypointInputFileStreamContainer::GetIndexFile (void) const
+{
+  return m_filePath + ".idx";
+}
+
+bool
+LeoWaypointInputFileStreamContainer::ReadIndex (void)
+{
+  struct stat data;
+  struct stat index;
+  string path = GetIndexFile ();
+  if (stat (m_filePath.c_str (), &data) != 0
+      || stat (path.c_str (), &index) != 0
+      || index.st_mtime < data.st_mtime)
+    {
+      return false;
+    }
+
+  ifstream input (path);
+  string magic;
+  uint32_t interval;
+  uint64_t size;
+  if (!(input >> magic >> interval >> size)
+      || magic != "LEOIDX1"
+      || interval != m_indexInterval
+      || size != (uint64_t) data.st_size)
+    {
+      NS_LOG_INFO ("ignoring outdated index " << path);
+      return false;
+    }
+
+  int64_t time;
+  int64_t offset;
+  while (input >> time >> offset)
+    {
+      m_index.push_back (std::make_pair (NanoSeconds (time), std::streampos (offset)));
+    }
+  NS_LOG_INFO ("loaded " << m_index.size () << " offsets from " << path);
+
+  return true;
+}
+
+void
+LeoWaypointInputFileStreamContainer::WriteIndex (void) const
+{
+  struct stat data;
+  string path = GetIndexFile ();
+  ofstream output (path, ios::out | ios::trunc);
+  if (stat (m_filePath.c_str (), &data) != 0 || !output.is_open ())
+    {
+      NS_LOG_WARN ("Could not write index " << path);
+      return;
+    }
+
+  output << "LEOIDX1 " << m_indexInterval << " " << data.st_size << endl;
+  for (const std::pair<Time, std::streampos> &entry : m_index)
+    {
+      output << entry.first.GetNanoSeconds () << " " << (int64_t) entry.second << "\n";
+    }
 }
 
 bool
 LeoWaypointInputFileStreamContainer::GetNextSample (Waypoint &sample)
 {
-  if (!m_input.is_open ())
+  Resume ();
+  if (!m_input.is_open () && !m_binary->IsOpen ())
     {
-      m_input.open (m_filePath);
+      Open ();
+    }
+
+  if (m_binary->IsOpen ())
+    {
+      if (m_seek)
+        {
+          m_next = m_binary->Find (m_lastTime);
+          m_seek = false;
+        }
+      if (m_next >= m_binary->GetN ())
+        {
+          return false;
+        }
+      sample = m_binary->Get (m_next ++);
+      m_lastTime = sample.time;
+      return true;
     }
 
   if (!m_input.is_open ())
@@ -82,7 +291,7 @@ LeoWaypointInputFileStreamContainer::GetNextSample (Waypoint &sample)
   sample.time = Time (0);
   sample.position = Vector (0.0, 0.0, 0.0);
   bool updated = false;
-  while (sample.time <= m_lastTime && (m_input >> sample))
+  while (sample.time <= m_lastTime && ReadSample (sample))
     {
       updated = true;
     }
@@ -97,9 +306,8 @@ LeoWaypointInputFileStreamContainer::GetNextSample (Waypoint &sample)
 void
 LeoWaypointInputFileStreamContainer::SetFile (const string path)
 {
-  m_input.close ();
   m_filePath = path;
-  m_input.open (m_filePath);
+  Open ();
 }
 
 string
@@ -111,9 +319,31 @@ LeoWaypointInputFileStreamContainer::GetFile () const
 void
 LeoWaypointInputFileStreamContainer::SetLastTime (const Time lastTime)
 {
+  Resume ();
   m_input.clear ();
-  m_input.seekg (0, std::ios::beg);
+
+  // start at the last recorded waypoint not later than lastTime, the
+  // waypoints in between are skipped by GetNextSample
+  std::vector<std::pair<Time, std::streampos> >::const_iterator it =
+    std::upper_bound (m_index.begin (), m_index.end (), lastTime,
+                      [] (const Time &t, const std::pair<Time, std::streampos> &entry)
+                      {
+                        return t < entry.first;
+                      });
+  if (it == m_index.begin ())
+    {
+      m_input.seekg (0, std::ios::beg);
+      m_sample = 0;
+    }
+  else
+    {
+      it --;
+      m_input.seekg (it->second);
+      m_sample = (it - m_index.begin ()) * (uint64_t) m_indexInterval;
+    }
+
   m_lastTime = lastTime;
+  m_seek = true;
 }
 
 Time
@@ -20,9 +20,12 @@
 #define LEO_INPUT_FSTREAM_CONTAINER
 
 #include <fstream>
+#include <vector>
 #include "ns3/object.h"
 #include "ns3/waypoint.h"
 
+#include "leo-waypoint-binary-file.h"
+
 /**
  * \file
  * \ingroup leo
@@ -37,6 +40,15 @@ namespace ns3
 /**
  * \ingroup leo
  * \brief Wrapper around a stream of Waypoint
+ *
+ * Files in the binary format of LeoWaypointBinaryFile are mapped instead of
+ * parsed.
+ *
+ * For text files, the byte offset of every IndexInterval-th waypoint is
+ * recorded while the file is read. SetLastTime seeks to the last recorded
+ * waypoint before that time instead of reading the file from the start. With
+ * IndexFile, the offsets are stored next to the waypoint file once it has
+ * been read completely and are loaded again when the file is opened.
  */
 class LeoWaypointInputFileStreamContainer : public Object
 {
@@ -91,7 +103,46 @@ public:
    */
   Time GetLastTime () const;
 
+  /**
+   * \brief Close a text file until the next waypoint is read
+   *
+   * The file is opened again at the same offset, so that many streams can
+   * be kept without holding a file descriptor each.
+   */
+  void Suspend (void);
+
 private:
+  /// Open the file at m_filePath
+  void Open (void);
+
+  /// Open a suspended text file again at the recorded offset
+  void Resume (void);
+
+  /**
+   * \brief Read the next waypoint of a text file and record its offset
+   * \param [out] sample waypoint
+   * \return true iff a waypoint has been read
+   */
+  bool ReadSample (Waypoint &sample);
+
+  /**
+   * \brief Get the path to the index file
+   * \return path to the index file
+   */
+  string GetIndexFile (void) const;
+
+  /**
+   * \brief Load the offsets from the index file, if it matches the
+   * waypoint file
+   * \return true iff the offsets have been loaded
+   */
+  bool ReadIndex (void);
+
+  /**
+   * \brief Store the offsets in the index file
+   */
+  void WriteIndex (void) const;
+
   /// Path to the waypoints file
   string m_filePath;
 
@@ -101,6 +152,36 @@ private:
   /// Waypoint file stream
   ifstream m_input;
 
+  /// Mapping of a binary waypoint file
+  Ptr<LeoWaypointBinaryFile> m_binary;
+
+  /// Index of the next waypoint of a binary file
+  uint64_t m_next;
+
+  /// Whether m_next has to be looked up from m_lastTime
+  bool m_seek;
+
+  /// Number of waypoints between two recorded offsets
+  uint32_t m_indexInterval;
+
+  /// Whether to load and store the offsets in an index file
+  bool m_indexFile;
+
+  /// Time and byte offset of every m_indexInterval-th waypoint of a text file
+  std::vector<std::pair<Time, std::streampos> > m_index;
+
+  /// Whether m_index covers the whole text file
+  bool m_indexComplete;
+
+  /// Number of the next waypoint read from the text file
+  uint64_t m_sample;
+
+  /// Whether the text file has been closed by Suspend
+  bool m_suspended;
+
+  /// Offset of the suspended text file, or -1 after its end
+  std::streampos m_offset;
+
 };
 
 };
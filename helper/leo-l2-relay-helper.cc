@@ -0,0 +1,66 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tim Schubert <ns-3-leo@timschubert.net>
+ */
+
+#include "ns3/log.h"
+#include "../model/leo-mock-net-device.h"
+
+#include "leo-l2-relay-helper.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE ("LeoL2RelayHelper");
+
+void
+LeoL2RelayHelper::Install (NetDeviceContainer &devices) const
+{
+  NS_LOG_FUNCTION (this);
+
+  for (size_t i = 0; i < devices.GetN (); i ++)
+    {
+      Ptr<LeoMockNetDevice> dev = DynamicCast<LeoMockNetDevice> (devices.Get (i));
+      if (dev == 0 || dev->GetDeviceType () != LeoMockNetDevice::SAT)
+        {
+          continue;
+        }
+      Install (dev);
+    }
+}
+
+Ptr<LeoL2Relay>
+LeoL2RelayHelper::Install (Ptr<NetDevice> device) const
+{
+  NS_LOG_FUNCTION (this << device);
+
+  Ptr<MockNetDevice> port = DynamicCast<MockNetDevice> (device);
+  NS_ASSERT_MSG (port != 0, "Only MockNetDevices can be relay ports");
+
+  Ptr<Node> node = port->GetNode ();
+  Ptr<LeoL2Relay> relay = node->GetObject<LeoL2Relay> ();
+  if (relay == 0)
+    {
+      relay = CreateObject<LeoL2Relay> ();
+      node->AggregateObject (relay);
+    }
+  relay->AddPort (port);
+
+  NS_LOG_DEBUG ("Relaying frames of device " << port->GetIfIndex () << " of node " << node->GetId ());
+  return relay;
+}
+
+}; /* namespace ns3 */
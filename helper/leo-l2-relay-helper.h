@@ -0,0 +1,62 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tim Schubert <ns-3-leo@timschubert.net>
+ */
+
+#ifndef LEO_L2_RELAY_HELPER_H
+#define LEO_L2_RELAY_HELPER_H
+
+#include "ns3/net-device-container.h"
+#include "ns3/node.h"
+
+#include "ns3/leo-l2-relay.h"
+
+/**
+ * \file
+ * \ingroup leo
+ * Declares LeoL2RelayHelper
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup leo
+ * \brief Turns satellites into bent pipes that relay ground frames at layer 2
+ */
+class LeoL2RelayHelper
+{
+public:
+  /**
+   * \brief Relay the frames received by the satellite devices
+   *
+   * Ground station devices in the container are skipped. Each satellite
+   * gets a single LeoL2Relay, which is aggregated to its node.
+   *
+   * \param devices devices installed by LeoChannelHelper::Install
+   */
+  void Install (NetDeviceContainer &devices) const;
+
+  /**
+   * \brief Relay the frames received by a device
+   * \param device device, which must be a MockNetDevice
+   * \return relay of the node of the device
+   */
+  Ptr<LeoL2Relay> Install (Ptr<NetDevice> device) const;
+};
+
+}; /* namespace ns3 */
+
+#endif /* LEO_L2_RELAY_HELPER_H */
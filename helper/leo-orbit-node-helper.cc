@@ -22,9 +22,11 @@
 #include "ns3/log.h"
 #include "ns3/config.h"
 #include "ns3/waypoint.h"
-#include "ns3/mobility-helper.h"
+#include "ns3/node.h"
+#include "ns3/position-allocator.h"
 #include "ns3/double.h"
 #include "ns3/integer.h"
+#include "ns3/nstime.h"
 
 #include "leo-orbit-node-helper.h"
 
@@ -34,9 +36,12 @@ namespace ns3
 {
 NS_LOG_COMPONENT_DEFINE ("LeoOrbitNodeHelper");
 
-LeoOrbitNodeHelper::LeoOrbitNodeHelper ()
+LeoOrbitNodeHelper::LeoOrbitNodeHelper () : m_useClock (true)
 {
   m_nodeFactory.SetTypeId ("ns3::Node");
+  m_propagator = CreateObject<LeoConstellationPropagator> ();
+  m_clock = CreateObject<LeoConstellationClock> ();
+  m_clock->SetPropagator (m_propagator);
 }
 
 LeoOrbitNodeHelper::~LeoOrbitNodeHelper ()
@@ -49,24 +54,30 @@ LeoOrbitNodeHelper::SetAttribute (string name, const AttributeValue &value)
   m_nodeFactory.Set (name, value);
 }
 
+Ptr<LeoConstellationPropagator>
+LeoOrbitNodeHelper::GetPropagator (void) const
+{
+  return m_propagator;
+}
+
+void
+LeoOrbitNodeHelper::SetUseClock (bool enable)
+{
+  m_useClock = enable;
+}
+
+Ptr<LeoConstellationClock>
+LeoOrbitNodeHelper::GetClock (void) const
+{
+  return m_clock;
+}
+
 NodeContainer
 LeoOrbitNodeHelper::Install (const LeoOrbit &orbit)
 {
   NS_LOG_FUNCTION (this << orbit);
 
-  MobilityHelper mobility;
-  mobility.SetPositionAllocator ("ns3::LeoCircularOrbitPostionAllocator",
-                                 "NumOrbits", IntegerValue (orbit.planes),
-                                 "NumSatellites", IntegerValue (orbit.sats));
-  mobility.SetMobilityModel ("ns3::LeoCircularOrbitMobilityModel",
-  			     "Altitude", DoubleValue (orbit.alt),
-  			     "Inclination", DoubleValue (orbit.inc));
-
-  NodeContainer c;
-  c.Create (orbit.sats*orbit.planes);
-  mobility.Install (c);
-
-  return c;
+  return Install (vector<LeoOrbit> (1, orbit));
 }
 
 NodeContainer
@@ -74,20 +85,17 @@ LeoOrbitNodeHelper::Install (const std::string &orbitFile)
 {
   NS_LOG_FUNCTION (this << orbitFile);
 
-  NodeContainer nodes;
-  ifstream orbits;
-  orbits.open (orbitFile, ifstream::in);
+  vector<LeoOrbit> orbits;
+  ifstream file;
+  file.open (orbitFile, ifstream::in);
   LeoOrbit orbit;
-  while ((orbits >> orbit))
+  while ((file >> orbit))
     {
-      nodes.Add (Install (orbit));
-      NS_LOG_DEBUG ("Added orbit plane");
+      orbits.push_back (orbit);
     }
-  orbits.close ();
+  file.close ();
 
-  NS_LOG_DEBUG ("Added " << nodes.GetN () << " nodes");
-
-  return nodes;
+  return Install (orbits);
 }
 
 NodeContainer
@@ -95,10 +103,60 @@ LeoOrbitNodeHelper::Install (const vector<LeoOrbit> &orbits)
 {
   NS_LOG_FUNCTION (this << orbits);
 
+  uint32_t total = 0;
+  for (const LeoOrbit &orbit : orbits)
+    {
+      total += orbit.planes * orbit.sats;
+    }
+  m_propagator->Reserve (m_propagator->GetN () + total);
+
+  ObjectFactory mobilityFactory;
+  mobilityFactory.SetTypeId ("ns3::LeoCircularOrbitMobilityModel");
+  ObjectFactory positionFactory;
+  positionFactory.SetTypeId ("ns3::LeoCircularOrbitPostionAllocator");
+
+  // all satellites share the defaults of the remaining attributes, so the
+  // precision only has to be looked up once
+  TimeValue precision;
+  bool clocked = false;
+
   NodeContainer nodes;
-  for (uint64_t i = 0; i < orbits.size(); i++)
+  for (const LeoOrbit &orbit : orbits)
     {
-      nodes.Add (Install (orbits[i]));
+      // the values are converted and checked once per orbit instead of once
+      // per satellite
+      mobilityFactory.Set ("Altitude", DoubleValue (orbit.alt));
+      mobilityFactory.Set ("Inclination", DoubleValue (orbit.inc));
+      positionFactory.Set ("NumOrbits", IntegerValue (orbit.planes));
+      positionFactory.Set ("NumSatellites", IntegerValue (orbit.sats));
+      Ptr<PositionAllocator> positions = positionFactory.Create<PositionAllocator> ();
+
+      for (uint32_t i = 0; i < (uint32_t) orbit.planes * orbit.sats; i ++)
+        {
+          Ptr<Node> node = m_nodeFactory.Create<Node> ();
+          Ptr<LeoCircularOrbitMobilityModel> mob = mobilityFactory.Create<LeoCircularOrbitMobilityModel> ();
+          node->AggregateObject (mob);
+          mob->SetPosition (positions->GetNext ());
+          m_propagator->Add (mob);
+
+          if (nodes.GetN () == 0)
+            {
+              // positions are computed on every read without precision
+              mob->GetAttribute ("Precision", precision);
+              clocked = m_useClock && precision.Get () > Time (0);
+              if (clocked && m_clock->GetN () == 0)
+                {
+                  // tick with the precision the satellites have been configured with
+                  m_clock->SetAttribute ("Precision", precision);
+                }
+            }
+          if (clocked)
+            {
+              m_clock->Add (mob);
+            }
+
+          nodes.Add (node);
+        }
       NS_LOG_DEBUG ("Added orbit plane");
     }
 
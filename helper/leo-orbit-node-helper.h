@@ -25,6 +25,8 @@
 #include "ns3/node-container.h"
 #include "ns3/leo-circular-orbit-mobility-model.h"
 #include "ns3/leo-circular-orbit-position-allocator.h"
+#include "ns3/leo-constellation-propagator.h"
+#include "ns3/leo-constellation-clock.h"
 #include "ns3/leo-orbit.h"
 
 /**
@@ -59,6 +61,11 @@ public:
   NodeContainer Install (const std::string &orbitFile);
 
   /**
+   * \brief Install the satellites of all orbits at once
+   *
+   * The other Install methods use this. The factories of the mobility models
+   * are configured once per orbit and the buffers of the propagator are sized
+   * for the whole constellation in advance.
    *
    * \param orbits orbit definitions
    * \returns a node container containing nodes using the specified attributes
@@ -80,9 +87,42 @@ public:
    */
   void SetAttribute (std::string name, const AttributeValue &value);
 
+  /**
+   * \brief Get the propagator that computes the positions of all satellites
+   * installed by this helper
+   *
+   * \return propagator
+   */
+  Ptr<LeoConstellationPropagator> GetPropagator (void) const;
+
+  /**
+   * \brief Let a single clock update the positions of all satellites
+   * installed afterwards instead of one event per satellite (default)
+   *
+   * \param enable whether to use the clock
+   */
+  void SetUseClock (bool enable);
+
+  /**
+   * \brief Get the clock that updates the positions of the satellites
+   * installed by this helper
+   *
+   * \return clock
+   */
+  Ptr<LeoConstellationClock> GetClock (void) const;
+
 private:
   /// Factory for nodes
   ObjectFactory m_nodeFactory;
+
+  /// Positions of all installed satellites
+  Ptr<LeoConstellationPropagator> m_propagator;
+
+  /// Whether the clock updates the positions
+  bool m_useClock;
+
+  /// Updates the positions of all installed satellites
+  Ptr<LeoConstellationClock> m_clock;
 };
 
 }; // namespace ns3
@@ -0,0 +1,222 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tim Schubert <ns-3-leo@timschubert.net>
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "leo-waypoint-binary-file.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE ("LeoWaypointBinaryFile");
+
+NS_OBJECT_ENSURE_REGISTERED (LeoWaypointBinaryFile);
+
+const char LeoWaypointBinaryFile::s_magic[8] = { 'L', 'E', 'O', 'W', 'P', 'T', '1', '\0' };
+
+TypeId
+LeoWaypointBinaryFile::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LeoWaypointBinaryFile")
+    .SetParent<Object> ()
+    .SetGroupName ("Leo")
+    .AddConstructor<LeoWaypointBinaryFile> ()
+  ;
+  return tid;
+}
+
+LeoWaypointBinaryFile::LeoWaypointBinaryFile ()
+  : m_data (0),
+    m_size (0),
+    m_records (0),
+    m_count (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LeoWaypointBinaryFile::~LeoWaypointBinaryFile ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+}
+
+void
+LeoWaypointBinaryFile::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+  Object::DoDispose ();
+}
+
+bool
+LeoWaypointBinaryFile::Open (const std::string &path)
+{
+  NS_LOG_FUNCTION (this << path);
+
+  Close ();
+
+  int fd = open (path.c_str (), O_RDONLY);
+  if (fd < 0)
+    {
+      return false;
+    }
+  struct stat st;
+  if (fstat (fd, &st) != 0 || (uint64_t) st.st_size < sizeof (Header))
+    {
+      close (fd);
+      return false;
+    }
+  void *data = mmap (0, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping stays valid without the descriptor
+  close (fd);
+  if (data == MAP_FAILED)
+    {
+      return false;
+    }
+
+  const Header *header = (const Header *) data;
+  if (memcmp (header->magic, s_magic, sizeof (s_magic)) != 0
+      || header->count > (st.st_size - sizeof (Header)) / sizeof (Record))
+    {
+      munmap (data, st.st_size);
+      return false;
+    }
+
+  m_data = data;
+  m_size = st.st_size;
+  m_records = (const Record *) ((const char *) data + sizeof (Header));
+  m_count = header->count;
+
+  NS_LOG_INFO ("mapped " << m_count << " waypoints of " << path);
+
+  return true;
+}
+
+void
+LeoWaypointBinaryFile::Close (void)
+{
+  if (m_data != 0)
+    {
+      munmap (m_data, m_size);
+    }
+  m_data = 0;
+  m_size = 0;
+  m_records = 0;
+  m_count = 0;
+}
+
+bool
+LeoWaypointBinaryFile::IsOpen (void) const
+{
+  return m_data != 0;
+}
+
+uint64_t
+LeoWaypointBinaryFile::GetN (void) const
+{
+  return m_count;
+}
+
+Waypoint
+LeoWaypointBinaryFile::Get (uint64_t i) const
+{
+  NS_ASSERT (i < m_count);
+  const Record &record = m_records[i];
+  return Waypoint (NanoSeconds (record.time), Vector (record.x, record.y, record.z));
+}
+
+uint64_t
+LeoWaypointBinaryFile::Find (Time t) const
+{
+  int64_t ns = t.GetNanoSeconds ();
+  const Record *it = std::upper_bound (m_records, m_records + m_count, ns,
+                                       [] (int64_t time, const Record &record)
+                                       {
+                                         return time < record.time;
+                                       });
+  return it - m_records;
+}
+
+bool
+LeoWaypointBinaryFile::IsBinary (const std::string &path)
+{
+  std::ifstream input (path, std::ios::in | std::ios::binary);
+  char magic[sizeof (s_magic)];
+  return input.read (magic, sizeof (magic)) && memcmp (magic, s_magic, sizeof (s_magic)) == 0;
+}
+
+uint64_t
+LeoWaypointBinaryFile::Convert (const std::string &textPath, const std::string &binaryPath)
+{
+  NS_LOG_FUNCTION (textPath << binaryPath);
+
+  std::ifstream input (textPath);
+  if (!input.is_open ())
+    {
+      NS_ABORT_MSG ("Could not open " << textPath);
+    }
+  std::ofstream output (binaryPath, std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!output.is_open ())
+    {
+      NS_ABORT_MSG ("Could not open " << binaryPath);
+    }
+
+  Header header;
+  memcpy (header.magic, s_magic, sizeof (s_magic));
+  header.count = 0;
+  output.write ((const char *) &header, sizeof (header));
+
+  Waypoint wp;
+  int64_t last = 0;
+  while (input >> wp)
+    {
+      Record record;
+      record.time = wp.time.GetNanoSeconds ();
+      record.x = wp.position.x;
+      record.y = wp.position.y;
+      record.z = wp.position.z;
+      NS_ABORT_MSG_IF (header.count > 0 && record.time < last,
+                       "Waypoints of " << textPath << " are not sorted by time");
+      last = record.time;
+      output.write ((const char *) &record, sizeof (record));
+      header.count ++;
+    }
+
+  // the number of records is only known at the end
+  output.seekp (0, std::ios::beg);
+  output.write ((const char *) &header, sizeof (header));
+  if (!output)
+    {
+      NS_ABORT_MSG ("Could not write " << binaryPath);
+    }
+
+  NS_LOG_INFO ("converted " << header.count << " waypoints of " << textPath);
+
+  return header.count;
+}
+
+};
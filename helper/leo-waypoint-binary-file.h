@@ -0,0 +1,161 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tim Schubert <ns-3-leo@timschubert.net>
+ */
+
+#ifndef LEO_WAYPOINT_BINARY_FILE_H
+#define LEO_WAYPOINT_BINARY_FILE_H
+
+#include <string>
+#include <stdint.h>
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/waypoint.h"
+
+/**
+ * \file
+ * \ingroup leo
+ * Declares LeoWaypointBinaryFile
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup leo
+ * \brief Memory map of a binary waypoint file
+ *
+ * The file starts with an 8 byte magic string and the number of records,
+ * followed by the records sorted by time. Each record holds the time in
+ * nanoseconds and the x, y and z coordinates in host byte order, so that
+ * the records can be read from the mapping without parsing and found by
+ * binary search.
+ */
+class LeoWaypointBinaryFile : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /// constructor
+  LeoWaypointBinaryFile ();
+  /// destructor
+  virtual ~LeoWaypointBinaryFile ();
+
+  /**
+   * \brief Map a binary waypoint file
+   * \param path path to the file
+   * \return true iff the file could be mapped and is a binary waypoint file
+   */
+  bool Open (const std::string &path);
+
+  /**
+   * \brief Unmap the file
+   */
+  void Close (void);
+
+  /**
+   * \brief Check whether a file is mapped
+   * \return true iff a file is mapped
+   */
+  bool IsOpen (void) const;
+
+  /**
+   * \brief Get the number of waypoints
+   * \return number of waypoints
+   */
+  uint64_t GetN (void) const;
+
+  /**
+   * \brief Get a waypoint
+   * \param i index of the waypoint
+   * \return waypoint
+   */
+  Waypoint Get (uint64_t i) const;
+
+  /**
+   * \brief Find the first waypoint after a point in time
+   * \param t time
+   * \return index of the first waypoint later than t, or GetN () if there
+   * is none
+   */
+  uint64_t Find (Time t) const;
+
+  /**
+   * \brief Check whether a file is a binary waypoint file
+   * \param path path to the file
+   * \return true iff the file starts with the magic string
+   */
+  static bool IsBinary (const std::string &path);
+
+  /**
+   * \brief Convert a text waypoint file to the binary format
+   * \param textPath path to the text file, as read by
+   * LeoWaypointInputFileStreamContainer
+   * \param binaryPath path to the binary file
+   * \return number of converted waypoints
+   */
+  static uint64_t Convert (const std::string &textPath, const std::string &binaryPath);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /// Start of the file
+  struct Header
+  {
+    /// Magic string
+    char magic[8];
+    /// Number of records
+    uint64_t count;
+  };
+
+  /// Waypoint as stored in the file
+  struct Record
+  {
+    /// Time in ns
+    int64_t time;
+    /// First coordinate
+    double x;
+    /// Second coordinate
+    double y;
+    /// Third coordinate
+    double z;
+  };
+
+  /// Magic string at the start of each file
+  static const char s_magic[8];
+
+  /// Start of the mapping
+  void *m_data;
+
+  /// Size of the mapping in bytes
+  uint64_t m_size;
+
+  /// First record inside the mapping
+  const Record *m_records;
+
+  /// Number of records
+  uint64_t m_count;
+};
+
+};
+
+#endif
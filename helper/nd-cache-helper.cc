@@ -16,6 +16,8 @@
  * Author: Tim Schubert <ns-3-leo@timschubert.net>
  */
 
+#include <map>
+
 #include "ns3/core-module.h"
 #include "ns3/network-module.h"
 #include "ns3/internet-module.h"
@@ -34,6 +36,17 @@ NdCacheHelper::Install (NetDeviceContainer &devices, Ipv6InterfaceContainer &int
 {
   NS_LOG_FUNCTION (this);
 
+  // devices of the same type do not talk to each other, devices that are
+  // no LeoMockNetDevices all talk to each other
+  std::vector<int> types (devices.GetN ());
+  std::map<int, std::vector<uint32_t> > sides;
+  for (uint32_t i = 0; i < devices.GetN (); i ++)
+    {
+      Ptr<LeoMockNetDevice> leoDev = DynamicCast<LeoMockNetDevice> (devices.Get (i));
+      types[i] = leoDev != 0 ? leoDev->GetDeviceType () : -1;
+      sides[types[i]].push_back (i);
+    }
+
   // prepare NDS cache
   for (uint32_t i = 0; i < devices.GetN (); i++)
     {
@@ -43,33 +56,31 @@ NdCacheHelper::Install (NetDeviceContainer &devices, Ipv6InterfaceContainer &int
       int32_t ifIndex = ipv6->GetInterfaceForDevice (dev);
       Ptr<Ipv6Interface> interface = ipv6->GetInterface (ifIndex);
       Ptr<NdiscCache> cache = interface->GetNdiscCache ();
-      for (uint32_t j = 0; j < devices.GetN (); j++)
+      for (std::pair<const int, std::vector<uint32_t> > &side : sides)
         {
-          // every other device, that is not of same "type"
-          Ptr<NetDevice> otherDevice = devices.Get (j);
-          Ptr<LeoMockNetDevice> leoDev = DynamicCast<LeoMockNetDevice> (dev);
-          Ptr<LeoMockNetDevice> otherLeoDev = DynamicCast<LeoMockNetDevice> (otherDevice);
-          if (i == j || (leoDev != 0
-              && otherLeoDev != 0
-              && leoDev->GetDeviceType () == otherLeoDev->GetDeviceType ()))
+          if (side.first == types[i] && types[i] != -1)
             {
               continue;
             }
-          Address address = otherDevice->GetAddress (); // MAC
+          for (uint32_t j : side.second)
+            {
+              if (j == i)
+                {
+                  continue;
+                }
+              Address address = devices.Get (j)->GetAddress (); // MAC
+              Ipv6Address ipaddr = interfaces.GetAddress (j, 1); // IP
 
-          // and associated address
-          uint32_t otherIfIndex = otherDevice->GetIfIndex ();
-          Ipv6Address ipaddr = interfaces.GetAddress (otherIfIndex, 1); // IP
+              // update cache
+              NdiscCache::Entry* entry = cache->Lookup (ipaddr);
+              if (entry == 0)
+                {
+                  entry = cache->Add (ipaddr);
+                }
+              entry->SetMacAddress (address);
 
-          // update cache
-          NdiscCache::Entry* entry = cache->Lookup (ipaddr);
-          if (entry == 0)
-            {
-              entry = cache->Add (ipaddr);
+              NS_LOG_DEBUG ("Added entry for " << address);
             }
-          entry->SetMacAddress (address);
-
-	  NS_LOG_DEBUG ("Added entry for " << address);
         }
     }
 }
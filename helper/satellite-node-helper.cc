@@ -19,6 +19,7 @@
 #include "ns3/log.h"
 #include "ns3/config.h"
 #include "ns3/waypoint-mobility-model.h"
+#include "ns3/leo-streaming-waypoint-mobility-model.h"
 
 #include "satellite-node-helper.h"
 
@@ -29,6 +30,7 @@ namespace ns3
 NS_LOG_COMPONENT_DEFINE ("LeoSatNodeHelper");
 
 LeoSatNodeHelper::LeoSatNodeHelper ()
+  : m_streaming (false)
 {
   m_satNodeFactory.SetTypeId ("ns3::Node");
 }
@@ -43,6 +45,12 @@ LeoSatNodeHelper::SetAttribute (string name, const AttributeValue &value)
   m_satNodeFactory.Set (name, value);
 }
 
+void
+LeoSatNodeHelper::SetStreaming (bool enable)
+{
+  m_streaming = enable;
+}
+
 NodeContainer
 LeoSatNodeHelper::Install (vector<string> &wpFiles)
 {
@@ -51,15 +59,28 @@ LeoSatNodeHelper::Install (vector<string> &wpFiles)
   NodeContainer nodes;
   for (size_t i = 0; i < wpFiles.size (); i ++)
     {
-      Ptr<WaypointMobilityModel> mob = CreateObject<WaypointMobilityModel> ();
+      Ptr<MobilityModel> mob;
       string fileName = wpFiles[i];
-      m_fileStreamContainer.SetFile (fileName);
-      Waypoint wp;
-      while (m_fileStreamContainer.GetNextSample (wp))
-      	{
-      	  mob->AddWaypoint (wp);
-          NS_LOG_DEBUG ("Added waypoint " << wp);
-      	}
+      if (m_streaming)
+        {
+          Ptr<LeoStreamingWaypointMobilityModel> streaming = CreateObject<LeoStreamingWaypointMobilityModel> ();
+          streaming->SetFile (fileName);
+          mob = streaming;
+        }
+      else
+        {
+          Ptr<WaypointMobilityModel> waypoints = CreateObject<WaypointMobilityModel> ();
+          m_fileStreamContainer.SetFile (fileName);
+          // do not skip the waypoints before the end of the previous file
+          m_fileStreamContainer.SetLastTime (Time (0));
+          Waypoint wp;
+          while (m_fileStreamContainer.GetNextSample (wp))
+            {
+              waypoints->AddWaypoint (wp);
+              NS_LOG_DEBUG ("Added waypoint " << wp);
+            }
+          mob = waypoints;
+        }
       Ptr<Node> node = m_satNodeFactory.Create<Node> ();
       node->AggregateObject (mob);
 
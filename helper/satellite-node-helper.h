@@ -63,11 +63,24 @@ public:
    */
   void SetAttribute (std::string name, const AttributeValue &value);
 
+  /**
+   * \brief Read the waypoints while the simulation advances instead of
+   * loading all of them at once
+   *
+   * The nodes installed afterwards get a LeoStreamingWaypointMobilityModel
+   * instead of a WaypointMobilityModel.
+   *
+   * \param enable whether to stream the waypoints
+   */
+  void SetStreaming (bool enable);
+
 private:
   /// Satellite nodes
   ObjectFactory m_satNodeFactory;
   /// Stream of waypoints
   LeoWaypointInputFileStreamContainer m_fileStreamContainer;
+  /// Whether the mobility models read the waypoints themselves
+  bool m_streaming;
 };
 
 }; // namespace ns3
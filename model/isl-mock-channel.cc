@@ -16,12 +16,16 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+
 #include <ns3/trace-source-accessor.h>
 #include <ns3/packet.h>
 #include <ns3/simulator.h>
 #include <ns3/log.h>
 #include <ns3/pointer.h>
+#include <ns3/double.h>
 #include "isl-mock-channel.h"
+#include "isl-propagation-loss-model.h"
 
 namespace ns3 {
 
@@ -36,6 +40,26 @@ IslMockChannel::GetTypeId (void)
     .SetParent<MockChannel> ()
     .SetGroupName ("Leo")
     .AddConstructor<IslMockChannel> ()
+    .AddAttribute ("MaxRange",
+                   "Maximum distance in meters over which two devices can "
+                   "communicate. 0 for no limit.",
+                   DoubleValue (0.0),
+                   MakeDoubleAccessor (&IslMockChannel::m_maxRange),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("NeighbourInterval",
+                   "Time between two computations of the devices within range "
+                   "of each other, which are the only ones considered for a "
+                   "broadcast. Requires MaxRange. 0 to consider all devices.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&IslMockChannel::m_neighbourInterval),
+                   MakeTimeChecker (Seconds (0)))
+    .AddAttribute ("NeighbourMargin",
+                   "Distance in meters added to MaxRange for the neighbour "
+                   "sets. Should cover how much closer two devices can get "
+                   "within one NeighbourInterval.",
+                   DoubleValue (20e3),
+                   MakeDoubleAccessor (&IslMockChannel::m_neighbourMargin),
+                   MakeDoubleChecker<double> (0.0))
   ;
   return tid;
 }
@@ -43,7 +67,9 @@ IslMockChannel::GetTypeId (void)
 //
 // By default, you get a channel that
 // has an "infitely" fast transmission speed and zero processing delay.
-IslMockChannel::IslMockChannel() : MockChannel ()
+IslMockChannel::IslMockChannel()
+  : MockChannel (),
+    m_neighbourEpoch (-1)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -52,6 +78,17 @@ IslMockChannel::~IslMockChannel()
 {
 }
 
+void
+IslMockChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_mobility.clear ();
+  m_unpositioned.clear ();
+  m_neighbours.clear ();
+  m_index = 0;
+  MockChannel::DoDispose ();
+}
+
 bool
 IslMockChannel::TransmitStart (
     Ptr<const Packet> p,
@@ -68,17 +105,40 @@ IslMockChannel::TransmitStart (
       return false;
     }
   Ptr<MockNetDevice> src = StaticCast<MockNetDevice> (GetDevice (srcId));
-  Ptr<MockNetDevice> dst = StaticCast<MockNetDevice> (GetDevice (destAddr));
+  Ptr<MockNetDevice> dst = GetDevice (destAddr);
 
   if (dst == nullptr)
   {
     if (Mac48Address::ConvertFrom (destAddr).IsBroadcast () || Mac48Address::ConvertFrom (destAddr).IsBroadcast ())
       // try to deliver to every node in LOS
       {
-        for (size_t i = 0; i < GetNDevices (); i ++)
+        m_candidates.clear ();
+        if (GetPlannedReceivers (srcId, m_candidates))
+          {
+            NS_LOG_LOGIC ("considering " << m_candidates.size () << " of " << GetNDevices () << " devices from contact plan");
+          }
+        else if (m_neighbourInterval > Seconds (0) && m_maxRange > 0)
+          {
+            UpdateNeighbours ();
+            m_candidates = m_neighbours[srcId];
+            NS_LOG_LOGIC ("considering " << m_candidates.size () << " of " << GetNDevices () << " devices from neighbour set");
+          }
+        else
+          {
+            for (uint32_t id = 0; id < GetNDevices (); id ++)
+              {
+                m_candidates.push_back (id);
+              }
+          }
+
+        m_receivers.clear ();
+        GetReceivers (srcId, m_candidates, m_receivers);
+        NS_LOG_LOGIC (m_receivers.size () << " of " << m_candidates.size () << " candidates are reachable");
+        // the devices of inter-satellite links are not typed
+        NotifyFiltered (OTHER, GetNDevices () - 1 - m_receivers.size ());
+        for (uint32_t id : m_receivers)
           {
-            if (i == srcId) continue;
-            dst = StaticCast<MockNetDevice> (GetDevice (i));
+            dst = StaticCast<MockNetDevice> (GetDevice (id));
             Deliver (p, src, dst, txTime);
           }
         return true;
@@ -91,8 +151,240 @@ IslMockChannel::TransmitStart (
   }
   else
   {
+    if (m_maxRange > 0)
+      {
+        UpdateMobility ();
+        Ptr<MobilityModel> srcMob = m_mobility[srcId];
+        Ptr<MobilityModel> dstMob = dst->GetNode () != 0 ? dst->GetNode ()->GetObject<MobilityModel> () : 0;
+        if (srcMob != 0 && dstMob != 0 && srcMob->GetDistanceFrom (dstMob) > m_maxRange)
+          {
+            NS_LOG_LOGIC ("destination " << destAddr << " is out of range");
+            NotifyDeliveryAttempt (src, dst, -1000.0, false);
+            return false;
+          }
+      }
     return Deliver (p, src, dst, txTime);
   }
 }
 
+int32_t
+IslMockChannel::Attach (Ptr<MockNetDevice> device)
+{
+  int32_t id = MockChannel::Attach (device);
+
+  Ptr<MobilityModel> mob;
+  if (device->GetNode () != 0)
+    {
+      mob = device->GetNode ()->GetObject<MobilityModel> ();
+    }
+  m_mobility.resize (id + 1);
+  m_mobility[id] = mob;
+  if (mob == 0)
+    {
+      m_unpositioned.push_back (id);
+    }
+
+  return id;
+}
+
+void
+IslMockChannel::Reserve (std::size_t n)
+{
+  MockChannel::Reserve (n);
+  m_mobility.reserve (n);
+}
+
+void
+IslMockChannel::UpdateMobility (void)
+{
+  // mobility models may be aggregated after the device has been attached
+  size_t i = 0;
+  while (i < m_unpositioned.size ())
+    {
+      uint32_t id = m_unpositioned[i];
+      Ptr<Node> node = GetDevice (id)->GetNode ();
+      if (node != 0)
+        {
+          m_mobility[id] = node->GetObject<MobilityModel> ();
+        }
+      if (m_mobility[id] != 0)
+        {
+          m_unpositioned[i] = m_unpositioned.back ();
+          m_unpositioned.pop_back ();
+        }
+      else
+        {
+          i ++;
+        }
+    }
+}
+
+void
+IslMockChannel::UpdateNeighbours (void)
+{
+  int64_t epoch = Simulator::Now ().GetTimeStep () / m_neighbourInterval.GetTimeStep ();
+  if (epoch == m_neighbourEpoch && m_neighbours.size () == GetNDevices ())
+    {
+      return;
+    }
+  NS_LOG_FUNCTION (this << epoch);
+  m_neighbourEpoch = epoch;
+
+  UpdateMobility ();
+  size_t n = m_mobility.size ();
+  m_positions.clear ();
+  m_positioned.clear ();
+  for (uint32_t id = 0; id < n; id ++)
+    {
+      if (m_mobility[id] != 0)
+        {
+          m_positioned.push_back (id);
+          m_positions.push_back (m_mobility[id]->GetPosition ());
+        }
+    }
+
+  // devices that are out of range at the start of the epoch may come into
+  // range before its end
+  double range = m_maxRange + m_neighbourMargin;
+  if (m_index == 0)
+    {
+      m_index = CreateObject<LeoGridSpatialIndex> ();
+    }
+  // with cells as large as the range, each query covers at most 27 cells
+  m_index->SetAttribute ("CellSize", DoubleValue (range));
+  m_index->Build (m_positions);
+
+  m_neighbours.resize (n);
+  for (std::vector<uint32_t> &neighbours : m_neighbours)
+    {
+      neighbours.clear ();
+    }
+  for (uint32_t i = 0; i < m_positioned.size (); i ++)
+    {
+      uint32_t id = m_positioned[i];
+      std::vector<uint32_t> &neighbours = m_neighbours[id];
+      m_index->Query (m_positions[i], range, neighbours);
+      for (uint32_t &neighbour : neighbours)
+        {
+          neighbour = m_positioned[neighbour];
+        }
+      // devices without a mobility model are neighbours of all devices
+      neighbours.insert (neighbours.end (), m_unpositioned.begin (), m_unpositioned.end ());
+      neighbours.erase (std::remove (neighbours.begin (), neighbours.end (), id), neighbours.end ());
+      std::sort (neighbours.begin (), neighbours.end ());
+    }
+  for (uint32_t id : m_unpositioned)
+    {
+      for (uint32_t j = 0; j < n; j ++)
+        {
+          if (j != id)
+            {
+              m_neighbours[id].push_back (j);
+            }
+        }
+    }
+}
+
+void
+IslMockChannel::GetReceivers (uint32_t srcId,
+                              const std::vector<uint32_t> &candidates,
+                              std::vector<uint32_t> &receivers)
+{
+  NS_LOG_FUNCTION (this << srcId << candidates.size ());
+
+  UpdateMobility ();
+  Ptr<MobilityModel> srcMob = m_mobility[srcId];
+  bool los = DynamicCast<IslPropagationLossModel> (GetPropagationLoss ()) != 0;
+  if (srcMob == 0 || (!los && m_maxRange <= 0))
+    {
+      for (uint32_t id : candidates)
+        {
+          if (id != srcId)
+            {
+              receivers.push_back (id);
+            }
+        }
+      return;
+    }
+
+  // positions may change at any time, so they are read for every broadcast
+  Vector srcPos = srcMob->GetPosition ();
+  size_t k = candidates.size ();
+  m_x.resize (k);
+  m_y.resize (k);
+  m_z.resize (k);
+  m_visible.resize ((k + 63) / 64);
+  for (size_t j = 0; j < k; j ++)
+    {
+      Ptr<MobilityModel> mob = m_mobility[candidates[j]];
+      Vector pos = mob != 0 ? mob->GetPosition () : srcPos;
+      m_x[j] = pos.x;
+      m_y[j] = pos.y;
+      m_z[j] = pos.z;
+    }
+
+  if (los)
+    {
+      IslPropagationLossModel::GetLos (srcPos, m_x.data (), m_y.data (), m_z.data (), k, m_visible.data ());
+    }
+  else
+    {
+      std::fill (m_visible.begin (), m_visible.end (), ~(uint64_t) 0);
+    }
+
+  double range2 = m_maxRange * m_maxRange;
+  for (size_t j = 0; j < k; j ++)
+    {
+      uint32_t id = candidates[j];
+      if (id == srcId)
+        {
+          continue;
+        }
+      // devices without a mobility model are always reached, like in Deliver
+      if (m_mobility[id] == 0)
+        {
+          receivers.push_back (id);
+          continue;
+        }
+      if (!((m_visible[j / 64] >> (j % 64)) & 1))
+        {
+          continue;
+        }
+      double dx = m_x[j] - srcPos.x;
+      double dy = m_y[j] - srcPos.y;
+      double dz = m_z[j] - srcPos.z;
+      if (m_maxRange > 0 && dx*dx + dy*dy + dz*dz > range2)
+        {
+          continue;
+        }
+      receivers.push_back (id);
+    }
+}
+
+void
+IslMockChannel::DoComputeContactPlan (Ptr<LeoContactPlan> plan)
+{
+  NS_LOG_FUNCTION (this << plan);
+
+  if (DynamicCast<IslPropagationLossModel> (GetPropagationLoss ()) == 0)
+    {
+      NS_LOG_WARN ("contact plan requires an IslPropagationLossModel");
+      return;
+    }
+
+  std::vector<uint32_t> ids;
+  for (uint32_t id = 0; id < GetNDevices (); id ++)
+    {
+      ids.push_back (id);
+    }
+
+  plan->Compute (GetMobilityModels (), ids, ids,
+                 [] (uint32_t a, const Vector &aPos, const double *x, const double *y, const double *z,
+                     size_t n, uint64_t *mask)
+                 {
+                   IslPropagationLossModel::GetLos (aPos, x, y, z, n, mask);
+                 },
+                 GetInstanceTypeId ().GetName ());
+}
+
 } // namespace ns3
@@ -20,6 +20,7 @@
 #define ISL_CHANNEL_H
 
 #include <string>
+#include <vector>
 #include <stdint.h>
 
 #include "ns3/object.h"
@@ -34,6 +35,7 @@
 #include "ns3/propagation-loss-model.h"
 #include "mock-net-device.h"
 #include "mock-channel.h"
+#include "leo-spatial-index.h"
 
 /**
  * \file
@@ -52,6 +54,12 @@ class MockNetDevice;
  * This channel distributes packets to all attached devies to which the sender has a line-of-sight.
  * It is typically used in conjunction with the IslPropagationLossModel and ConstantSpeedPropagationDelay.
  *
+ * With MaxRange set, devices that are farther apart cannot communicate. A
+ * broadcast then only considers the devices that have been within range
+ * of the sender at the start of the current NeighbourInterval, if that is
+ * set, and only delivers to the ones that are within range and have a
+ * line-of-sight at the time of the transmission.
+ *
  */
 class IslMockChannel : public MockChannel
 {
@@ -78,9 +86,97 @@ public:
    */
   bool TransmitStart (Ptr<const Packet> p, uint32_t devId, Address dst, Time txTime);
 
+  virtual int32_t Attach (Ptr<MockNetDevice> device);
+  virtual void Reserve (std::size_t n);
+
+protected:
+  virtual void DoDispose (void);
+
+  /**
+   * \brief Compute the contacts between all pairs of devices
+   *
+   * Requires the propagation loss model to be an IslPropagationLossModel.
+   *
+   * \param plan contact plan
+   */
+  virtual void DoComputeContactPlan (Ptr<LeoContactPlan> plan);
+
 private:
+  /**
+   * \brief Look up the mobility models of the devices that did not have one
+   * at the last call
+   */
+  void UpdateMobility (void);
+
+  /**
+   * \brief Recompute the neighbour sets if a new epoch has started
+   *
+   * The neighbours of each device are found by a range query on a
+   * LeoGridSpatialIndex over the positions of all devices.
+   */
+  void UpdateNeighbours (void);
+
+  /**
+   * \brief Find the candidates that can be reached by a broadcast
+   *
+   * Checks the line-of-sight of all candidates at once with the batch kernel
+   * of the IslPropagationLossModel, if that is the propagation loss model,
+   * and their distance to the sender against MaxRange. Devices without a
+   * mobility model are always reached, like in Deliver.
+   *
+   * \param srcId id of the sender
+   * \param candidates ids of the devices to check
+   * \param [out] receivers ids of the reachable devices are appended to this
+   * vector
+   */
+  void GetReceivers (uint32_t srcId,
+                     const std::vector<uint32_t> &candidates,
+                     std::vector<uint32_t> &receivers);
+
   std::vector<Ptr<MockNetDevice> > m_link; ///< Attached devices
 
+  /// Buffer for the receivers of a broadcast
+  std::vector<uint32_t> m_receivers;
+
+  /// Buffer for the devices considered for a broadcast
+  std::vector<uint32_t> m_candidates;
+
+  /// Maximum distance between two devices that can communicate, 0 for no limit
+  double m_maxRange;
+
+  /// Time between two computations of the neighbour sets, 0 if disabled
+  Time m_neighbourInterval;
+
+  /// Distance added to the range for the neighbour sets
+  double m_neighbourMargin;
+
+  /// Epoch for which the neighbour sets have been computed
+  int64_t m_neighbourEpoch;
+
+  /// Ids of the devices within range of each device
+  std::vector<std::vector<uint32_t> > m_neighbours;
+
+  /// Mobility models of the devices for the batch line-of-sight check
+  std::vector<Ptr<MobilityModel> > m_mobility;
+
+  /// Ids of the devices without a mobility model
+  std::vector<uint32_t> m_unpositioned;
+
+  /// Index over the positions of the devices for the neighbour sets
+  Ptr<LeoGridSpatialIndex> m_index;
+
+  /// Positions of the devices in the index
+  std::vector<Vector> m_positions;
+
+  /// Ids of the devices in the index by their identifier inside the index
+  std::vector<uint32_t> m_positioned;
+
+  /// Coordinates of the devices for the range and line-of-sight checks
+  std::vector<double> m_x, m_y, m_z;
+
+  /// Visibility bits of the devices
+  std::vector<uint64_t> m_visible;
+
 
 }; // class MockChannel
 
@@ -21,12 +21,119 @@
 #include "ns3/double.h"
 #include "math.h"
 
+#include <algorithm>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LEO_LOS_AVX2
+#include <immintrin.h>
+#endif
+
 #include "isl-propagation-loss-model.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("IslPropagationLossModel");
 
+#ifdef LEO_LOS_AVX2
+/**
+ * \brief Check if the processor supports AVX2
+ * \return true iff the AVX2 kernel can be used
+ */
+static bool
+HasAvx2 (void)
+{
+#ifdef __AVX2__
+  return true;
+#else
+  static const bool avx2 = __builtin_cpu_supports ("avx2");
+  return avx2;
+#endif
+}
+
+/**
+ * \brief Check the line-of-sight of blocks of four positions
+ *
+ * Does the same operations in the same order as the scalar GetLos, so that
+ * both give the same result.
+ *
+ * \param src source position
+ * \param x x coordinates of the positions
+ * \param y y coordinates of the positions
+ * \param z z coordinates of the positions
+ * \param n number of positions
+ * \param [out] mask visibility bits, must be cleared
+ * \return number of checked positions
+ */
+__attribute__ ((target ("avx2")))
+static size_t
+GetLosAvx2 (const Vector &src, const double *x, const double *y, const double *z,
+            size_t n, uint64_t *mask)
+{
+  const __m256d ax = _mm256_set1_pd (src.x);
+  const __m256d ay = _mm256_set1_pd (src.y);
+  const __m256d az = _mm256_set1_pd (src.z);
+  const __m256d la = _mm256_set1_pd (src.GetLength ());
+  const __m256d r2 = _mm256_set1_pd (LEO_EARTH_RAD*LEO_EARTH_RAD);
+  const __m256d sign = _mm256_set1_pd (-0.0);
+  const __m256d zero = _mm256_setzero_pd ();
+  const __m256d two = _mm256_set1_pd (2.0);
+  const __m256d four = _mm256_set1_pd (4.0);
+
+  size_t blocks = n & ~(size_t) 3;
+  for (size_t i = 0; i < blocks; i += 4)
+    {
+      __m256d bx = _mm256_loadu_pd (x + i);
+      __m256d by = _mm256_loadu_pd (y + i);
+      __m256d bz = _mm256_loadu_pd (z + i);
+      __m256d lb = _mm256_sqrt_pd (_mm256_add_pd (_mm256_add_pd (_mm256_mul_pd (bx, bx),
+                                                                 _mm256_mul_pd (by, by)),
+                                                  _mm256_mul_pd (bz, bz)));
+
+      // select upper satellite as origin
+      __m256d upper = _mm256_cmp_pd (la, lb, _CMP_GT_OQ);
+      __m256d ocx = _mm256_blendv_pd (bx, ax, upper);
+      __m256d ocy = _mm256_blendv_pd (by, ay, upper);
+      __m256d ocz = _mm256_blendv_pd (bz, az, upper);
+      __m256d ux = _mm256_sub_pd (_mm256_blendv_pd (ax, bx, upper), ocx);
+      __m256d uy = _mm256_sub_pd (_mm256_blendv_pd (ay, by, upper), ocy);
+      __m256d uz = _mm256_sub_pd (_mm256_blendv_pd (az, bz, upper), ocz);
+
+      __m256d s2 = _mm256_sqrt_pd (_mm256_add_pd (_mm256_add_pd (_mm256_mul_pd (ux, ux),
+                                                                 _mm256_mul_pd (uy, uy)),
+                                                  _mm256_mul_pd (uz, uz)));
+      ux = _mm256_div_pd (ux, s2);
+      uy = _mm256_div_pd (uy, s2);
+      uz = _mm256_div_pd (uz, s2);
+
+      __m256d a = _mm256_add_pd (_mm256_add_pd (_mm256_mul_pd (ux, ux),
+                                                _mm256_mul_pd (uy, uy)),
+                                 _mm256_mul_pd (uz, uz));
+      __m256d b = _mm256_mul_pd (two, _mm256_add_pd (_mm256_add_pd (_mm256_mul_pd (ocx, ux),
+                                                                    _mm256_mul_pd (ocy, uy)),
+                                                     _mm256_mul_pd (ocz, uz)));
+      __m256d c = _mm256_sub_pd (_mm256_add_pd (_mm256_add_pd (_mm256_mul_pd (ocx, ocx),
+                                                               _mm256_mul_pd (ocy, ocy)),
+                                                _mm256_mul_pd (ocz, ocz)),
+                                 r2);
+      __m256d discriminant = _mm256_sub_pd (_mm256_mul_pd (b, b),
+                                            _mm256_mul_pd (_mm256_mul_pd (four, a), c));
+
+      // negative discriminants give NaN, which fails all comparisons below
+      __m256d root = _mm256_sqrt_pd (discriminant);
+      __m256d minusB = _mm256_xor_pd (b, sign);
+      __m256d twoA = _mm256_mul_pd (two, a);
+      __m256d t1 = _mm256_andnot_pd (sign, _mm256_div_pd (_mm256_sub_pd (minusB, root), twoA));
+      __m256d t2 = _mm256_andnot_pd (sign, _mm256_div_pd (_mm256_add_pd (minusB, root), twoA));
+
+      __m256d los = _mm256_or_pd (_mm256_cmp_pd (discriminant, zero, _CMP_LT_OQ),
+                                  _mm256_and_pd (_mm256_cmp_pd (s2, t1, _CMP_LT_OQ),
+                                                 _mm256_cmp_pd (s2, t2, _CMP_LT_OQ)));
+      mask[i / 64] |= (uint64_t) _mm256_movemask_pd (los) << (i % 64);
+    }
+  return blocks;
+}
+#endif
+
 NS_OBJECT_ENSURE_REGISTERED (IslPropagationLossModel);
 
 TypeId
@@ -51,10 +158,21 @@ IslPropagationLossModel::~IslPropagationLossModel ()
 bool
 IslPropagationLossModel::GetLos (Ptr<MobilityModel> moda, Ptr<MobilityModel> modb)
 {
-  // origin of LOS
   Vector3D apos = moda->GetPosition ();
   Vector3D bpos = modb->GetPosition ();
 
+  bool los = GetLos (apos, bpos);
+
+  NS_LOG_DEBUG ("a_pos="<<apos<<";b_pos"<<bpos<<";los="<<los);
+
+  return los;
+}
+
+bool
+IslPropagationLossModel::GetLos (const Vector &apos, const Vector &bpos)
+{
+  // no logging in here, this is also used to precompute contacts in parallel
+
   // select upper satellite as origin
   Vector oc = apos.GetLength () > bpos.GetLength () ? apos : bpos;
   Vector bp = apos.GetLength () > bpos.GetLength () ? bpos : apos;
@@ -70,13 +188,6 @@ IslPropagationLossModel::GetLos (Ptr<MobilityModel> moda, Ptr<MobilityModel> mod
   double c = (oc.x*oc.x + oc.y*oc.y + oc.z*oc.z) - (LEO_EARTH_RAD*LEO_EARTH_RAD);
   double discriminant = b*b - 4*a*c;
 
-  NS_LOG_DEBUG ("a_pos="<<moda->GetPosition ()<<";b_pos"<<modb->GetPosition ()
-  		<<";u="<<u
-  		<<";a="<<a
-  		<<";b="<<b
-  		<<";c="<<c
-  		<<";disc="<<discriminant);
-
   if (discriminant < 0)
     {
       return true;
@@ -87,15 +198,35 @@ IslPropagationLossModel::GetLos (Ptr<MobilityModel> moda, Ptr<MobilityModel> mod
       double t1 = (-b - sqrt (discriminant)) / (2.0 * a);
       double t2 = (-b + sqrt (discriminant)) / (2.0 * a);
 
-      NS_LOG_DEBUG ("t1="<<t1
-      		    <<"t2="<<t2
-      		    <<"s2="<<s2);
-
       // check if second sat is behind earth
       return (s2 < abs (t1) && s2 < abs (t2));
     }
 }
 
+void
+IslPropagationLossModel::GetLos (const Vector &a, const double *x, const double *y, const double *z,
+                                 size_t n, uint64_t *mask)
+{
+  // no logging in here, this is also used to precompute contacts in parallel
+
+  std::fill (mask, mask + (n + 63) / 64, 0);
+
+  size_t i = 0;
+#ifdef LEO_LOS_AVX2
+  if (HasAvx2 ())
+    {
+      i = GetLosAvx2 (a, x, y, z, n, mask);
+    }
+#endif
+  for (; i < n; i ++)
+    {
+      if (GetLos (a, Vector (x[i], y[i], z[i])))
+        {
+          mask[i / 64] |= (uint64_t) 1 << (i % 64);
+        }
+    }
+}
+
 double
 IslPropagationLossModel::DoCalcRxPower (double txPowerDbm,
                                         Ptr<MobilityModel> a,
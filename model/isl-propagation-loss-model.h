@@ -19,6 +19,9 @@
 #ifndef ISL_PROPAGATION_LOSS_MODEL_H
 #define ISL_PROPAGATION_LOSS_MODEL_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 #include <ns3/object.h>
 #include <ns3/propagation-loss-model.h>
 
@@ -62,6 +65,32 @@ public:
    * \return true iff there is a line-of-sight between the points
    */
   static bool GetLos (Ptr<MobilityModel> a, Ptr<MobilityModel> b);
+
+  /**
+   * \brief Check if there is a direc line-of-sight between the two positions
+   *
+   * \param a first position
+   * \param b second position
+   * \return true iff there is a line-of-sight between the positions
+   */
+  static bool GetLos (const Vector &a, const Vector &b);
+
+  /**
+   * \brief Check which of many positions have a line-of-sight to a position
+   *
+   * The positions are given as separate arrays of their coordinates. Bit i of
+   * the mask is set iff GetLos (a, position i) is true. On x86 processors with
+   * AVX2 four positions are checked at once, otherwise one after another.
+   *
+   * \param a source position
+   * \param x x coordinates of the positions
+   * \param y y coordinates of the positions
+   * \param z z coordinates of the positions
+   * \param n number of positions
+   * \param [out] mask (n + 63) / 64 words of visibility bits
+   */
+  static void GetLos (const Vector &a, const double *x, const double *y, const double *z,
+                      size_t n, uint64_t *mask);
 private:
   /**
    * Returns the Rx Power taking into account only the particular
@@ -19,9 +19,11 @@
 #include "math.h"
 
 #include "ns3/double.h"
+#include "ns3/enum.h"
 #include "ns3/simulator.h"
 
 #include "leo-circular-orbit-mobility-model.h"
+#include "leo-constellation-propagator.h"
 
 namespace ns3 {
 
@@ -54,11 +56,20 @@ LeoCircularOrbitMobilityModel::GetTypeId ()
                    TimeValue (Seconds (1)),
                    MakeTimeAccessor (&LeoCircularOrbitMobilityModel::m_precision),
                    MakeTimeChecker ())
+    .AddAttribute ("UpdateMode",
+                   "Whether the position is updated every Precision by a simulation event or "
+                   "computed when it is read. In lazy mode, CourseChange is only notified "
+                   "when the position of a new interval is read.",
+                   EnumValue (LeoCircularOrbitMobilityModel::PERIODIC),
+                   MakeEnumAccessor (&LeoCircularOrbitMobilityModel::SetUpdateMode,
+                                     &LeoCircularOrbitMobilityModel::GetUpdateMode),
+                   MakeEnumChecker (LeoCircularOrbitMobilityModel::PERIODIC, "Periodic",
+                                    LeoCircularOrbitMobilityModel::LAZY, "Lazy"))
     ;
   return tid;
 }
 
-LeoCircularOrbitMobilityModel::LeoCircularOrbitMobilityModel() : MobilityModel (), m_longitude (0.0), m_offset (0.0), m_position ()
+LeoCircularOrbitMobilityModel::LeoCircularOrbitMobilityModel() : MobilityModel (), m_longitude (0.0), m_offset (0.0), m_position (), m_updateMode (PERIODIC), m_clocked (false), m_bucketValid (false), m_slot (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
 }
@@ -100,14 +111,14 @@ LeoCircularOrbitMobilityModel::DoGetVelocity () const
 {
   Vector3D pos = DoGetPosition ();
   pos = Vector3D (pos.x / pos.GetLength (), pos.y / pos.GetLength (), pos.z / pos.GetLength ());
-  Vector3D heading = CrossProduct (PlaneNorm (), pos);
+  Vector3D heading = CrossProduct (PlaneNorm (Simulator::Now ()), pos);
   return Product (GetSpeed (), heading);
 }
 
 Vector3D
-LeoCircularOrbitMobilityModel::PlaneNorm () const
+LeoCircularOrbitMobilityModel::PlaneNorm (Time t) const
 {
-  double lat = CalcLatitude ();
+  double lat = CalcLatitude (t);
   return Vector3D (sin (-m_inclination) * cos (lat),
   		   sin (-m_inclination) * sin (lat),
   		   cos (m_inclination));
@@ -128,9 +139,9 @@ LeoCircularOrbitMobilityModel::GetProgress (Time t) const
 }
 
 Vector3D
-LeoCircularOrbitMobilityModel::RotatePlane (double a, const Vector3D &x) const
+LeoCircularOrbitMobilityModel::RotatePlane (Time t, double a, const Vector3D &x) const
 {
-  Vector3D n = PlaneNorm ();
+  Vector3D n = PlaneNorm (t);
 
   return Product (DotProduct (n, x), n)
     + Product (cos (a), CrossProduct (CrossProduct (n, x), n))
@@ -138,31 +149,70 @@ LeoCircularOrbitMobilityModel::RotatePlane (double a, const Vector3D &x) const
 }
 
 double
-LeoCircularOrbitMobilityModel::CalcLatitude () const
+LeoCircularOrbitMobilityModel::CalcLatitude (Time t) const
 {
-  return m_longitude + ((Simulator::Now ().GetDouble () / Hours (24).GetDouble ()) * 2 * M_PI);
+  return m_longitude + ((t.GetDouble () / Hours (24).GetDouble ()) * 2 * M_PI);
 }
 
 Vector
 LeoCircularOrbitMobilityModel::CalcPosition (Time t) const
 {
-  double lat = CalcLatitude ();
+  double lat = CalcLatitude (t);
   // account for orbit latitude and earth rotation offset
   Vector3D x = Product (m_orbitHeight*1000, Vector3D (cos (m_inclination) * cos (lat),
   			       cos (m_inclination) * sin (lat),
   			       sin (m_inclination)));
 
-  return RotatePlane (GetProgress (t), x);
+  return RotatePlane (t, GetProgress (t), x);
+}
+
+Vector
+LeoCircularOrbitMobilityModel::GetPositionAt (Time t) const
+{
+  return CalcPosition (t);
+}
+
+Vector
+LeoCircularOrbitMobilityModel::PropagatePosition (Time t) const
+{
+  if (m_propagator != 0)
+    {
+      return m_propagator->GetPosition (m_slot, t);
+    }
+  return CalcPosition (t);
+}
+
+void
+LeoCircularOrbitMobilityModel::SetUpdateMode (UpdateMode mode)
+{
+  m_updateMode = mode;
+  Update ();
+}
+
+LeoCircularOrbitMobilityModel::UpdateMode
+LeoCircularOrbitMobilityModel::GetUpdateMode (void) const
+{
+  return m_updateMode;
 }
 
 Vector LeoCircularOrbitMobilityModel::Update ()
 {
-  m_position = CalcPosition (Simulator::Now ());
+  // there must only be one chain of periodic updates, even if the orbit is
+  // changed multiple times
+  m_updateEvent.Cancel ();
+
+  if (m_updateMode == LAZY)
+    {
+      m_bucketValid = false;
+      return DoGetPosition ();
+    }
+
+  m_position = PropagatePosition (Simulator::Now ());
   NotifyCourseChange ();
 
-  if (m_precision > Seconds (0))
+  if (m_precision > Seconds (0) && !m_clocked)
     {
-      Simulator::Schedule (m_precision, &LeoCircularOrbitMobilityModel::Update, this);
+      m_updateEvent = Simulator::Schedule (m_precision, &LeoCircularOrbitMobilityModel::Update, this);
     }
 
   return m_position;
@@ -174,7 +224,21 @@ LeoCircularOrbitMobilityModel::DoGetPosition (void) const
   if (m_precision == Time (0))
     {
       // Notice: NotifyCourseChange () will not be called
-      return CalcPosition (Simulator::Now ());
+      return PropagatePosition (Simulator::Now ());
+    }
+  if (m_updateMode == LAZY)
+    {
+      // quantize to the precision, so that all reads within the same
+      // interval share one computation
+      int64_t step = m_precision.GetTimeStep ();
+      Time bucket = TimeStep ((Simulator::Now ().GetTimeStep () / step) * step);
+      if (!m_bucketValid || bucket != m_bucket)
+        {
+          m_position = PropagatePosition (bucket);
+          m_bucket = bucket;
+          m_bucketValid = true;
+          NotifyCourseChange ();
+        }
     }
   return m_position;
 }
@@ -188,6 +252,8 @@ LeoCircularOrbitMobilityModel::DoSetPosition (const Vector &position)
   // SetPostion
   m_longitude = position.x;
   m_offset = position.y;
+  // the orbit is not the one known to the propagator anymore
+  m_propagator = 0;
   Update ();
 }
 
@@ -199,6 +265,7 @@ double LeoCircularOrbitMobilityModel::GetAltitude () const
 void LeoCircularOrbitMobilityModel::SetAltitude (double h)
 {
   m_orbitHeight = LEO_EARTH_RAD_KM + h;
+  m_propagator = 0;
   Update ();
 }
 
@@ -211,6 +278,7 @@ void LeoCircularOrbitMobilityModel::SetInclination (double incl)
 {
   NS_ASSERT_MSG (incl != 0.0, "Plane must not be orthogonal to axis");
   m_inclination = (incl / 180.0) * M_PI;
+  m_propagator = 0;
   Update ();
 }
 
@@ -24,6 +24,7 @@
 #include "ns3/log.h"
 #include "ns3/mobility-model.h"
 #include "ns3/nstime.h"
+#include "ns3/event-id.h"
 
 /**
  * \file
@@ -37,6 +38,9 @@
 
 namespace ns3 {
 
+class LeoConstellationPropagator;
+class LeoConstellationClock;
+
 /**
  * \ingroup leo
  * \brief Keep track of the orbital postion and velocity of a satellite.
@@ -46,12 +50,25 @@ namespace ns3 {
  */
 class LeoCircularOrbitMobilityModel : public MobilityModel
 {
+  friend class LeoConstellationPropagator;
+  friend class LeoConstellationClock;
+
 public:
   /**
    * \brief Get the type ID.
    * \return the object TypeId
    */
   static TypeId GetTypeId (void);
+
+  /// How the position is kept up to date
+  enum UpdateMode
+  {
+    /// Update the position every Precision in a simulation event
+    PERIODIC,
+    /// Compute the position when it is read, once per Precision
+    LAZY
+  };
+
   /// constructor
   LeoCircularOrbitMobilityModel ();
   /// destructor
@@ -86,6 +103,18 @@ public:
    */
   void SetInclination (double incl);
 
+  /**
+   * \brief Get the position at an arbitrary point in time
+   *
+   * Unlike GetPosition, this does not depend on the current simulation time
+   * or the precision of the model and does not notify about course changes,
+   * so it may be used to predict the orbit, even from multiple threads.
+   *
+   * \param t point in time
+   * \return position at time t
+   */
+  Vector GetPositionAt (Time t) const;
+
 private:
 
   /**
@@ -111,13 +140,49 @@ private:
   /**
    * Current position
    */
-  Vector3D m_position;
+  mutable Vector3D m_position;
 
   /**
    * Time precision for positions
    */
   Time m_precision;
 
+  /**
+   * How the position is kept up to date
+   */
+  UpdateMode m_updateMode;
+
+  /**
+   * Next periodic update
+   */
+  EventId m_updateEvent;
+
+  /**
+   * Whether a LeoConstellationClock updates the position instead of periodic
+   * events of this model
+   */
+  bool m_clocked;
+
+  /**
+   * Start of the precision interval of m_position in lazy mode
+   */
+  mutable Time m_bucket;
+
+  /**
+   * Whether m_position is known for m_bucket in lazy mode
+   */
+  mutable bool m_bucketValid;
+
+  /**
+   * Computes the positions of all satellites of the constellation, if any
+   */
+  Ptr<LeoConstellationPropagator> m_propagator;
+
+  /**
+   * Slot of the satellite inside the propagator
+   */
+  uint32_t m_slot;
+
   /**
    * \return the current position.
    */
@@ -133,8 +198,9 @@ private:
 
   /**
    * \brief Get the normal vector of the orbital plane
+   * \param t time
    */
-  Vector3D PlaneNorm () const;
+  Vector3D PlaneNorm (Time t) const;
 
   /**
    * \brief Gets the distance the satellite has progressed from its original
@@ -147,11 +213,12 @@ private:
 
   /**
    * \brief Advances a satellite by a degrees inside the orbital plane
+   * \param t time
    * \param a angle by which to rotate
    * \param x vector to rotate
    * \return rotated vector
    */
-  Vector3D RotatePlane (double a, const Vector3D &x) const;
+  Vector3D RotatePlane (Time t, double a, const Vector3D &x) const;
 
   /**
    * \brief Calculate the position at time t
@@ -160,13 +227,33 @@ private:
    */
   Vector CalcPosition (Time t) const;
 
+  /**
+   * \brief Get the position at time t, from the propagator if there is one
+   * \param t time
+   * \return position at time t
+   */
+  Vector PropagatePosition (Time t) const;
+
   /**
    * \brief Calc the latitude depending on simulation time inside ITRF coordinate
    * system
    *
+   * \param t time
    * \return latitude
    */
-  double CalcLatitude () const;
+  double CalcLatitude (Time t) const;
+
+  /**
+   * \brief Set how the position is kept up to date
+   * \param mode update mode
+   */
+  void SetUpdateMode (UpdateMode mode);
+
+  /**
+   * \brief Get how the position is kept up to date
+   * \return update mode
+   */
+  UpdateMode GetUpdateMode (void) const;
 
   /**
    * \brief Update the internal position of the mobility model
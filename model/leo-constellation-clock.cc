@@ -0,0 +1,131 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tim Schubert <ns-3-leo@timschubert.net>
+ */
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/uinteger.h"
+
+#include "leo-circular-orbit-mobility-model.h"
+#include "leo-constellation-propagator.h"
+#include "leo-constellation-clock.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LeoConstellationClock");
+
+NS_OBJECT_ENSURE_REGISTERED (LeoConstellationClock);
+
+TypeId
+LeoConstellationClock::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LeoConstellationClock")
+    .SetParent<Object> ()
+    .SetGroupName ("Leo")
+    .AddConstructor<LeoConstellationClock> ()
+    .AddAttribute ("Precision",
+                   "Time between two updates of the positions",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&LeoConstellationClock::m_precision),
+                   MakeTimeChecker (TimeStep (1)))
+    .AddAttribute ("Threads",
+                   "Number of threads used to compute the positions of the orbital planes",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&LeoConstellationClock::m_threads),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+LeoConstellationClock::LeoConstellationClock ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LeoConstellationClock::~LeoConstellationClock ()
+{
+}
+
+void
+LeoConstellationClock::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_tickEvent.Cancel ();
+  m_models.clear ();
+  m_propagator = 0;
+  Object::DoDispose ();
+}
+
+void
+LeoConstellationClock::Add (Ptr<LeoCircularOrbitMobilityModel> model)
+{
+  NS_LOG_FUNCTION (this << model);
+
+  model->m_clocked = true;
+  model->m_updateEvent.Cancel ();
+  m_models.push_back (model);
+
+  if (!m_tickEvent.IsRunning ())
+    {
+      m_tickEvent = Simulator::Schedule (m_precision, &LeoConstellationClock::Tick, Ptr<LeoConstellationClock> (this));
+    }
+}
+
+uint32_t
+LeoConstellationClock::GetN (void) const
+{
+  return m_models.size ();
+}
+
+void
+LeoConstellationClock::SetPropagator (Ptr<LeoConstellationPropagator> propagator)
+{
+  m_propagator = propagator;
+}
+
+void
+LeoConstellationClock::Tick (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  Time now = Simulator::Now ();
+  if (m_propagator != 0)
+    {
+      m_propagator->Update (now, m_threads);
+    }
+
+  // all positions are updated before any course change is notified, so that
+  // trace sinks see a consistent constellation
+  for (Ptr<LeoCircularOrbitMobilityModel> &model : m_models)
+    {
+      if (model->m_updateMode == LeoCircularOrbitMobilityModel::PERIODIC)
+        {
+          model->m_position = model->PropagatePosition (now);
+        }
+    }
+  for (Ptr<LeoCircularOrbitMobilityModel> &model : m_models)
+    {
+      if (model->m_updateMode == LeoCircularOrbitMobilityModel::PERIODIC)
+        {
+          model->NotifyCourseChange ();
+        }
+    }
+
+  m_tickEvent = Simulator::Schedule (m_precision, &LeoConstellationClock::Tick, Ptr<LeoConstellationClock> (this));
+}
+
+};
@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tim Schubert <ns-3-leo@timschubert.net>
+ */
+
+#ifndef LEO_CONSTELLATION_CLOCK_H
+#define LEO_CONSTELLATION_CLOCK_H
+
+#include <vector>
+#include <stdint.h>
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/event-id.h"
+
+/**
+ * \file
+ * \ingroup leo
+ *
+ * Declaration of LeoConstellationClock
+ */
+
+namespace ns3 {
+
+class LeoCircularOrbitMobilityModel;
+class LeoConstellationPropagator;
+
+/**
+ * \ingroup leo
+ * \brief Updates the positions of all satellites of a constellation in a
+ * single event
+ *
+ * Instead of every satellite scheduling its own update every Precision, the
+ * clock fires once per Precision and updates the positions of all of its
+ * satellites in one loop before notifying their course changes. If the
+ * satellites share a LeoConstellationPropagator, the planes may be computed
+ * in parallel.
+ *
+ * Satellites in the lazy update mode are skipped.
+ */
+class LeoConstellationClock : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /// constructor
+  LeoConstellationClock ();
+  /// destructor
+  virtual ~LeoConstellationClock ();
+
+  /**
+   * \brief Let the clock update the position of a satellite
+   *
+   * The satellite stops scheduling updates by itself. The clock starts
+   * ticking when the first satellite is added.
+   *
+   * \param model mobility model of the satellite
+   */
+  void Add (Ptr<LeoCircularOrbitMobilityModel> model);
+
+  /**
+   * \brief Get the number of satellites
+   * \return number of satellites
+   */
+  uint32_t GetN (void) const;
+
+  /**
+   * \brief Set the propagator that computes the positions of the satellites
+   * \param propagator propagator
+   */
+  void SetPropagator (Ptr<LeoConstellationPropagator> propagator);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Update the positions of all satellites and schedule the next tick
+   */
+  void Tick (void);
+
+  /// Time between two ticks
+  Time m_precision;
+
+  /// Number of threads used to compute the planes
+  uint32_t m_threads;
+
+  /// Satellites
+  std::vector<Ptr<LeoCircularOrbitMobilityModel> > m_models;
+
+  /// Propagator of the satellites, if any
+  Ptr<LeoConstellationPropagator> m_propagator;
+
+  /// Next tick
+  EventId m_tickEvent;
+};
+
+};
+
+#endif
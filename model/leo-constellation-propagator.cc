@@ -0,0 +1,197 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tim Schubert <ns-3-leo@timschubert.net>
+ */
+
+#include <math.h>
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+#include "ns3/log.h"
+
+#include "leo-circular-orbit-mobility-model.h"
+#include "leo-constellation-propagator.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LeoConstellationPropagator");
+
+NS_OBJECT_ENSURE_REGISTERED (LeoConstellationPropagator);
+
+TypeId
+LeoConstellationPropagator::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LeoConstellationPropagator")
+    .SetParent<Object> ()
+    .SetGroupName ("Leo")
+    .AddConstructor<LeoConstellationPropagator> ()
+  ;
+  return tid;
+}
+
+LeoConstellationPropagator::LeoConstellationPropagator ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LeoConstellationPropagator::~LeoConstellationPropagator ()
+{
+}
+
+uint32_t
+LeoConstellationPropagator::Add (Ptr<LeoCircularOrbitMobilityModel> model)
+{
+  NS_LOG_FUNCTION (this << model);
+
+  std::tuple<double, double, double> key (model->m_orbitHeight, model->m_inclination, model->m_longitude);
+  std::map<std::tuple<double, double, double>, uint32_t>::iterator it = m_planeIndex.find (key);
+  if (it == m_planeIndex.end ())
+    {
+      Plane plane;
+      plane.radius = model->m_orbitHeight * 1000;
+      plane.cosInclination = cos (model->m_inclination);
+      plane.sinInclination = sin (model->m_inclination);
+      plane.longitude = model->m_longitude;
+      // same as LeoCircularOrbitMobilityModel::GetProgress
+      int sign = model->m_inclination > M_PI/2 ? -1 : 1;
+      plane.angularSpeed = sign * model->GetSpeed () / (LEO_EARTH_RAD_KM * 1000);
+      plane.valid = false;
+      it = m_planeIndex.insert (std::make_pair (key, m_planes.size ())).first;
+      m_planes.push_back (plane);
+    }
+
+  Plane &plane = m_planes[it->second];
+  plane.cosOffset.push_back (cos (model->m_offset));
+  plane.sinOffset.push_back (sin (model->m_offset));
+  plane.x.push_back (0);
+  plane.y.push_back (0);
+  plane.z.push_back (0);
+  plane.valid = false;
+
+  uint32_t slot = m_slots.size ();
+  m_slots.push_back (std::make_pair (it->second, plane.x.size () - 1));
+
+  model->m_propagator = this;
+  model->m_slot = slot;
+
+  return slot;
+}
+
+void
+LeoConstellationPropagator::Reserve (uint32_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  m_slots.reserve (n);
+}
+
+uint32_t
+LeoConstellationPropagator::GetN (void) const
+{
+  return m_slots.size ();
+}
+
+uint32_t
+LeoConstellationPropagator::GetNPlanes (void) const
+{
+  return m_planes.size ();
+}
+
+void
+LeoConstellationPropagator::Update (Time t, uint32_t threads)
+{
+  NS_LOG_FUNCTION (this << t << threads);
+
+  threads = std::max (1u, std::min (threads, (uint32_t) m_planes.size ()));
+  std::function<void (uint32_t)> sweep = [this, t, threads] (uint32_t first)
+    {
+      for (size_t i = first; i < m_planes.size (); i += threads)
+        {
+          Plane &plane = m_planes[i];
+          if (!plane.valid || plane.time != t)
+            {
+              Evaluate (plane, t);
+            }
+        }
+    };
+
+  std::vector<std::thread> workers;
+  for (uint32_t i = 1; i < threads; i ++)
+    {
+      workers.push_back (std::thread (sweep, i));
+    }
+  sweep (0);
+  for (std::thread &worker : workers)
+    {
+      worker.join ();
+    }
+}
+
+Vector
+LeoConstellationPropagator::GetPosition (uint32_t slot, Time t)
+{
+  NS_ASSERT_MSG (slot < m_slots.size (), "unknown slot " << slot);
+  Plane &plane = m_planes[m_slots[slot].first];
+  if (!plane.valid || plane.time != t)
+    {
+      Evaluate (plane, t);
+    }
+  uint32_t i = m_slots[slot].second;
+  return Vector (plane.x[i], plane.y[i], plane.z[i]);
+}
+
+void
+LeoConstellationPropagator::Evaluate (Plane &plane, Time t)
+{
+  // With the plane normal n = (-sin(i) cos(lat), -sin(i) sin(lat), cos(i))
+  // and the ascending node u = (cos(i) cos(lat), cos(i) sin(lat), sin(i)),
+  // which are orthogonal, the rotation inside the plane of
+  // LeoCircularOrbitMobilityModel::RotatePlane reduces to
+  //   cos(a) u + sin(a) (n x u), with n x u = (-sin(lat), cos(lat), 0)
+  double lat = plane.longitude + ((t.GetDouble () / Hours (24).GetDouble ()) * 2 * M_PI);
+  double cosLat = cos (lat);
+  double sinLat = sin (lat);
+  double progress = plane.angularSpeed * t.GetSeconds ();
+  double cosProgress = cos (progress);
+  double sinProgress = sin (progress);
+
+  double ux = plane.radius * plane.cosInclination * cosLat;
+  double uy = plane.radius * plane.cosInclination * sinLat;
+  double uz = plane.radius * plane.sinInclination;
+  double vx = - plane.radius * sinLat;
+  double vy = plane.radius * cosLat;
+
+  size_t n = plane.x.size ();
+  const double *co = plane.cosOffset.data ();
+  const double *so = plane.sinOffset.data ();
+  double *x = plane.x.data ();
+  double *y = plane.y.data ();
+  double *z = plane.z.data ();
+  for (size_t i = 0; i < n; i ++)
+    {
+      // angle addition instead of trigonometry per satellite
+      double c = cosProgress * co[i] - sinProgress * so[i];
+      double s = sinProgress * co[i] + cosProgress * so[i];
+      x[i] = c * ux + s * vx;
+      y[i] = c * uy + s * vy;
+      z[i] = c * uz;
+    }
+
+  plane.time = t;
+  plane.valid = true;
+}
+
+};
@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tim Schubert <ns-3-leo@timschubert.net>
+ */
+
+#ifndef LEO_CONSTELLATION_PROPAGATOR_H
+#define LEO_CONSTELLATION_PROPAGATOR_H
+
+#include <map>
+#include <tuple>
+#include <vector>
+#include <stdint.h>
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+
+/**
+ * \file
+ * \ingroup leo
+ *
+ * Declaration of LeoConstellationPropagator
+ */
+
+namespace ns3 {
+
+class LeoCircularOrbitMobilityModel;
+
+/**
+ * \ingroup leo
+ * \brief Computes the positions of all satellites of a constellation at once
+ *
+ * Satellites with the same altitude, inclination and longitude share an
+ * orbital plane and only differ by their offset inside the plane. The
+ * orientation of the plane and the progress along the orbit are computed once
+ * per plane, so that the positions of the satellites only need a few
+ * multiplications each. They are kept in struct-of-arrays buffers from which
+ * the attached mobility models read their position.
+ */
+class LeoConstellationPropagator : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /// constructor
+  LeoConstellationPropagator ();
+  /// destructor
+  virtual ~LeoConstellationPropagator ();
+
+  /**
+   * \brief Let the propagator compute the positions of a satellite
+   *
+   * The satellite is detached again if its orbit is changed.
+   *
+   * \param model mobility model of the satellite
+   * \return slot of the satellite
+   */
+  uint32_t Add (Ptr<LeoCircularOrbitMobilityModel> model);
+
+  /**
+   * \brief Reserve space for the satellites that are about to be added
+   * \param n total number of satellites
+   */
+  void Reserve (uint32_t n);
+
+  /**
+   * \brief Get the number of satellites
+   * \return number of satellites
+   */
+  uint32_t GetN (void) const;
+
+  /**
+   * \brief Get the number of orbital planes
+   * \return number of planes
+   */
+  uint32_t GetNPlanes (void) const;
+
+  /**
+   * \brief Compute the positions of all satellites
+   *
+   * The planes are independent of each other, so they may be split among
+   * multiple threads.
+   *
+   * \param t time
+   * \param threads number of threads
+   */
+  void Update (Time t, uint32_t threads = 1);
+
+  /**
+   * \brief Get the position of a satellite
+   *
+   * Computes the positions of all satellites of the same plane if they are
+   * not known for this time yet.
+   *
+   * \param slot slot of the satellite
+   * \param t time
+   * \return position
+   */
+  Vector GetPosition (uint32_t slot, Time t);
+
+private:
+  /// Satellites that share an orbital plane
+  struct Plane
+  {
+    /// Distance from the center of the earth in m
+    double radius;
+    /// Cosine of the inclination
+    double cosInclination;
+    /// Sine of the inclination
+    double sinInclination;
+    /// Longitudinal offset in rad
+    double longitude;
+    /// Progress along the orbit in rad/s, negative for retrograde orbits
+    double angularSpeed;
+    /// Cosine of the offsets of the satellites inside the plane
+    std::vector<double> cosOffset;
+    /// Sine of the offsets of the satellites inside the plane
+    std::vector<double> sinOffset;
+    /// First coordinate of the positions
+    std::vector<double> x;
+    /// Second coordinate of the positions
+    std::vector<double> y;
+    /// Third coordinate of the positions
+    std::vector<double> z;
+    /// Time of the positions
+    Time time;
+    /// Whether the positions have been computed
+    bool valid;
+  };
+
+  /**
+   * \brief Compute the positions of all satellites of a plane
+   * \param plane plane
+   * \param t time
+   */
+  static void Evaluate (Plane &plane, Time t);
+
+  /// Orbital planes
+  std::vector<Plane> m_planes;
+
+  /// Planes by altitude, inclination and longitude
+  std::map<std::tuple<double, double, double>, uint32_t> m_planeIndex;
+
+  /// Plane and index inside the plane by slot
+  std::vector<std::pair<uint32_t, uint32_t> > m_slots;
+};
+
+};
+
+#endif
@@ -0,0 +1,595 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tim Schubert <ns-3-leo@timschubert.net>
+ */
+
+#include <math.h>
+#include <algorithm>
+#include <fstream>
+#include <thread>
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/constant-position-mobility-model.h"
+
+#include "leo-circular-orbit-mobility-model.h"
+#include "leo-contact-plan.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LeoContactPlan");
+
+NS_OBJECT_ENSURE_REGISTERED (LeoContactPlan);
+
+namespace {
+
+/// Identifies contact plan files
+const uint32_t CONTACT_PLAN_MAGIC = 0x4c454f43;
+
+/// Version of the file format
+const uint32_t CONTACT_PLAN_VERSION = 1;
+
+/**
+ * \brief Add a value to a FNV-1a hash
+ * \param hash hash
+ * \param value value
+ */
+void
+Hash (uint64_t &hash, uint64_t value)
+{
+  for (size_t i = 0; i < sizeof (value); i ++)
+    {
+      hash ^= (value >> (i * 8)) & 0xff;
+      hash *= 0x100000001b3;
+    }
+}
+
+/**
+ * \brief Add a position rounded to mm to a hash
+ * \param hash hash
+ * \param pos position
+ */
+void
+Hash (uint64_t &hash, const Vector &pos)
+{
+  Hash (hash, (uint64_t) llround (pos.x * 1e3));
+  Hash (hash, (uint64_t) llround (pos.y * 1e3));
+  Hash (hash, (uint64_t) llround (pos.z * 1e3));
+}
+
+} // namespace
+
+TypeId
+LeoContactPlan::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LeoContactPlan")
+    .SetParent<Object> ()
+    .SetGroupName ("Leo")
+    .AddConstructor<LeoContactPlan> ()
+    .AddAttribute ("Interval",
+                   "Time between two samples of the positions",
+                   TimeValue (Seconds (1.0)),
+                   MakeTimeAccessor (&LeoContactPlan::m_interval),
+                   MakeTimeChecker ())
+    .AddAttribute ("Duration",
+                   "Time covered by the plan, starting when it is computed. "
+                   "Afterwards the channels check all devices again.",
+                   TimeValue (Hours (1.0)),
+                   MakeTimeAccessor (&LeoContactPlan::m_duration),
+                   MakeTimeChecker ())
+    .AddAttribute ("Threads",
+                   "Number of threads used to compute the plan, 0 for one per core",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&LeoContactPlan::m_threads),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("File",
+                   "File from which the plan is loaded if it matches the "
+                   "channel and to which it is saved otherwise. Empty to "
+                   "always compute the plan.",
+                   StringValue (""),
+                   MakeStringAccessor (&LeoContactPlan::m_file),
+                   MakeStringChecker ())
+  ;
+  return tid;
+}
+
+LeoContactPlan::LeoContactPlan ()
+  : m_interval (Seconds (1.0)),
+    m_duration (Hours (1.0)),
+    m_threads (0),
+    m_computed (false),
+    m_samples (0),
+    m_fingerprint (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LeoContactPlan::~LeoContactPlan ()
+{
+}
+
+void
+LeoContactPlan::Compute (const std::vector<Ptr<MobilityModel> > &mobility,
+                         const std::vector<uint32_t> &first,
+                         const std::vector<uint32_t> &second,
+                         VisibilityFunction visible,
+                         std::string parameters)
+{
+  NS_LOG_FUNCTION (this << first.size () << second.size () << parameters);
+  DoCompute (mobility, first, second, visible, BatchVisibilityFunction (), parameters);
+}
+
+void
+LeoContactPlan::Compute (const std::vector<Ptr<MobilityModel> > &mobility,
+                         const std::vector<uint32_t> &first,
+                         const std::vector<uint32_t> &second,
+                         BatchVisibilityFunction visible,
+                         std::string parameters)
+{
+  NS_LOG_FUNCTION (this << first.size () << second.size () << parameters);
+  DoCompute (mobility, first, second, VisibilityFunction (), visible, parameters);
+}
+
+void
+LeoContactPlan::DoCompute (const std::vector<Ptr<MobilityModel> > &mobility,
+                           const std::vector<uint32_t> &first,
+                           const std::vector<uint32_t> &second,
+                           const VisibilityFunction &visible,
+                           const BatchVisibilityFunction &batch,
+                           std::string parameters)
+{
+  NS_ASSERT_MSG (m_interval > Seconds (0), "Interval must be positive");
+
+  Clear ();
+
+  // align the samples to the interval
+  m_start = TimeStep (Simulator::Now ().GetTimeStep () - Simulator::Now ().GetTimeStep () % m_interval.GetTimeStep ());
+  m_samples = m_duration.GetTimeStep () / m_interval.GetTimeStep () + 1;
+
+  size_t n = mobility.size ();
+  std::vector<uint8_t> groups (n, 0);
+  for (uint32_t id : first)
+    {
+      groups[id] |= 1;
+    }
+  for (uint32_t id : second)
+    {
+      groups[id] |= 2;
+    }
+
+  m_orbits.assign (n, 0);
+  m_positions.assign (n, Vector ());
+  m_planned.assign (n, 0);
+  for (uint32_t id = 0; id < n; id ++)
+    {
+      if (groups[id] == 0)
+        {
+          continue;
+        }
+      Ptr<LeoCircularOrbitMobilityModel> orbit = DynamicCast<LeoCircularOrbitMobilityModel> (mobility[id]);
+      if (orbit != 0)
+        {
+          m_orbits[id] = PeekPointer (orbit);
+          m_planned[id] = 1;
+        }
+      else if (DynamicCast<ConstantPositionMobilityModel> (mobility[id]) != 0)
+        {
+          m_positions[id] = mobility[id]->GetPosition ();
+          m_planned[id] = 1;
+        }
+      else
+        {
+          m_unplanned.push_back (id);
+        }
+    }
+
+  m_fingerprint = GetFingerprint (first, second, parameters);
+  m_contacts.assign (n, std::vector<Contact> ());
+  m_maxDuration.assign (n, 0);
+
+  if (m_file != "" && Load (m_file))
+    {
+      NS_LOG_INFO ("loaded contact plan from " << m_file);
+      m_orbits.clear ();
+      m_computed = true;
+      return;
+    }
+
+  std::vector<uint32_t> columns;
+  for (uint32_t id : second)
+    {
+      if (m_planned[id])
+        {
+          columns.push_back (id);
+        }
+    }
+
+  // rows are interleaved, so that the threads get a similar share of the
+  // pairs if devices are in both groups
+  uint32_t threads = m_threads > 0 ? m_threads : std::max (1u, std::thread::hardware_concurrency ());
+  std::vector<std::vector<uint32_t> > rows (threads);
+  size_t nRows = 0;
+  for (uint32_t id : first)
+    {
+      if (m_planned[id])
+        {
+          rows[nRows ++ % threads].push_back (id);
+        }
+    }
+
+  NS_LOG_INFO ("computing contacts of " << nRows << "x" << columns.size () << " devices for " << m_samples << " samples on " << threads << " threads");
+
+  std::vector<std::vector<PairContact> > found (threads);
+  std::vector<std::thread> workers;
+  for (uint32_t i = 1; i < threads; i ++)
+    {
+      workers.push_back (std::thread (&LeoContactPlan::Sweep, this,
+                                      std::cref (rows[i]), std::cref (columns), std::cref (groups),
+                                      std::cref (visible), std::cref (batch), std::ref (found[i])));
+    }
+  Sweep (rows[0], columns, groups, visible, batch, found[0]);
+  for (std::thread &worker : workers)
+    {
+      worker.join ();
+    }
+
+  for (const std::vector<PairContact> &contacts : found)
+    {
+      for (const PairContact &c : contacts)
+        {
+          m_contacts[c.a].push_back ({ c.start, c.end, c.b });
+          m_contacts[c.b].push_back ({ c.start, c.end, c.a });
+        }
+    }
+  for (uint32_t id = 0; id < n; id ++)
+    {
+      std::sort (m_contacts[id].begin (), m_contacts[id].end (),
+                 [] (const Contact &l, const Contact &r) { return l.start < r.start || (l.start == r.start && l.peer < r.peer); });
+      for (const Contact &c : m_contacts[id])
+        {
+          m_maxDuration[id] = std::max (m_maxDuration[id], c.end - c.start);
+        }
+    }
+
+  m_orbits.clear ();
+  m_computed = true;
+
+  if (m_file != "" && !Save (m_file))
+    {
+      NS_LOG_WARN ("unable to save contact plan to " << m_file);
+    }
+}
+
+void
+LeoContactPlan::Sweep (const std::vector<uint32_t> &rows,
+                       const std::vector<uint32_t> &columns,
+                       const std::vector<uint8_t> &groups,
+                       const VisibilityFunction &visible,
+                       const BatchVisibilityFunction &batch,
+                       std::vector<PairContact> &contacts) const
+{
+  // first sample of the currently open contact of each pair, -1 if none
+  std::vector<int64_t> open (rows.size () * columns.size (), -1);
+  std::vector<Vector> rowPositions (rows.size ());
+  std::vector<Vector> columnPositions (columns.size ());
+  // coordinates of the columns and visibility of a row for the batch function
+  std::vector<double> x, y, z;
+  std::vector<uint64_t> mask;
+  if (batch)
+    {
+      x.resize (columns.size ());
+      y.resize (columns.size ());
+      z.resize (columns.size ());
+      mask.resize ((columns.size () + 63) / 64);
+    }
+
+  for (uint32_t sample = 0; sample < m_samples; sample ++)
+    {
+      for (size_t i = 0; i < rows.size (); i ++)
+        {
+          rowPositions[i] = GetPosition (rows[i], sample);
+        }
+      for (size_t j = 0; j < columns.size (); j ++)
+        {
+          columnPositions[j] = GetPosition (columns[j], sample);
+        }
+      if (batch)
+        {
+          for (size_t j = 0; j < columns.size (); j ++)
+            {
+              x[j] = columnPositions[j].x;
+              y[j] = columnPositions[j].y;
+              z[j] = columnPositions[j].z;
+            }
+        }
+
+      for (size_t i = 0; i < rows.size (); i ++)
+        {
+          uint32_t a = rows[i];
+          if (batch)
+            {
+              batch (a, rowPositions[i], x.data (), y.data (), z.data (), columns.size (), mask.data ());
+            }
+          for (size_t j = 0; j < columns.size (); j ++)
+            {
+              uint32_t b = columns[j];
+              // pairs of devices in both groups are only checked once
+              if (a == b || ((groups[a] & 2) && (groups[b] & 1) && b < a))
+                {
+                  continue;
+                }
+
+              int64_t &start = open[i * columns.size () + j];
+              bool isVisible = batch ? (mask[j / 64] >> (j % 64)) & 1
+                                     : visible (a, rowPositions[i], b, columnPositions[j]);
+              if (isVisible)
+                {
+                  if (start < 0)
+                    {
+                      start = sample;
+                    }
+                }
+              else if (start >= 0)
+                {
+                  contacts.push_back ({ a, b, (uint32_t) start, sample - 1 });
+                  start = -1;
+                }
+            }
+        }
+    }
+
+  for (size_t i = 0; i < rows.size (); i ++)
+    {
+      for (size_t j = 0; j < columns.size (); j ++)
+        {
+          int64_t start = open[i * columns.size () + j];
+          if (start >= 0)
+            {
+              contacts.push_back ({ rows[i], columns[j], (uint32_t) start, m_samples - 1 });
+            }
+        }
+    }
+}
+
+Vector
+LeoContactPlan::GetPosition (uint32_t id, uint32_t sample) const
+{
+  if (m_orbits[id] == 0)
+    {
+      return m_positions[id];
+    }
+  return m_orbits[id]->GetPositionAt (TimeStep (m_start.GetTimeStep () + sample * m_interval.GetTimeStep ()));
+}
+
+bool
+LeoContactPlan::IsComputed (void) const
+{
+  return m_computed;
+}
+
+void
+LeoContactPlan::Clear (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_computed = false;
+  m_samples = 0;
+  m_orbits.clear ();
+  m_positions.clear ();
+  m_planned.clear ();
+  m_unplanned.clear ();
+  m_contacts.clear ();
+  m_maxDuration.clear ();
+}
+
+bool
+LeoContactPlan::IsPlanned (uint32_t id) const
+{
+  return m_computed && id < m_planned.size () && m_planned[id];
+}
+
+const std::vector<uint32_t> &
+LeoContactPlan::GetUnplanned (void) const
+{
+  return m_unplanned;
+}
+
+bool
+LeoContactPlan::GetPeers (uint32_t id, Time t, std::vector<uint32_t> &peers) const
+{
+  NS_LOG_FUNCTION (this << id << t);
+
+  if (!IsPlanned (id) || t < m_start)
+    {
+      return false;
+    }
+
+  // t lies between the samples k and k + 1
+  uint64_t k = (t - m_start).GetTimeStep () / m_interval.GetTimeStep ();
+  if (k + 1 >= m_samples)
+    {
+      return false;
+    }
+
+  // contacts that end at or after sample k and start at or before sample k + 1
+  const std::vector<Contact> &contacts = m_contacts[id];
+  uint64_t first = k > m_maxDuration[id] ? k - m_maxDuration[id] : 0;
+  std::vector<Contact>::const_iterator it =
+    std::lower_bound (contacts.begin (), contacts.end (), first,
+                      [] (const Contact &c, uint64_t start) { return c.start < start; });
+  for (; it != contacts.end () && it->start <= k + 1; it ++)
+    {
+      if (it->end >= k)
+        {
+          peers.push_back (it->peer);
+        }
+    }
+
+  return true;
+}
+
+const std::vector<LeoContactPlan::Contact> &
+LeoContactPlan::GetContacts (uint32_t id) const
+{
+  NS_ASSERT_MSG (id < m_contacts.size (), "device is not part of the plan");
+  return m_contacts[id];
+}
+
+Time
+LeoContactPlan::GetStart (void) const
+{
+  return m_start;
+}
+
+Time
+LeoContactPlan::GetStop (void) const
+{
+  if (m_samples == 0)
+    {
+      return m_start;
+    }
+  return TimeStep (m_start.GetTimeStep () + (m_samples - 1) * m_interval.GetTimeStep ());
+}
+
+uint64_t
+LeoContactPlan::GetFingerprint (const std::vector<uint32_t> &first,
+                                const std::vector<uint32_t> &second,
+                                std::string parameters) const
+{
+  uint64_t hash = 0xcbf29ce484222325;
+  Hash (hash, m_start.GetTimeStep ());
+  Hash (hash, m_interval.GetTimeStep ());
+  Hash (hash, m_samples);
+  Hash (hash, m_planned.size ());
+  for (char c : parameters)
+    {
+      Hash (hash, (uint64_t) c);
+    }
+
+  // the orbits are fully determined by their first, middle and last position
+  for (const std::vector<uint32_t> *group : { &first, &second })
+    {
+      Hash (hash, group->size ());
+      for (uint32_t id : *group)
+        {
+          Hash (hash, id);
+          Hash (hash, m_planned[id]);
+          if (m_planned[id])
+            {
+              Hash (hash, GetPosition (id, 0));
+              Hash (hash, GetPosition (id, m_samples / 2));
+              Hash (hash, GetPosition (id, m_samples - 1));
+            }
+        }
+    }
+
+  return hash;
+}
+
+bool
+LeoContactPlan::Save (std::string path) const
+{
+  NS_LOG_FUNCTION (this << path);
+
+  std::ofstream out (path, std::ios::binary | std::ios::trunc);
+  if (!out)
+    {
+      return false;
+    }
+
+  // native byte order, the files are meant to be reused on the same machine
+  uint32_t n = m_contacts.size ();
+  out.write ((const char *) &CONTACT_PLAN_MAGIC, sizeof (CONTACT_PLAN_MAGIC));
+  out.write ((const char *) &CONTACT_PLAN_VERSION, sizeof (CONTACT_PLAN_VERSION));
+  out.write ((const char *) &m_fingerprint, sizeof (m_fingerprint));
+  out.write ((const char *) &n, sizeof (n));
+  for (const std::vector<Contact> &contacts : m_contacts)
+    {
+      uint32_t size = contacts.size ();
+      out.write ((const char *) &size, sizeof (size));
+      for (const Contact &c : contacts)
+        {
+          out.write ((const char *) &c.start, sizeof (c.start));
+          out.write ((const char *) &c.end, sizeof (c.end));
+          out.write ((const char *) &c.peer, sizeof (c.peer));
+        }
+    }
+
+  return out.good ();
+}
+
+bool
+LeoContactPlan::Load (std::string path)
+{
+  NS_LOG_FUNCTION (this << path);
+
+  std::ifstream in (path, std::ios::binary);
+  if (!in)
+    {
+      return false;
+    }
+
+  uint32_t magic = 0;
+  uint32_t version = 0;
+  uint64_t fingerprint = 0;
+  uint32_t n = 0;
+  in.read ((char *) &magic, sizeof (magic));
+  in.read ((char *) &version, sizeof (version));
+  in.read ((char *) &fingerprint, sizeof (fingerprint));
+  in.read ((char *) &n, sizeof (n));
+  if (!in || magic != CONTACT_PLAN_MAGIC || version != CONTACT_PLAN_VERSION)
+    {
+      NS_LOG_WARN ("ignoring invalid contact plan " << path);
+      return false;
+    }
+  if (fingerprint != m_fingerprint || n != m_contacts.size ())
+    {
+      NS_LOG_INFO ("contact plan " << path << " has been computed for other devices");
+      return false;
+    }
+
+  std::vector<std::vector<Contact> > contacts (n);
+  std::vector<uint32_t> maxDuration (n, 0);
+  for (uint32_t id = 0; id < n; id ++)
+    {
+      uint32_t size = 0;
+      in.read ((char *) &size, sizeof (size));
+      if (!in)
+        {
+          return false;
+        }
+      contacts[id].resize (size);
+      for (Contact &c : contacts[id])
+        {
+          in.read ((char *) &c.start, sizeof (c.start));
+          in.read ((char *) &c.end, sizeof (c.end));
+          in.read ((char *) &c.peer, sizeof (c.peer));
+          if (!in || c.peer >= n || c.end < c.start || c.end >= m_samples)
+            {
+              NS_LOG_WARN ("ignoring corrupt contact plan " << path);
+              return false;
+            }
+          maxDuration[id] = std::max (maxDuration[id], c.end - c.start);
+        }
+    }
+
+  m_contacts.swap (contacts);
+  m_maxDuration.swap (maxDuration);
+  return true;
+}
+
+};
@@ -0,0 +1,330 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tim Schubert <ns-3-leo@timschubert.net>
+ */
+
+#ifndef LEO_CONTACT_PLAN_H
+#define LEO_CONTACT_PLAN_H
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+#include "ns3/mobility-model.h"
+
+/**
+ * \file
+ * \ingroup leo
+ *
+ * Declaration of LeoContactPlan
+ */
+
+namespace ns3 {
+
+class LeoCircularOrbitMobilityModel;
+
+/**
+ * \ingroup leo
+ * \brief Precomputed contacts between the devices of a channel
+ *
+ * The positions of devices with a LeoCircularOrbitMobilityModel or a
+ * ConstantPositionMobilityModel are known in advance. The contact plan samples
+ * them once every Interval over the whole Duration, starting at the time it is
+ * computed, and stores the windows in which two devices can communicate as
+ * lists of contacts per device that are sorted by their start.
+ *
+ * The contacts of a device at a point in time are then found by binary search.
+ * Because of the sampling, a contact is reported from one interval before its
+ * first to one interval after its last sample, so the caller still has to
+ * check the link for the exact time. Contacts that are shorter than one
+ * interval may be missed.
+ *
+ * Devices with other mobility models are not planned and have to be checked
+ * for every transmission.
+ */
+class LeoContactPlan : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /// constructor
+  LeoContactPlan ();
+  /// destructor
+  virtual ~LeoContactPlan ();
+
+  /**
+   * \brief Decides if two devices can communicate
+   *
+   * Gets the ids of the devices and their positions. May be called from
+   * multiple threads at once, so it must not modify any state or use logging.
+   */
+  typedef std::function<bool (uint32_t, const Vector &, uint32_t, const Vector &)> VisibilityFunction;
+
+  /**
+   * \brief Decides which devices of the second group a device can
+   * communicate with
+   *
+   * Gets the id and the position of the device, the coordinates and the
+   * number of the positions of the second group and a mask in which the bit
+   * of every visible position is to be set. Has the same restrictions as a
+   * VisibilityFunction.
+   */
+  typedef std::function<void (uint32_t, const Vector &, const double *, const double *, const double *,
+                              size_t, uint64_t *)> BatchVisibilityFunction;
+
+  /// Time window in which a device can communicate with a peer
+  struct Contact
+  {
+    /// First sample at which the devices can communicate
+    uint32_t start;
+    /// Last sample at which the devices can communicate
+    uint32_t end;
+    /// Id of the peer
+    uint32_t peer;
+  };
+
+  /**
+   * \brief Compute the contacts between two groups of devices
+   *
+   * All pairs of a device from the first group and a device from the second
+   * group are checked. Devices may be in both groups, in which case each pair
+   * is only checked once. If the File attribute is set and the file contains
+   * a plan for the same devices and parameters, the plan is loaded from it
+   * instead. Otherwise the newly computed plan is written to the file.
+   *
+   * \param mobility mobility models of all devices by their id, may contain
+   * null pointers
+   * \param first ids of the devices in the first group
+   * \param second ids of the devices in the second group
+   * \param visible decides if two devices can communicate
+   * \param parameters description of everything that visible depends on
+   * besides the positions, used to check if a saved plan can be reused
+   */
+  void Compute (const std::vector<Ptr<MobilityModel> > &mobility,
+                const std::vector<uint32_t> &first,
+                const std::vector<uint32_t> &second,
+                VisibilityFunction visible,
+                std::string parameters);
+
+  /**
+   * \brief Compute the contacts between two groups of devices
+   *
+   * Same as above, but checks a device against all devices of the second
+   * group at once.
+   *
+   * \param mobility mobility models of all devices by their id, may contain
+   * null pointers
+   * \param first ids of the devices in the first group
+   * \param second ids of the devices in the second group
+   * \param visible decides which devices of the second group a device can
+   * communicate with
+   * \param parameters description of everything that visible depends on
+   * besides the positions, used to check if a saved plan can be reused
+   */
+  void Compute (const std::vector<Ptr<MobilityModel> > &mobility,
+                const std::vector<uint32_t> &first,
+                const std::vector<uint32_t> &second,
+                BatchVisibilityFunction visible,
+                std::string parameters);
+
+  /**
+   * \brief Check if the plan has been computed
+   * \return true iff the plan has been computed or loaded
+   */
+  bool IsComputed (void) const;
+
+  /**
+   * \brief Forget all contacts, e.g. because devices have been attached
+   */
+  void Clear (void);
+
+  /**
+   * \brief Check if the contacts of a device are known
+   * \param id id of the device
+   * \return true iff the device is planned
+   */
+  bool IsPlanned (uint32_t id) const;
+
+  /**
+   * \brief Get the devices for which no contacts are known
+   * \return ids of the devices
+   */
+  const std::vector<uint32_t> &GetUnplanned (void) const;
+
+  /**
+   * \brief Get all peers a device may be able to communicate with
+   * \param id id of the device
+   * \param t point in time
+   * \param [out] peers ids of the peers are appended to this vector
+   * \return false if the device is not planned or t is outside of the plan
+   */
+  bool GetPeers (uint32_t id, Time t, std::vector<uint32_t> &peers) const;
+
+  /**
+   * \brief Get all contacts of a device
+   * \param id id of the device
+   * \return contacts sorted by their start
+   */
+  const std::vector<Contact> &GetContacts (uint32_t id) const;
+
+  /**
+   * \brief Get the time of the first sample
+   * \return time
+   */
+  Time GetStart (void) const;
+
+  /**
+   * \brief Get the time of the last sample
+   * \return time
+   */
+  Time GetStop (void) const;
+
+private:
+  /// Contact between two devices found by the sweep
+  struct PairContact
+  {
+    /// Id of the first device
+    uint32_t a;
+    /// Id of the second device
+    uint32_t b;
+    /// First sample at which the devices can communicate
+    uint32_t start;
+    /// Last sample at which the devices can communicate
+    uint32_t end;
+  };
+
+  /**
+   * \brief Compute the contacts with either of the visibility functions
+   * \param mobility mobility models of all devices by their id
+   * \param first ids of the devices in the first group
+   * \param second ids of the devices in the second group
+   * \param visible decides if two devices can communicate, used if batch is
+   * empty
+   * \param batch decides which devices a device can communicate with
+   * \param parameters parameters of the visibility function
+   */
+  void DoCompute (const std::vector<Ptr<MobilityModel> > &mobility,
+                  const std::vector<uint32_t> &first,
+                  const std::vector<uint32_t> &second,
+                  const VisibilityFunction &visible,
+                  const BatchVisibilityFunction &batch,
+                  std::string parameters);
+
+  /**
+   * \brief Sweep over all samples for a subset of the first group
+   * \param rows ids of the devices of the first group to check
+   * \param columns ids of the devices of the second group
+   * \param groups groups of the devices by their id, bit 0 is set for the
+   * first and bit 1 for the second group
+   * \param visible decides if two devices can communicate, used if batch is
+   * empty
+   * \param batch decides which devices a device can communicate with
+   * \param [out] contacts found contacts
+   */
+  void Sweep (const std::vector<uint32_t> &rows,
+              const std::vector<uint32_t> &columns,
+              const std::vector<uint8_t> &groups,
+              const VisibilityFunction &visible,
+              const BatchVisibilityFunction &batch,
+              std::vector<PairContact> &contacts) const;
+
+  /**
+   * \brief Get the position of a planned device
+   * \param id id of the device
+   * \param sample number of the sample
+   * \return position
+   */
+  Vector GetPosition (uint32_t id, uint32_t sample) const;
+
+  /**
+   * \brief Compute a hash over everything the contacts depend on
+   * \param first ids of the devices in the first group
+   * \param second ids of the devices in the second group
+   * \param parameters parameters of the visibility function
+   * \return hash
+   */
+  uint64_t GetFingerprint (const std::vector<uint32_t> &first,
+                           const std::vector<uint32_t> &second,
+                           std::string parameters) const;
+
+  /**
+   * \brief Write the contacts to a file
+   * \param path path of the file
+   * \return true on success
+   */
+  bool Save (std::string path) const;
+
+  /**
+   * \brief Read the contacts from a file
+   * \param path path of the file
+   * \return true iff the file contains a plan with the current fingerprint
+   */
+  bool Load (std::string path);
+
+  /// Time between two samples
+  Time m_interval;
+
+  /// Time covered by the plan
+  Time m_duration;
+
+  /// Number of threads used for the sweep, 0 for one per core
+  uint32_t m_threads;
+
+  /// File from which the plan is loaded and to which it is saved
+  std::string m_file;
+
+  /// Whether the plan has been computed
+  bool m_computed;
+
+  /// Time of the first sample
+  Time m_start;
+
+  /// Number of samples
+  uint32_t m_samples;
+
+  /// Hash over everything the contacts depend on
+  uint64_t m_fingerprint;
+
+  /// Orbits of the planned devices during the computation, null if a device does not move
+  std::vector<const LeoCircularOrbitMobilityModel *> m_orbits;
+
+  /// Positions of the devices that do not move
+  std::vector<Vector> m_positions;
+
+  /// Whether the contacts of a device are known
+  std::vector<uint8_t> m_planned;
+
+  /// Devices in any group without known contacts
+  std::vector<uint32_t> m_unplanned;
+
+  /// Contacts by device sorted by their start
+  std::vector<std::vector<Contact> > m_contacts;
+
+  /// Longest contact of a device in samples
+  std::vector<uint32_t> m_maxDuration;
+};
+
+};
+
+#endif
@@ -0,0 +1,200 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tim Schubert <ns-3-leo@timschubert.net>
+ */
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/uinteger.h"
+#include "ns3/trace-source-accessor.h"
+#include "leo-mock-channel.h"
+#include "leo-l2-relay.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LeoL2Relay");
+
+NS_OBJECT_ENSURE_REGISTERED (LeoL2RelayTag);
+
+TypeId
+LeoL2RelayTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LeoL2RelayTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Leo")
+    .AddConstructor<LeoL2RelayTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+LeoL2RelayTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+LeoL2RelayTag::LeoL2RelayTag ()
+  : m_source (0)
+{
+}
+
+LeoL2RelayTag::LeoL2RelayTag (uint32_t source)
+  : m_source (source)
+{
+}
+
+uint32_t
+LeoL2RelayTag::GetSource (void) const
+{
+  return m_source;
+}
+
+uint32_t
+LeoL2RelayTag::GetSerializedSize (void) const
+{
+  return 4;
+}
+
+void
+LeoL2RelayTag::Serialize (TagBuffer i) const
+{
+  i.WriteU32 (m_source);
+}
+
+void
+LeoL2RelayTag::Deserialize (TagBuffer i)
+{
+  m_source = i.ReadU32 ();
+}
+
+void
+LeoL2RelayTag::Print (std::ostream &os) const
+{
+  os << "source=" << m_source;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (LeoL2Relay);
+
+TypeId
+LeoL2Relay::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LeoL2Relay")
+    .SetParent<Object> ()
+    .SetGroupName ("Leo")
+    .AddConstructor<LeoL2Relay> ()
+    .AddTraceSource ("Relay",
+                     "A frame has been relayed",
+                     MakeTraceSourceAccessor (&LeoL2Relay::m_relayTrace),
+                     "ns3::Packet::TracedCallback")
+    .AddTraceSource ("RelayDrop",
+                     "A frame could not be relayed",
+                     MakeTraceSourceAccessor (&LeoL2Relay::m_relayDropTrace),
+                     "ns3::Packet::TracedCallback")
+  ;
+  return tid;
+}
+
+LeoL2Relay::LeoL2Relay ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LeoL2Relay::~LeoL2Relay ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+LeoL2Relay::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_ports.clear ();
+  Object::DoDispose ();
+}
+
+void
+LeoL2Relay::AddPort (Ptr<MockNetDevice> port)
+{
+  NS_LOG_FUNCTION (this << port);
+  NS_ASSERT_MSG (port->SupportsSendFrom (), "Device does not support SendFrom");
+  NS_ASSERT_MSG (port->GetNode () != 0, "Device is not installed on a node");
+
+  Ptr<LeoMockChannel> channel = DynamicCast<LeoMockChannel> (port->GetChannel ());
+  NS_ABORT_MSG_IF (channel == 0, "Relay port is not attached to a LeoMockChannel");
+  // the channel only sees the tag of a single frame, so that the frames of a
+  // burst would be sent back to their sources
+  UintegerValue burst;
+  port->GetAttribute ("MaxBurstPackets", burst);
+  NS_ABORT_MSG_IF (burst.Get () > 1, "Relay ports must not send bursts");
+  channel->AddRelay (port);
+
+  // promiscuous handlers see the frames for other hosts, but do not
+  // receive a second copy of the frames for the node itself
+  port->GetNode ()->RegisterProtocolHandler (MakeCallback (&LeoL2Relay::Receive, this),
+                                             0, port, true);
+  m_ports.push_back (port);
+}
+
+uint32_t
+LeoL2Relay::GetNPorts (void) const
+{
+  return m_ports.size ();
+}
+
+Ptr<MockNetDevice>
+LeoL2Relay::GetPort (uint32_t i) const
+{
+  return m_ports[i];
+}
+
+void
+LeoL2Relay::Receive (Ptr<NetDevice> device,
+                     Ptr<const Packet> packet,
+                     uint16_t protocol,
+                     const Address &source,
+                     const Address &destination,
+                     NetDevice::PacketType packetType)
+{
+  NS_LOG_FUNCTION (this << device << packet << protocol << source << destination << packetType);
+
+  if (packetType == NetDevice::PACKET_HOST)
+    {
+      return;
+    }
+
+  // the channel has chosen another satellite, or the frame is not between
+  // ground stations
+  LeoL2RelayTag tag;
+  if (!packet->PeekPacketTag (tag))
+    {
+      return;
+    }
+
+  // the tag is kept, so that the channel does not send the frame back to
+  // its source
+  if (device->SendFrom (packet->Copy (), source, destination, protocol))
+    {
+      NS_LOG_LOGIC ("relayed frame from " << source << " to " << destination);
+      m_relayTrace (packet);
+    }
+  else
+    {
+      NS_LOG_LOGIC ("failed to relay frame from " << source << " to " << destination);
+      m_relayDropTrace (packet);
+    }
+}
+
+} // namespace ns3
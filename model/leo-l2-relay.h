@@ -0,0 +1,166 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tim Schubert <ns-3-leo@timschubert.net>
+ */
+
+#ifndef LEO_L2_RELAY_H
+#define LEO_L2_RELAY_H
+
+#include <vector>
+
+#include "ns3/object.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/tag.h"
+#include "ns3/traced-callback.h"
+
+#include "mock-net-device.h"
+
+/**
+ * \file
+ * \ingroup leo
+ *
+ * Declaration of LeoL2Relay and LeoL2RelayTag
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup leo
+ * \brief Marks the copy of a frame that a satellite has to relay
+ *
+ * The LeoMockChannel adds the tag to the copy of the chosen relay port. The
+ * tag stays on the relayed frame, so that the channel does not send the
+ * frame back to its source.
+ */
+class LeoL2RelayTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  /// constructor
+  LeoL2RelayTag ();
+
+  /**
+   * constructor
+   *
+   * \param source channel id of the ground station that sent the frame
+   */
+  LeoL2RelayTag (uint32_t source);
+
+  /**
+   * \brief Get the source of the frame
+   * \return channel id of the ground station that sent the frame
+   */
+  uint32_t GetSource (void) const;
+
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+private:
+  /// Channel id of the source
+  uint32_t m_source;
+};
+
+/**
+ * \ingroup leo
+ * \brief Transparent layer 2 relay of a bent-pipe satellite
+ *
+ * Every frame that a port receives and that is not addressed to the port
+ * itself is sent out again on the same port with its original source and
+ * destination addresses. The frames do not pass the network layer of the
+ * satellite, so there is no routing, TTL handling or ARP on the satellite.
+ *
+ * The ports must be satellite devices of a LeoMockChannel, which only
+ * reach the ground stations, so that relayed frames are never relayed
+ * again. The channel chooses the port that relays a frame once for each
+ * transmission of a ground station and marks its copy with a LeoL2RelayTag,
+ * see LeoMockChannel::AddRelay. Frames without the tag are not relayed.
+ */
+class LeoL2Relay : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /// constructor
+  LeoL2Relay ();
+  /// destructor
+  virtual ~LeoL2Relay ();
+
+  /**
+   * \brief Relay the frames received by a device of the node
+   * \param port device, which must support SendFrom, must be attached to a
+   * LeoMockChannel and must not send bursts
+   */
+  void AddPort (Ptr<MockNetDevice> port);
+
+  /**
+   * \brief Get the number of ports
+   * \return number of ports
+   */
+  uint32_t GetNPorts (void) const;
+
+  /**
+   * \brief Get a port
+   * \param i index of the port
+   * \return the port
+   */
+  Ptr<MockNetDevice> GetPort (uint32_t i) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Relay a frame received by a port
+   * \param device receiving port
+   * \param packet payload of the frame
+   * \param protocol protocol number
+   * \param source source address of the frame
+   * \param destination destination address of the frame
+   * \param packetType type of the frame
+   */
+  void Receive (Ptr<NetDevice> device,
+                Ptr<const Packet> packet,
+                uint16_t protocol,
+                const Address &source,
+                const Address &destination,
+                NetDevice::PacketType packetType);
+
+  /// Ports of the relay
+  std::vector<Ptr<MockNetDevice> > m_ports;
+
+  /// Trace source for relayed frames
+  TracedCallback<Ptr<const Packet> > m_relayTrace;
+
+  /// Trace source for frames that could not be relayed
+  TracedCallback<Ptr<const Packet> > m_relayDropTrace;
+};
+
+} // namespace ns3
+
+#endif /* LEO_L2_RELAY_H */
@@ -16,13 +16,24 @@
  * Author: Tim Schubert <ns-3-leo@timschubert.net>
  */
 
+#include <algorithm>
+#include <sstream>
+
 #include "ns3/object.h"
 #include "ns3/ptr.h"
 #include "ns3/log.h"
 #include "ns3/enum.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+#include "ns3/abort.h"
+#include "ns3/mac48-address.h"
 
 #include "leo-mock-net-device.h"
 #include "leo-mock-channel.h"
+#include "leo-propagation-loss-model.h"
+#include "leo-l2-relay.h"
 
 namespace ns3 {
 
@@ -37,20 +48,53 @@ LeoMockChannel::GetTypeId (void)
     .SetParent<MockChannel> ()
     .SetGroupName ("Leo")
     .AddConstructor<LeoMockChannel> ()
+    .AddAttribute ("SpatialIndexInterval",
+                   "Time after which the cached positions of the devices and the spatial indices are updated",
+                   TimeValue (Seconds (1.0)),
+                   MakeTimeAccessor (&LeoMockChannel::m_indexInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("PreFilter",
+                   "Whether to only consider the devices whose cached position may be "
+                   "within the range of a LeoPropagationLossModel for a transmission",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&LeoMockChannel::m_preFilter),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SpatialIndexSafetyFactor",
+                   "Factor by which the distance the devices may have moved since the "
+                   "last update of the cached positions is enlarged",
+                   DoubleValue (1.5),
+                   MakeDoubleAccessor (&LeoMockChannel::m_safetyFactor),
+                   MakeDoubleChecker<double> (1.0))
   ;
   return tid;
 }
 
 LeoMockChannel::LeoMockChannel() :
-  MockChannel ()
+  MockChannel (),
+  m_indexInterval (Seconds (1.0)),
+  m_indexExpiry (Seconds (0)),
+  m_preFilter (false),
+  m_safetyFactor (1.5),
+  m_relay (-1),
+  m_relaySource (-1)
 {
   NS_LOG_FUNCTION_NOARGS ();
+  m_groundDevices.maxRadius = 0.0;
+  m_groundDevices.maxSpeed = 0.0;
+  m_satelliteDevices.maxRadius = 0.0;
+  m_satelliteDevices.maxSpeed = 0.0;
 }
 
 LeoMockChannel::~LeoMockChannel()
 {
 }
 
+Ptr<MockNetDevice>
+LeoMockChannel::GetMockDevice (uint32_t id) const
+{
+  return StaticCast<MockNetDevice> (GetDevice (id));
+}
+
 bool
 LeoMockChannel::TransmitStart (Ptr<const Packet> p,
                           uint32_t devId,
@@ -66,40 +110,110 @@ LeoMockChannel::TransmitStart (Ptr<const Packet> p,
       return false;
     }
 
-  Ptr<MockNetDevice> srcDev = StaticCast<MockNetDevice> (GetDevice (devId));
+  Ptr<MockNetDevice> srcDev = GetMockDevice (devId);
   if (srcDev == 0)
     {
       NS_LOG_ERROR ("Source device unknown");
       return false;
     }
 
-  bool fromGround = m_groundDevices.find (srcDev->GetAddress ()) != m_groundDevices.end ();
-  bool fromSpace = m_satelliteDevices.find (srcDev->GetAddress ()) != m_satelliteDevices.end ();
-
-  NS_ASSERT_MSG (!(fromGround && fromSpace), "Source device can not be both on ground and in space");
-
-  DeviceIndex *dests;
-  if (fromGround)
+  DeviceTable *dests;
+  bool fromGround;
+  switch (m_deviceSides[devId])
     {
+    case GROUND:
       NS_LOG_LOGIC ("ground to space: " << srcDev->GetAddress () << " to " << dst);
       dests = &m_satelliteDevices;
-    }
-  else if (fromSpace)
-    {
+      fromGround = true;
+      break;
+    case SPACE:
       NS_LOG_LOGIC ("space to ground: " << srcDev->GetAddress () << " to " << dst);
       dests = &m_groundDevices;
-    }
-  else
-    {
+      fromGround = false;
+      break;
+    default:
       NS_LOG_ERROR ("unable to find source interface " << srcDev);
       return false;
     }
 
+  // the relay port of a frame from the ground is chosen once for all
+  // receivers, and relayed frames are not sent back to their source
+  m_relay = -1;
+  m_relaySource = -1;
+  m_relayPacket = 0;
+  if (!m_relays.empty ())
+    {
+      LeoL2RelayTag tag;
+      if (fromGround)
+        {
+          m_relay = ChooseRelay (srcDev, dst);
+          if (m_relay >= 0)
+            {
+              Ptr<Packet> copy = p->Copy ();
+              copy->AddPacketTag (LeoL2RelayTag (devId));
+              m_relayPacket = copy;
+            }
+        }
+      else if (p->PeekPacketTag (tag))
+        {
+          m_relaySource = tag.GetSource ();
+          Ptr<Packet> copy = p->Copy ();
+          copy->RemovePacketTag (tag);
+          p = copy;
+        }
+    }
+
+  m_candidates.clear ();
+  if (GetPlannedReceivers (devId, m_candidates))
+    {
+      uint8_t side = fromGround ? SPACE : GROUND;
+      NS_LOG_LOGIC ("considering " << m_candidates.size () << " of " << dests->ids.size () << " devices from contact plan");
+
+      // make sure to return false if packet has been delivered to *no* device
+      bool result = false;
+      uint64_t considered = 0;
+      for (uint32_t id : m_candidates)
+        {
+          if (m_deviceSides[id] != side)
+            {
+              continue;
+            }
+          considered ++;
+          if (DeliverTo (p, srcDev, id, txTime))
+            {
+              result = true;
+            }
+        }
+      NotifyFiltered (fromGround ? MockChannel::SATELLITE : MockChannel::GROUND,
+                      dests->ids.size () - considered);
+      return result;
+    }
+
+  // Only the LeoPropagationLossModel tells us the range of the source
+  Ptr<MobilityModel> srcMob = srcDev->GetNode ()->GetObject<MobilityModel> ();
+  Ptr<LeoPropagationLossModel> loss = DynamicCast<LeoPropagationLossModel> (GetPropagationLoss ());
+  if (m_preFilter && srcMob != 0 && loss != 0)
+    {
+      UpdateIndex ();
+
+      Vector pos = srcMob->GetPosition ();
+      double range = loss->GetCutoffDistance (fromGround ?
+                                              m_satelliteDevices.maxRadius :
+                                              pos.GetLength ());
+      if (range >= 0)
+        {
+          // the cached positions may be outdated by up to one update interval
+          double margin = m_safetyFactor * dests->maxSpeed * m_indexInterval.GetSeconds ();
+          return DeliverInRange (p, srcDev, pos, *dests, fromGround ? MockChannel::SATELLITE : MockChannel::GROUND,
+                                 range + margin, txTime);
+        }
+    }
+
   // make sure to return false if packet has been delivered to *no* device
   bool result = false;
-  for (DeviceIndex::iterator it = dests->begin (); it != dests->end(); it ++)
+  for (uint32_t id : dests->ids)
     {
-      if (Deliver (p, srcDev, it->second, txTime))
+      if (DeliverTo (p, srcDev, id, txTime))
       	{
       	  result = true;
       	}
@@ -112,30 +226,386 @@ LeoMockChannel::Attach (Ptr<MockNetDevice> device)
 {
   Ptr<LeoMockNetDevice> leodev = StaticCast<LeoMockNetDevice> (device);
 
+  int32_t id = MockChannel::Attach (device);
+  m_deviceSides.resize (id + 1, NONE);
+
   // Add to index
   switch (leodev->GetDeviceType ())
     {
     case LeoMockNetDevice::DeviceType::GND:
-      m_groundDevices[leodev->GetAddress ()] = leodev;
+      m_groundDevices.ids.push_back (id);
+      m_deviceSides[id] = GROUND;
       break;
     case LeoMockNetDevice::DeviceType::SAT:
-      m_satelliteDevices[leodev->GetAddress ()] = leodev;
+      m_satelliteDevices.ids.push_back (id);
+      m_deviceSides[id] = SPACE;
       break;
     default:
       break;
     }
 
-  return MockChannel::Attach (device);
+  // new device has to be indexed
+  m_indexExpiry = Seconds (0);
+
+  return id;
 }
 
 bool
 LeoMockChannel::Detach (uint32_t deviceId)
 {
-  Ptr<NetDevice> dev = GetDevice (deviceId);
-  m_groundDevices.erase (dev->GetAddress ());
-  m_satelliteDevices.erase (dev->GetAddress ());
+  if (deviceId < m_deviceSides.size ())
+    {
+      DeviceTable *table = 0;
+      switch (m_deviceSides[deviceId])
+        {
+        case GROUND:
+          table = &m_groundDevices;
+          break;
+        case SPACE:
+          table = &m_satelliteDevices;
+          break;
+        default:
+          break;
+        }
+      if (table != 0)
+        {
+          table->ids.erase (std::find (table->ids.begin (), table->ids.end (), deviceId));
+        }
+      if (deviceId < m_isRelay.size () && m_isRelay[deviceId])
+        {
+          m_relays.erase (std::find (m_relays.begin (), m_relays.end (), deviceId));
+          m_isRelay[deviceId] = 0;
+          m_relayMobility[deviceId] = 0;
+        }
+      m_deviceSides[deviceId] = NONE;
+      m_indexExpiry = Seconds (0);
+    }
 
   return MockChannel::Detach (deviceId);
 }
 
+void
+LeoMockChannel::Reserve (std::size_t n)
+{
+  MockChannel::Reserve (n);
+  m_deviceSides.reserve (n);
+}
+
+void
+LeoMockChannel::SetSpatialIndex (Ptr<LeoSpatialIndex> satellites, Ptr<LeoSpatialIndex> ground)
+{
+  NS_LOG_FUNCTION (this << satellites << ground);
+  m_satelliteDevices.index = satellites;
+  m_groundDevices.index = ground;
+  m_preFilter = true;
+  m_indexExpiry = Seconds (0);
+}
+
+void
+LeoMockChannel::AddRelay (Ptr<MockNetDevice> port)
+{
+  NS_LOG_FUNCTION (this << port);
+  int32_t id = GetDeviceId (port->GetAddress ());
+  NS_ABORT_MSG_IF (id < 0 || m_deviceSides[id] != SPACE, "Relay port is not a satellite device of the channel");
+
+  m_isRelay.resize (GetNDevices (), 0);
+  m_relayMobility.resize (GetNDevices ());
+  if (m_isRelay[id])
+    {
+      return;
+    }
+  m_isRelay[id] = 1;
+  m_relayMobility[id] = port->GetNode ()->GetObject<MobilityModel> ();
+  m_relays.insert (std::lower_bound (m_relays.begin (), m_relays.end (), (uint32_t) id), id);
+}
+
+void
+LeoMockChannel::DoComputeContactPlan (Ptr<LeoContactPlan> plan)
+{
+  NS_LOG_FUNCTION (this << plan);
+
+  Ptr<LeoPropagationLossModel> loss = DynamicCast<LeoPropagationLossModel> (GetPropagationLoss ());
+  if (loss == 0)
+    {
+      NS_LOG_WARN ("contact plan requires a LeoPropagationLossModel");
+      return;
+    }
+
+  std::vector<Ptr<MobilityModel> > mobility = GetMobilityModels ();
+
+  // the range only depends on the distance of the satellite from the center of
+  // the earth, which does not change on a circular orbit
+  std::vector<double> range (mobility.size (), -1.0);
+  for (uint32_t id : m_satelliteDevices.ids)
+    {
+      if (mobility[id] != 0)
+        {
+          range[id] = loss->GetCutoffDistance (mobility[id]->GetPosition ().GetLength ());
+        }
+    }
+
+  DoubleValue angle;
+  loss->GetAttribute ("ElevationAngle", angle);
+  std::ostringstream parameters;
+  parameters << GetInstanceTypeId ().GetName () << " " << angle.Get ();
+
+  plan->Compute (mobility, m_groundDevices.ids, m_satelliteDevices.ids,
+                 [range] (uint32_t gnd, const Vector &gndPos, uint32_t sat, const Vector &satPos)
+                 {
+                   return CalculateDistance (gndPos, satPos) <= range[sat];
+                 },
+                 parameters.str ());
+}
+
+void
+LeoMockChannel::UpdatePositions (DeviceTable &table)
+{
+  NS_LOG_FUNCTION (this);
+
+  // remember the previous positions to measure how far the devices moved
+  m_lastPositions.resize (GetNDevices ());
+  m_hasLastPosition.assign (GetNDevices (), 0);
+  for (size_t i = 0; i < table.positioned.size (); i ++)
+    {
+      m_lastPositions[table.positioned[i]] = Vector (table.x[i], table.y[i], table.z[i]);
+      m_hasLastPosition[table.positioned[i]] = 1;
+    }
+  Time elapsed = Simulator::Now () - table.updated;
+  table.updated = Simulator::Now ();
+
+  table.positioned.clear ();
+  table.x.clear ();
+  table.y.clear ();
+  table.z.clear ();
+  table.unpositioned.clear ();
+  table.maxRadius = 0.0;
+
+  double maxDistance = 0.0;
+  for (uint32_t id : table.ids)
+    {
+      Ptr<MobilityModel> mob = GetMockDevice (id)->GetNode ()->GetObject<MobilityModel> ();
+      if (mob == 0)
+        {
+          table.unpositioned.push_back (id);
+          continue;
+        }
+
+      Vector pos = mob->GetPosition ();
+      table.maxRadius = std::max (table.maxRadius, pos.GetLength ());
+      table.maxSpeed = std::max (table.maxSpeed, mob->GetVelocity ().GetLength ());
+      if (m_hasLastPosition[id])
+        {
+          maxDistance = std::max (maxDistance, CalculateDistance (pos, m_lastPositions[id]));
+        }
+      table.positioned.push_back (id);
+      table.x.push_back (pos.x);
+      table.y.push_back (pos.y);
+      table.z.push_back (pos.z);
+    }
+  if (elapsed.IsStrictlyPositive ())
+    {
+      table.maxSpeed = std::max (table.maxSpeed, maxDistance / elapsed.GetSeconds ());
+    }
+  NS_LOG_LOGIC ("largest speed " << table.maxSpeed);
+
+  if (table.index != 0)
+    {
+      std::vector<Vector> positions;
+      positions.reserve (table.positioned.size ());
+      for (size_t i = 0; i < table.positioned.size (); i ++)
+        {
+          positions.push_back (Vector (table.x[i], table.y[i], table.z[i]));
+        }
+      table.index->Build (positions);
+    }
+}
+
+void
+LeoMockChannel::UpdateIndex (void)
+{
+  if (Simulator::Now () >= m_indexExpiry)
+    {
+      UpdatePositions (m_satelliteDevices);
+      UpdatePositions (m_groundDevices);
+      m_indexExpiry = Simulator::Now () + m_indexInterval;
+    }
+}
+
+int32_t
+LeoMockChannel::ChooseRelay (Ptr<MockNetDevice> src, const Address &dst)
+{
+  NS_LOG_FUNCTION (this << src << dst);
+
+  // frames for all ground stations are relayed by the satellite above the source
+  Ptr<MockNetDevice> to = src;
+  if (!Mac48Address::ConvertFrom (dst).IsGroup ())
+    {
+      int32_t id = GetDeviceId (dst);
+      if (id < 0 || m_deviceSides[id] != GROUND)
+        {
+          NS_LOG_LOGIC ("frame to " << dst << " is not for a ground station");
+          return -1;
+        }
+      to = GetMockDevice (id);
+    }
+
+  Ptr<MobilityModel> srcMob = src->GetNode ()->GetObject<MobilityModel> ();
+  Ptr<MobilityModel> toMob = to->GetNode ()->GetObject<MobilityModel> ();
+  if (srcMob == 0 || toMob == 0)
+    {
+      // every relay port is reached
+      return m_relays.front ();
+    }
+  Vector gnd = toMob->GetPosition ();
+
+  // only the relay ports near the destination may be visible from it
+  Ptr<LeoPropagationLossModel> leoLoss = DynamicCast<LeoPropagationLossModel> (GetPropagationLoss ());
+  double range = -1.0;
+  if (m_preFilter && leoLoss != 0 && m_satelliteDevices.index != 0)
+    {
+      UpdateIndex ();
+      range = leoLoss->GetCutoffDistance (m_satelliteDevices.maxRadius);
+    }
+  if (range >= 0)
+    {
+      double margin = m_safetyFactor * m_satelliteDevices.maxSpeed * m_indexInterval.GetSeconds ();
+      m_relayCandidates.clear ();
+      m_satelliteDevices.index->Query (gnd, range + margin, m_relayCandidates);
+      size_t n = 0;
+      for (uint32_t i : m_relayCandidates)
+        {
+          uint32_t id = m_satelliteDevices.positioned[i];
+          if (id < m_isRelay.size () && m_isRelay[id])
+            {
+              m_relayCandidates[n ++] = id;
+            }
+        }
+      m_relayCandidates.resize (n);
+      for (uint32_t id : m_satelliteDevices.unpositioned)
+        {
+          if (id < m_isRelay.size () && m_isRelay[id])
+            {
+              m_relayCandidates.push_back (id);
+            }
+        }
+      std::sort (m_relayCandidates.begin (), m_relayCandidates.end ());
+    }
+  else
+    {
+      m_relayCandidates = m_relays;
+    }
+
+  m_relayElevations.clear ();
+  for (uint32_t id : m_relayCandidates)
+    {
+      // sine of the elevation, which is at least -1 for any position
+      double elevation = -2.0;
+      Ptr<MobilityModel> satMob = m_relayMobility[id];
+      if (satMob != 0)
+        {
+          Vector dir = satMob->GetPosition () - gnd;
+          double length = gnd.GetLength () * dir.GetLength ();
+          if (length > 0)
+            {
+              elevation = (gnd.x * dir.x + gnd.y * dir.y + gnd.z * dir.z) / length;
+            }
+        }
+      m_relayElevations.push_back (std::make_pair (elevation, id));
+    }
+  // the first of the relay ports with the same elevation is preferred
+  std::stable_sort (m_relayElevations.begin (), m_relayElevations.end (),
+                    [] (const std::pair<double, uint32_t> &a, const std::pair<double, uint32_t> &b)
+                    {
+                      return a.first > b.first;
+                    });
+
+  // usually, the highest relay port is visible, so that the propagation loss
+  // model is only asked for few of them
+  Ptr<PropagationLossModel> loss = GetPropagationLoss ();
+  for (const std::pair<double, uint32_t> &entry : m_relayElevations)
+    {
+      uint32_t id = entry.second;
+      Ptr<MobilityModel> satMob = m_relayMobility[id];
+      // same check as in MockChannel::Deliver
+      if (satMob != 0 && loss != 0
+          && (loss->CalcRxPower (src->GetTxPower (), srcMob, satMob) < -900.0
+              || loss->CalcRxPower (GetMockDevice (id)->GetTxPower (), satMob, toMob) < -900.0))
+        {
+          continue;
+        }
+      NS_LOG_LOGIC ("frame to " << dst << " is relayed by device " << id);
+      return id;
+    }
+
+  NS_LOG_LOGIC ("no relay port is visible for the frame to " << dst);
+  return -1;
+}
+
+bool
+LeoMockChannel::DeliverTo (Ptr<const Packet> p, Ptr<MockNetDevice> src, uint32_t id, Time txTime)
+{
+  if ((int32_t) id == m_relaySource)
+    {
+      NotifyFiltered (MockChannel::GROUND, 1);
+      return false;
+    }
+  if ((int32_t) id == m_relay)
+    {
+      return Deliver (m_relayPacket, src, GetMockDevice (id), txTime);
+    }
+  return Deliver (p, src, GetMockDevice (id), txTime);
+}
+
+bool
+LeoMockChannel::DeliverInRange (Ptr<const Packet> p,
+                                Ptr<MockNetDevice> src,
+                                const Vector &pos,
+                                const DeviceTable &table,
+                                ReceiverType type,
+                                double radius,
+                                Time txTime)
+{
+  NS_LOG_FUNCTION (this << p << src << pos << radius << txTime);
+
+  m_candidates.clear ();
+  if (table.index != 0)
+    {
+      table.index->Query (pos, radius, m_candidates);
+      for (uint32_t &candidate : m_candidates)
+        {
+          candidate = table.positioned[candidate];
+        }
+    }
+  else
+    {
+      double radius2 = radius * radius;
+      size_t n = table.positioned.size ();
+      for (size_t i = 0; i < n; i ++)
+        {
+          double dx = table.x[i] - pos.x;
+          double dy = table.y[i] - pos.y;
+          double dz = table.z[i] - pos.z;
+          if (dx*dx + dy*dy + dz*dz <= radius2)
+            {
+              m_candidates.push_back (table.positioned[i]);
+            }
+        }
+    }
+  m_candidates.insert (m_candidates.end (), table.unpositioned.begin (), table.unpositioned.end ());
+
+  NS_LOG_LOGIC ("considering " << m_candidates.size () << " of " << table.ids.size () << " devices");
+  NotifyFiltered (type, table.ids.size () - m_candidates.size ());
+
+  // make sure to return false if packet has been delivered to *no* device
+  bool result = false;
+  for (uint32_t id : m_candidates)
+    {
+      if (DeliverTo (p, src, id, txTime))
+        {
+          result = true;
+        }
+    }
+  return result;
+}
+
 }; // namespace ns3
@@ -33,6 +33,7 @@
 #include "ns3/propagation-delay-model.h"
 #include "ns3/propagation-loss-model.h"
 #include "mock-channel.h"
+#include "leo-spatial-index.h"
 
 /**
  * \file
@@ -75,21 +76,211 @@ public:
 
   virtual int32_t Attach (Ptr<MockNetDevice> device);
   virtual bool Detach (uint32_t deviceId);
+  virtual void Reserve (std::size_t n);
+
+  /**
+   * \brief Use spatial indices to preselect the receivers of a transmission
+   *
+   * Enables PreFilter, so that only devices that may be inside the range of
+   * the transmitter are passed on to the propagation loss model. This requires
+   * the propagation loss model to be a LeoPropagationLossModel, otherwise all
+   * devices on the opposing side are considered. Without spatial indices, the
+   * cached positions of all devices on the opposing side are checked.
+   *
+   * \param satellites index over the positions of the satellite devices
+   * \param ground index over the positions of the ground devices
+   */
+  void SetSpatialIndex (Ptr<LeoSpatialIndex> satellites, Ptr<LeoSpatialIndex> ground);
+
+  /**
+   * \brief Let a satellite device relay frames between ground stations
+   *
+   * For each frame that a ground station sends to another ground station or
+   * to a group, one of the relay ports is chosen and its copy of the frame is
+   * marked with a LeoL2RelayTag. Among the relay ports that are visible from
+   * both ground stations, this is the one with the highest elevation above
+   * the destination, or above the source for broadcast and multicast frames.
+   * Relay ports without a mobility model are only chosen if no other port is
+   * visible. With spatial indices, only the relay ports near the destination
+   * are considered.
+   *
+   * A frame with the tag that is sent by a satellite is not delivered to the
+   * ground station that has sent it first.
+   *
+   * \param port satellite device of the channel
+   */
+  void AddRelay (Ptr<MockNetDevice> port);
+
+protected:
+  /**
+   * \brief Compute the contacts between ground and satellite devices
+   *
+   * Requires the propagation loss model to be a LeoPropagationLossModel.
+   *
+   * \param plan contact plan
+   */
+  virtual void DoComputeContactPlan (Ptr<LeoContactPlan> plan);
 
 private:
   /**
-   * \brief Ground and satellite devices
+   * \brief Ground or satellite devices
    *
    * This channel does not allow for communication between devices of the same
-   * type (no sat-sat or ground-ground).
+   * type (no sat-sat or ground-ground). The positions of the devices are
+   * cached in struct-of-arrays layout, so that selecting the receivers of a
+   * transmission only streams through contiguous memory.
    */
-  typedef std::map<Address, Ptr<MockNetDevice> > DeviceIndex;
+  struct DeviceTable
+  {
+    /// Channel ids of all devices
+    std::vector<uint32_t> ids;
+    /// Channel ids of the devices with a cached position
+    std::vector<uint32_t> positioned;
+    /// First coordinate of the cached positions
+    std::vector<double> x;
+    /// Second coordinate of the cached positions
+    std::vector<double> y;
+    /// Third coordinate of the cached positions
+    std::vector<double> z;
+    /// Channel ids of the devices without position, always considered for delivery
+    std::vector<uint32_t> unpositioned;
+    /// Optional index over the cached positions
+    Ptr<LeoSpatialIndex> index;
+    /// Largest distance of a device from the center of the earth
+    double maxRadius;
+    /// Largest speed of a device, reported or measured, since the first update
+    double maxSpeed;
+    /// Time of the last update
+    Time updated;
+  };
+
+  /// Side of the channel a device is on
+  enum DeviceSide
+  {
+    NONE,
+    GROUND,
+    SPACE
+  };
 
   /// Devices that are on the ground (gateways)
-  DeviceIndex m_groundDevices;
+  DeviceTable m_groundDevices;
 
   /// Devices that are in space (satellites)
-  DeviceIndex m_satelliteDevices;
+  DeviceTable m_satelliteDevices;
+
+  /// Sides of the devices by their channel id
+  std::vector<uint8_t> m_deviceSides;
+
+  /// Time between updates of the cached positions and spatial indices
+  Time m_indexInterval;
+
+  /// Time at which the cached positions have to be updated
+  Time m_indexExpiry;
+
+  /// Whether receivers are preselected by their cached positions
+  bool m_preFilter;
+
+  /// Factor by which the distance the devices may have moved is enlarged
+  double m_safetyFactor;
+
+  /// Cached positions of the last update by channel id
+  std::vector<Vector> m_lastPositions;
+
+  /// Whether a device had a cached position at the last update by channel id
+  std::vector<uint8_t> m_hasLastPosition;
+
+  /// Buffer for the receivers of a transmission
+  std::vector<uint32_t> m_candidates;
+
+  /// Channel ids of the relay ports in ascending order
+  std::vector<uint32_t> m_relays;
+
+  /// Whether a device is a relay port by channel id
+  std::vector<uint8_t> m_isRelay;
+
+  /// Mobility models of the relay ports by channel id
+  std::vector<Ptr<MobilityModel> > m_relayMobility;
+
+  /// Relay port chosen for the current transmission, or -1
+  int32_t m_relay;
+
+  /// Copy of the current frame for the chosen relay port
+  Ptr<const Packet> m_relayPacket;
+
+  /// Ground station that has sent the current relayed frame first, or -1
+  int32_t m_relaySource;
+
+  /// Buffer for the relay ports that may be chosen
+  std::vector<uint32_t> m_relayCandidates;
+
+  /// Buffer for the sines of the elevation of the relay ports and their ids
+  std::vector<std::pair<double, uint32_t> > m_relayElevations;
+
+  /**
+   * \brief Get a device by its channel id
+   * \param id channel id
+   * \return device
+   */
+  Ptr<MockNetDevice> GetMockDevice (uint32_t id) const;
+
+  /**
+   * \brief Update the cached positions and spatial index of a side of the
+   * channel
+   *
+   * The speed of the devices is measured by the distance they moved since the
+   * last update, since the velocity reported by the mobility model may be
+   * lower than the actual speed.
+   *
+   * \param table devices on that side of the channel
+   */
+  void UpdatePositions (DeviceTable &table);
+
+  /**
+   * \brief Update the cached positions and spatial indices of both sides,
+   * if they have expired
+   */
+  void UpdateIndex (void);
+
+  /**
+   * \brief Choose the relay port of a frame from a ground station
+   * \param src source device
+   * \param dst destination address
+   * \return channel id of the relay port, or -1 if the frame is not relayed
+   */
+  int32_t ChooseRelay (Ptr<MockNetDevice> src, const Address &dst);
+
+  /**
+   * \brief Deliver a packet to a device, or its copy for the relay port
+   *
+   * The source of a relayed frame is skipped.
+   *
+   * \param p packet
+   * \param src source device
+   * \param id channel id of the destination device
+   * \param txTime transmission time
+   * \return true if the packet has been delivered
+   */
+  bool DeliverTo (Ptr<const Packet> p, Ptr<MockNetDevice> src, uint32_t id, Time txTime);
+
+  /**
+   * \brief Deliver a packet to all devices of a table that may be within
+   * range of the source
+   * \param p packet
+   * \param src source device
+   * \param pos position of the source device
+   * \param table potential destinations
+   * \param type type of the devices of the table, for the delivery counters
+   * \param radius range of the source
+   * \param txTime transmission time
+   * \return true if the packet has been delivered to any device
+   */
+  bool DeliverInRange (Ptr<const Packet> p,
+                       Ptr<MockNetDevice> src,
+                       const Vector &pos,
+                       const DeviceTable &table,
+                       ReceiverType type,
+                       double radius,
+                       Time txTime);
 }; // class MockChannel
 
 } // namespace ns3
@@ -17,10 +17,12 @@
  */
 
 #include <math.h>
+#include <algorithm>
 
 #include "ns3/log.h"
 #include "ns3/mobility-model.h"
 #include "ns3/double.h"
+#include "ns3/uinteger.h"
 
 #include "leo-propagation-loss-model.h"
 
@@ -58,6 +60,17 @@ LeoPropagationLossModel::GetTypeId (void)
                    DoubleValue (0.0),
                    MakeDoubleAccessor (&LeoPropagationLossModel::m_linkMargin),
                    MakeDoubleChecker<double> ())
+    .AddAttribute ("CutoffCacheSize",
+                   "Number of cutoff distances by satellite radius to remember, 0 disables the cache",
+                   UintegerValue (64),
+                   MakeUintegerAccessor (&LeoPropagationLossModel::SetCutoffCacheSize,
+                                         &LeoPropagationLossModel::GetCutoffCacheSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("CutoffCacheResolution",
+                   "Resolution of the satellite radius in the cutoff distance cache in m",
+                   DoubleValue (1e-3),
+                   MakeDoubleAccessor (&LeoPropagationLossModel::m_cutoffResolution),
+                   MakeDoubleChecker<double> (1e-9))
   ;
   return tid;
 }
@@ -74,21 +87,60 @@ void
 LeoPropagationLossModel::SetElevationAngle (double angle)
 {
   m_elevationAngle = angle * (M_PI/180.0);
+  m_tanElevation = tan (m_elevationAngle);
+  m_secElevation2 = 1 + m_tanElevation * m_tanElevation;
+  SetCutoffCacheSize (m_cutoffCache.size ());
+}
+
+void
+LeoPropagationLossModel::SetCutoffCacheSize (uint32_t size)
+{
+  CutoffEntry unused = { -1, 0.0 };
+  m_cutoffCache.assign (size, unused);
+}
+
+uint32_t
+LeoPropagationLossModel::GetCutoffCacheSize (void) const
+{
+  return m_cutoffCache.size ();
+}
+
+double
+LeoPropagationLossModel::GetCachedCutoffDistance (double radius) const
+{
+  if (m_cutoffCache.empty ())
+    {
+      return GetCutoffDistance (radius);
+    }
+
+  int64_t key = llround (radius / m_cutoffResolution);
+  CutoffEntry &entry = m_cutoffCache[(uint64_t) key % m_cutoffCache.size ()];
+  if (entry.radius != key)
+    {
+      // computed for the quantized radius, so that the result does not depend
+      // on the order of the lookups
+      entry.radius = key;
+      entry.distance = GetCutoffDistance (key * m_cutoffResolution);
+    }
+  return entry.distance;
 }
 
 double
 LeoPropagationLossModel::GetCutoffDistance (const Ptr<MobilityModel> sat) const
 {
-  double angle = m_elevationAngle;
-  double hs = sat->GetPosition ().GetLength ();
+  return GetCutoffDistance (sat->GetPosition ().GetLength ());
+}
 
-  double a = 1 + tan (angle) * tan (angle);
-  double b = 2.0 * tan (angle) * hs;
+double
+LeoPropagationLossModel::GetCutoffDistance (double hs) const
+{
+  double a = m_secElevation2;
+  double b = 2.0 * m_tanElevation * hs;
   double c = hs*hs - LEO_PROP_EARTH_RAD*LEO_PROP_EARTH_RAD;
 
   double disc = b*b + 4*a*c;
 
-  NS_LOG_DEBUG ("angle="<<angle<<" hs="<<hs<<" a="<<a<<" b="<<b<<" c="<<c<<" disc="<<disc);
+  NS_LOG_DEBUG ("angle="<<m_elevationAngle<<" hs="<<hs<<" a="<<a<<" b="<<b<<" c="<<c<<" disc="<<disc);
 
   if (disc < 0)
     {
@@ -99,10 +151,10 @@ LeoPropagationLossModel::GetCutoffDistance (const Ptr<MobilityModel> sat) const
   double t1 = (-b - sqrt (disc)) / (2.0 * a);
   double t2 = (-b + sqrt (disc)) / (2.0 * a);
 
-  double num1 = Vector2D (t1, - tan (angle) * t1).GetLength ();
-  double num2 = Vector2D (t2, - tan (angle) * t2).GetLength ();
+  // |(t, -tan(angle) t)| = |t| sqrt(1 + tan^2(angle))
+  double secant = sqrt (a);
 
-  return fmin (num1, num2);
+  return fmin (fabs (t1), fabs (t2)) * secant;
 }
 
 double
@@ -116,12 +168,15 @@ LeoPropagationLossModel::DoCalcRxPower (double txPowerDbm,
                                         Ptr<MobilityModel> a,
                                         Ptr<MobilityModel> b) const
 {
-  Ptr<MobilityModel> sat = a->GetPosition ().GetLength () > b->GetPosition ().GetLength () ? a : b;
-  double distance = a->GetDistanceFrom (b);
-  double cutOff = GetCutoffDistance (sat);
+  // resolve each position once
+  Vector posA = a->GetPosition ();
+  Vector posB = b->GetPosition ();
+  double radius = std::max (posA.GetLength (), posB.GetLength ());
+  double distance = CalculateDistance (posA, posB);
+  double cutOff = GetCachedCutoffDistance (radius);
   if (distance > cutOff)
     {
-      NS_LOG_DEBUG ("LEO DROP distance: a=" << a->GetPosition () << " b=" << b->GetPosition ()<<" dist=" << distance<<" cutoff="<<cutOff);
+      NS_LOG_DEBUG ("LEO DROP distance: a=" << posA << " b=" << posB <<" dist=" << distance<<" cutoff="<<cutOff);
 
       return -1000.0;
     }
@@ -130,7 +185,7 @@ LeoPropagationLossModel::DoCalcRxPower (double txPowerDbm,
   // receiver loss and gain added at net device
   // P_{RX} = P_{TX} + G_{TX} - L_{TX} - L_{FS} - L_M + G_{RX} - L_{RX}
   double rxc = txPowerDbm - m_atmosphericLoss - m_freeSpacePathLoss - m_linkMargin;
-  NS_LOG_DEBUG ("LEO TRANSMIT distance: a=" << a->GetPosition () << " b=" << b->GetPosition ()<<" dist=" << distance <<" cutoff="<<cutOff<< "rxc=" << rxc);
+  NS_LOG_DEBUG ("LEO TRANSMIT distance: a=" << posA << " b=" << posB <<" dist=" << distance <<" cutoff="<<cutOff<< "rxc=" << rxc);
 
   return rxc;
 }
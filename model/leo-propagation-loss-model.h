@@ -19,6 +19,8 @@
 #ifndef LEO_PROPAGATION_LOSS_MODEL_H
 #define LEO_PROPAGATION_LOSS_MODEL_H
 
+#include <vector>
+
 #include <ns3/object.h>
 #include <ns3/propagation-loss-model.h>
 
@@ -51,6 +53,17 @@ public:
   /// destructor
   virtual ~LeoPropagationLossModel ();
 
+  /**
+   * \brief Get the maximum communication distance for a satellite
+   *
+   * The distance grows with the distance of the satellite from the center of
+   * the earth.
+   *
+   * \param radius distance of the satellite from the center of the earth
+   * \return distance, or a negative value if there is none
+   */
+  double GetCutoffDistance (double radius) const;
+
 private:
 
   /**
@@ -58,6 +71,35 @@ private:
    */
   double m_elevationAngle;
 
+  /**
+   * Tangent of the elevation angle
+   */
+  double m_tanElevation;
+
+  /**
+   * One plus the square of the tangent of the elevation angle
+   */
+  double m_secElevation2;
+
+  /// Cached cutoff distance of a quantized radius
+  struct CutoffEntry
+  {
+    /// Quantized radius, negative if the entry is unused
+    int64_t radius;
+    /// Cutoff distance
+    double distance;
+  };
+
+  /**
+   * Radius resolution of the cutoff distance cache in m
+   */
+  double m_cutoffResolution;
+
+  /**
+   * Cutoff distances by quantized radius, direct-mapped
+   */
+  mutable std::vector<CutoffEntry> m_cutoffCache;
+
   /**
    * Atmospheric loss
    */
@@ -104,6 +146,29 @@ private:
    * \return distance
    */
   double GetCutoffDistance (const Ptr<MobilityModel> sat) const;
+
+  /**
+   * \brief Get the maximum communication distance from the cache
+   *
+   * Circular orbits keep their radius, so there are only a few different
+   * distances that have to be computed.
+   *
+   * \param radius distance of the satellite from the center of the earth
+   * \return distance, or a negative value if there is none
+   */
+  double GetCachedCutoffDistance (double radius) const;
+
+  /**
+   * \brief Set the number of entries of the cutoff distance cache
+   * \param size number of entries, 0 to disable the cache
+   */
+  void SetCutoffCacheSize (uint32_t size);
+
+  /**
+   * \brief Get the number of entries of the cutoff distance cache
+   * \return number of entries
+   */
+  uint32_t GetCutoffCacheSize (void) const;
 };
 
 }
@@ -0,0 +1,213 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tim Schubert <ns-3-leo@timschubert.net>
+ */
+
+#include <math.h>
+#include <algorithm>
+
+#include "ns3/log.h"
+#include "ns3/double.h"
+
+#include "leo-spatial-index.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LeoSpatialIndex");
+
+NS_OBJECT_ENSURE_REGISTERED (LeoSpatialIndex);
+
+TypeId
+LeoSpatialIndex::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LeoSpatialIndex")
+    .SetParent<Object> ()
+    .SetGroupName ("Leo")
+  ;
+  return tid;
+}
+
+LeoSpatialIndex::~LeoSpatialIndex ()
+{
+}
+
+NS_OBJECT_ENSURE_REGISTERED (LeoGridSpatialIndex);
+
+TypeId
+LeoGridSpatialIndex::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LeoGridSpatialIndex")
+    .SetParent<LeoSpatialIndex> ()
+    .SetGroupName ("Leo")
+    .AddConstructor<LeoGridSpatialIndex> ()
+    .AddAttribute ("CellSize",
+                   "Edge length of the grid cells in m",
+                   DoubleValue (1.0e6),
+                   MakeDoubleAccessor (&LeoGridSpatialIndex::m_cellSize),
+                   MakeDoubleChecker<double> (1.0))
+  ;
+  return tid;
+}
+
+LeoGridSpatialIndex::LeoGridSpatialIndex ()
+  : m_cellSize (1.0e6)
+{
+  NS_LOG_FUNCTION (this);
+  for (size_t i = 0; i < 3; i ++)
+    {
+      m_min[i] = 0;
+      m_max[i] = -1;
+    }
+}
+
+LeoGridSpatialIndex::~LeoGridSpatialIndex ()
+{
+}
+
+int64_t
+LeoGridSpatialIndex::GetCell (double coordinate) const
+{
+  return (int64_t) floor (coordinate / m_cellSize);
+}
+
+std::size_t
+LeoGridSpatialIndex::CellHash::operator() (const Cell &cell) const
+{
+  // large primes spread neighbouring cells over the buckets
+  return (uint64_t) cell.x * 73856093 ^ (uint64_t) cell.y * 19349663 ^ (uint64_t) cell.z * 83492791;
+}
+
+void
+LeoGridSpatialIndex::Build (const std::vector<Vector> &positions)
+{
+  NS_LOG_FUNCTION (this << positions.size ());
+
+  // keep the allocated cell vectors around, most of them will be reused
+  for (CellMap::iterator it = m_cells.begin (); it != m_cells.end (); it ++)
+    {
+      it->second.clear ();
+    }
+  m_positions = positions;
+
+  for (uint32_t i = 0; i < m_positions.size (); i ++)
+    {
+      const Vector &pos = m_positions[i];
+      int64_t cell[3] = { GetCell (pos.x), GetCell (pos.y), GetCell (pos.z) };
+      for (size_t j = 0; j < 3; j ++)
+        {
+          if (i == 0 || cell[j] < m_min[j])
+            {
+              m_min[j] = cell[j];
+            }
+          if (i == 0 || cell[j] > m_max[j])
+            {
+              m_max[j] = cell[j];
+            }
+        }
+      m_cells[Cell { cell[0], cell[1], cell[2] }].push_back (i);
+    }
+}
+
+void
+LeoGridSpatialIndex::Query (const Vector &center, double radius, std::vector<uint32_t> &result) const
+{
+  NS_LOG_FUNCTION (this << center << radius);
+
+  if (m_positions.empty () || radius < 0)
+    {
+      return;
+    }
+
+  int64_t lower[3] = {
+    std::max (GetCell (center.x - radius), m_min[0]),
+    std::max (GetCell (center.y - radius), m_min[1]),
+    std::max (GetCell (center.z - radius), m_min[2])
+  };
+  int64_t upper[3] = {
+    std::min (GetCell (center.x + radius), m_max[0]),
+    std::min (GetCell (center.y + radius), m_max[1]),
+    std::min (GetCell (center.z + radius), m_max[2])
+  };
+
+  double radius2 = radius * radius;
+  double boxCells = 1.0;
+  for (size_t j = 0; j < 3; j ++)
+    {
+      if (upper[j] < lower[j])
+        {
+          return;
+        }
+      boxCells *= upper[j] - lower[j] + 1;
+    }
+
+  // with small cells, the box may cover many more cells than are occupied
+  if (boxCells > m_cells.size ())
+    {
+      for (CellMap::const_iterator it = m_cells.begin (); it != m_cells.end (); it ++)
+        {
+          const Cell &cell = it->first;
+          if (cell.x >= lower[0] && cell.x <= upper[0]
+              && cell.y >= lower[1] && cell.y <= upper[1]
+              && cell.z >= lower[2] && cell.z <= upper[2])
+            {
+              QueryCell (it->second, center, radius2, result);
+            }
+        }
+      return;
+    }
+
+  for (int64_t x = lower[0]; x <= upper[0]; x ++)
+    {
+      for (int64_t y = lower[1]; y <= upper[1]; y ++)
+        {
+          for (int64_t z = lower[2]; z <= upper[2]; z ++)
+            {
+              CellMap::const_iterator cell = m_cells.find (Cell { x, y, z });
+              if (cell != m_cells.end ())
+                {
+                  QueryCell (cell->second, center, radius2, result);
+                }
+            }
+        }
+    }
+}
+
+void
+LeoGridSpatialIndex::QueryCell (const std::vector<uint32_t> &ids,
+                                const Vector &center,
+                                double radius2,
+                                std::vector<uint32_t> &result) const
+{
+  for (uint32_t id : ids)
+    {
+      const Vector &pos = m_positions[id];
+      double dx = pos.x - center.x;
+      double dy = pos.y - center.y;
+      double dz = pos.z - center.z;
+      if (dx*dx + dy*dy + dz*dz <= radius2)
+        {
+          result.push_back (id);
+        }
+    }
+}
+
+uint32_t
+LeoGridSpatialIndex::GetN (void) const
+{
+  return m_positions.size ();
+}
+
+};
@@ -0,0 +1,180 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tim Schubert <ns-3-leo@timschubert.net>
+ */
+
+#ifndef LEO_SPATIAL_INDEX_H
+#define LEO_SPATIAL_INDEX_H
+
+#include <vector>
+#include <unordered_map>
+#include <stdint.h>
+
+#include "ns3/object.h"
+#include "ns3/vector.h"
+
+/**
+ * \file
+ * \ingroup leo
+ *
+ * Declaration of LeoSpatialIndex and LeoGridSpatialIndex
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup leo
+ * \brief Index over a set of positions for range queries
+ *
+ * Used by the channels to preselect the receivers that may be in range of
+ * a transmitter, so that the propagation loss model only has to be evaluated
+ * for those.
+ */
+class LeoSpatialIndex : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /// destructor
+  virtual ~LeoSpatialIndex ();
+
+  /**
+   * \brief Replace the indexed positions
+   *
+   * \param positions positions to index, the index of a position inside the
+   * vector is used as its identifier
+   */
+  virtual void Build (const std::vector<Vector> &positions) = 0;
+
+  /**
+   * \brief Find all positions inside a sphere
+   *
+   * \param center center of the sphere
+   * \param radius radius of the sphere
+   * \param [out] result identifiers of the positions inside the sphere are
+   * appended to this vector
+   */
+  virtual void Query (const Vector &center, double radius, std::vector<uint32_t> &result) const = 0;
+
+  /**
+   * \brief Get the number of indexed positions
+   * \return number of positions
+   */
+  virtual uint32_t GetN (void) const = 0;
+};
+
+/**
+ * \ingroup leo
+ * \brief Spatial index that sorts the positions into a uniform grid of cubic
+ * cells in earth-centered coordinates
+ */
+class LeoGridSpatialIndex : public LeoSpatialIndex
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /// constructor
+  LeoGridSpatialIndex ();
+  /// destructor
+  virtual ~LeoGridSpatialIndex ();
+
+  virtual void Build (const std::vector<Vector> &positions);
+  virtual void Query (const Vector &center, double radius, std::vector<uint32_t> &result) const;
+  virtual uint32_t GetN (void) const;
+
+private:
+  /// Coordinates of a cell, which identify it for any cell size
+  struct Cell
+  {
+    /// First cell coordinate
+    int64_t x;
+    /// Second cell coordinate
+    int64_t y;
+    /// Third cell coordinate
+    int64_t z;
+
+    /**
+     * \brief Compare two cells
+     * \param other other cell
+     * \return true iff the cells have the same coordinates
+     */
+    bool operator== (const Cell &other) const
+    {
+      return x == other.x && y == other.y && z == other.z;
+    }
+  };
+
+  /// Hash of the coordinates of a cell
+  struct CellHash
+  {
+    /**
+     * \brief Hash a cell
+     * \param cell cell
+     * \return hash
+     */
+    std::size_t operator() (const Cell &cell) const;
+  };
+
+  /// Cells mapped to the identifiers of the positions inside of them
+  typedef std::unordered_map<Cell, std::vector<uint32_t>, CellHash> CellMap;
+
+  /**
+   * \brief Get the cell coordinate of a coordinate
+   * \param coordinate coordinate in m
+   * \return cell coordinate
+   */
+  int64_t GetCell (double coordinate) const;
+
+  /**
+   * \brief Append the positions of a cell that are inside a sphere
+   * \param ids identifiers of the positions inside the cell
+   * \param center center of the sphere
+   * \param radius2 squared radius of the sphere
+   * \param [out] result identifiers of the positions inside the sphere are
+   * appended to this vector
+   */
+  void QueryCell (const std::vector<uint32_t> &ids,
+                  const Vector &center,
+                  double radius2,
+                  std::vector<uint32_t> &result) const;
+
+  /// Edge length of the cells in m
+  double m_cellSize;
+
+  /// Indexed positions
+  std::vector<Vector> m_positions;
+
+  /// Occupied cells
+  CellMap m_cells;
+
+  /// Lower corner of the bounding box of all occupied cells
+  int64_t m_min[3];
+
+  /// Upper corner of the bounding box of all occupied cells
+  int64_t m_max[3];
+};
+
+};
+
+#endif
@@ -0,0 +1,200 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tim Schubert <ns-3-leo@timschubert.net>
+ */
+
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+
+#include "leo-streaming-waypoint-mobility-model.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LeoStreamingWaypointMobilityModel");
+
+NS_OBJECT_ENSURE_REGISTERED (LeoStreamingWaypointMobilityModel);
+
+TypeId
+LeoStreamingWaypointMobilityModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::LeoStreamingWaypointMobilityModel")
+    .SetParent<MobilityModel> ()
+    .SetGroupName ("Leo")
+    .AddConstructor<LeoStreamingWaypointMobilityModel> ()
+    .AddAttribute ("WindowSize",
+                   "The maximum number of waypoints kept in memory",
+                   UintegerValue (16),
+                   MakeUintegerAccessor (&LeoStreamingWaypointMobilityModel::m_maxWindow),
+                   MakeUintegerChecker<uint32_t> (2))
+    .AddAttribute ("File",
+                   "The path to the waypoint file",
+                   StringValue (),
+                   MakeStringAccessor (&LeoStreamingWaypointMobilityModel::SetFile,
+                                       &LeoStreamingWaypointMobilityModel::GetFile),
+                   MakeStringChecker ())
+  ;
+  return tid;
+}
+
+LeoStreamingWaypointMobilityModel::LeoStreamingWaypointMobilityModel ()
+  : MobilityModel (),
+    m_stream (CreateObject<LeoWaypointInputFileStreamContainer> ()),
+    m_maxWindow (16),
+    m_end (true)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+LeoStreamingWaypointMobilityModel::~LeoStreamingWaypointMobilityModel ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+LeoStreamingWaypointMobilityModel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_stream = 0;
+  m_window.clear ();
+  m_end = true;
+  MobilityModel::DoDispose ();
+}
+
+void
+LeoStreamingWaypointMobilityModel::SetFile (const std::string path)
+{
+  NS_LOG_FUNCTION (this << path);
+  m_window.clear ();
+  m_end = path.empty ();
+  if (!m_end)
+    {
+      m_stream->SetFile (path);
+      m_stream->SetLastTime (Time (0));
+      m_stream->Suspend ();
+    }
+}
+
+std::string
+LeoStreamingWaypointMobilityModel::GetFile (void) const
+{
+  return m_stream->GetFile ();
+}
+
+uint32_t
+LeoStreamingWaypointMobilityModel::GetNWaypoints (void) const
+{
+  return m_window.size ();
+}
+
+void
+LeoStreamingWaypointMobilityModel::Fill (void) const
+{
+  Waypoint wp;
+  while (!m_end && m_window.size () < m_maxWindow)
+    {
+      if (m_stream->GetNextSample (wp))
+        {
+          m_window.push_back (wp);
+        }
+      else
+        {
+          NS_LOG_LOGIC ("read all waypoints of " << m_stream->GetFile ());
+          m_end = true;
+        }
+    }
+  // do not hold a file descriptor until the window has to be refilled
+  m_stream->Suspend ();
+}
+
+void
+LeoStreamingWaypointMobilityModel::Advance (Time t) const
+{
+  if (m_window.size () < 2)
+    {
+      Fill ();
+    }
+
+  bool changed = false;
+  while (m_window.size () >= 2 && m_window[1].time <= t)
+    {
+      m_window.pop_front ();
+      changed = true;
+      // refill in batches instead of reading one waypoint per step
+      if (m_window.size () < 2)
+        {
+          Fill ();
+        }
+    }
+
+  if (changed)
+    {
+      NotifyCourseChange ();
+    }
+}
+
+Vector
+LeoStreamingWaypointMobilityModel::DoGetPosition (void) const
+{
+  Time now = Simulator::Now ();
+  Advance (now);
+
+  if (m_window.empty ())
+    {
+      return Vector ();
+    }
+  const Waypoint &a = m_window[0];
+  if (m_window.size () < 2 || now <= a.time)
+    {
+      return a.position;
+    }
+  const Waypoint &b = m_window[1];
+  double f = (now - a.time).GetDouble () / (b.time - a.time).GetDouble ();
+  return Vector (a.position.x + f * (b.position.x - a.position.x),
+                 a.position.y + f * (b.position.y - a.position.y),
+                 a.position.z + f * (b.position.z - a.position.z));
+}
+
+void
+LeoStreamingWaypointMobilityModel::DoSetPosition (const Vector &position)
+{
+  NS_LOG_FUNCTION (this << position);
+  m_window.clear ();
+  m_window.push_back (Waypoint (Simulator::Now (), position));
+  m_end = true;
+  NotifyCourseChange ();
+}
+
+Vector
+LeoStreamingWaypointMobilityModel::DoGetVelocity (void) const
+{
+  Time now = Simulator::Now ();
+  Advance (now);
+
+  if (m_window.size () < 2 || now < m_window[0].time)
+    {
+      return Vector ();
+    }
+  const Waypoint &a = m_window[0];
+  const Waypoint &b = m_window[1];
+  double dt = (b.time - a.time).GetSeconds ();
+  return Vector ((b.position.x - a.position.x) / dt,
+                 (b.position.y - a.position.y) / dt,
+                 (b.position.z - a.position.z) / dt);
+}
+
+} // namespace ns3
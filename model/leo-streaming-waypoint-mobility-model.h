@@ -0,0 +1,137 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tim Schubert <ns-3-leo@timschubert.net>
+ */
+
+#ifndef LEO_STREAMING_WAYPOINT_MOBILITY_MODEL_H
+#define LEO_STREAMING_WAYPOINT_MOBILITY_MODEL_H
+
+#include <deque>
+#include <string>
+
+#include "ns3/vector.h"
+#include "ns3/object.h"
+#include "ns3/mobility-model.h"
+#include "ns3/nstime.h"
+#include "ns3/waypoint.h"
+#include "ns3/leo-input-fstream-container.h"
+
+/**
+ * \file
+ * \ingroup leo
+ *
+ * Declaration of LeoStreamingWaypointMobilityModel
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup leo
+ * \brief Interpolates the position between the waypoints of a file, which
+ * are read while the simulation advances
+ *
+ * Unlike WaypointMobilityModel, only a window of WindowSize waypoints is kept
+ * in memory. The window is refilled from a LeoWaypointInputFileStreamContainer
+ * once the time of its second waypoint has passed. Between two waypoints, the
+ * position is interpolated linearly. Before the first and after the last
+ * waypoint of the file, the node stays at the position of that waypoint.
+ *
+ * Text files are closed after each refill and opened again at the same
+ * offset for the next one, so that the number of models is not limited by
+ * the number of open file descriptors. Binary files of LeoWaypointBinaryFile
+ * are mapped and do not keep a descriptor either.
+ */
+class LeoStreamingWaypointMobilityModel : public MobilityModel
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /// constructor
+  LeoStreamingWaypointMobilityModel ();
+  /// destructor
+  virtual ~LeoStreamingWaypointMobilityModel ();
+
+  /**
+   * \brief Set the path to the waypoint file
+   * \param path path to the waypoint file
+   */
+  void SetFile (const std::string path);
+
+  /**
+   * \brief Get the path to the waypoint file
+   * \return path to the waypoint file
+   */
+  std::string GetFile (void) const;
+
+  /**
+   * \brief Get the number of waypoints in memory
+   * \return number of waypoints
+   */
+  uint32_t GetNWaypoints (void) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Read waypoints until the window is full or the file has ended
+   */
+  void Fill (void) const;
+
+  /**
+   * \brief Drop the waypoints that have been passed at time t
+   *
+   * Afterwards, the first waypoint of the window is the last one not later
+   * than t, if there is one.
+   *
+   * \param t time
+   */
+  void Advance (Time t) const;
+
+  /**
+   * \return the current position.
+   */
+  virtual Vector DoGetPosition (void) const;
+  /**
+   * \brief Stop following the waypoints and stay at a position
+   * \param position the position to set.
+   */
+  virtual void DoSetPosition (const Vector &position);
+  /**
+   * \return the current velocity.
+   */
+  virtual Vector DoGetVelocity (void) const;
+
+  /// Source of the waypoints
+  Ptr<LeoWaypointInputFileStreamContainer> m_stream;
+
+  /// Maximum number of waypoints in memory
+  uint32_t m_maxWindow;
+
+  /// Waypoints around the current time
+  mutable std::deque<Waypoint> m_window;
+
+  /// Whether all waypoints of the file have been read
+  mutable bool m_end;
+};
+
+} // namespace ns3
+
+#endif /* LEO_STREAMING_WAYPOINT_MOBILITY_MODEL_H */
@@ -0,0 +1,74 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tim Schubert <ns-3-leo@timschubert.net>
+ */
+
+#include "ns3/log.h"
+#include "mock-arp-table.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MockArpTable");
+
+NS_OBJECT_ENSURE_REGISTERED (MockArpTable);
+
+TypeId
+MockArpTable::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MockArpTable")
+    .SetParent<Object> ()
+    .SetGroupName ("Leo")
+    .AddConstructor<MockArpTable> ()
+  ;
+  return tid;
+}
+
+MockArpTable::MockArpTable ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MockArpTable::~MockArpTable ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MockArpTable::Add (Ipv4Address ipv4, Address mac)
+{
+  NS_LOG_FUNCTION (this << ipv4 << mac);
+  m_entries[ipv4.Get ()] = mac;
+}
+
+bool
+MockArpTable::Lookup (Ipv4Address ipv4, Address &mac) const
+{
+  std::unordered_map<uint32_t, Address>::const_iterator it = m_entries.find (ipv4.Get ());
+  if (it == m_entries.end ())
+    {
+      return false;
+    }
+  mac = it->second;
+  return true;
+}
+
+uint32_t
+MockArpTable::GetN (void) const
+{
+  return m_entries.size ();
+}
+
+} // namespace ns3
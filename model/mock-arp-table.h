@@ -0,0 +1,91 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tim Schubert <ns-3-leo@timschubert.net>
+ */
+
+#ifndef MOCK_ARP_TABLE_H
+#define MOCK_ARP_TABLE_H
+
+#include <unordered_map>
+#include <stdint.h>
+
+#include "ns3/object.h"
+#include "ns3/address.h"
+#include "ns3/ipv4-address.h"
+
+/**
+ * \file
+ * \ingroup leo
+ *
+ * Declaration of MockArpTable
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup leo
+ * \brief Hardware addresses of the neighbours of MockNetDevices
+ *
+ * A MockNetDevice with a table answers the ARP requests for the addresses
+ * in the table itself, instead of sending them over the channel. The
+ * entries of the ARP cache of the interface are only created for the
+ * addresses that are actually used, and they expire and are refreshed as
+ * usual. Requests for addresses that are not in the table are sent over
+ * the channel. One table may be shared by many devices.
+ */
+class MockArpTable : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /// constructor
+  MockArpTable ();
+  /// destructor
+  virtual ~MockArpTable ();
+
+  /**
+   * \brief Add a neighbour to the table
+   * \param ipv4 IPv4 address of the neighbour
+   * \param mac hardware address of the neighbour
+   */
+  void Add (Ipv4Address ipv4, Address mac);
+
+  /**
+   * \brief Look up the hardware address of a neighbour
+   * \param ipv4 IPv4 address of the neighbour
+   * \param mac set to the hardware address, if the neighbour is known
+   * \return whether the neighbour is known
+   */
+  bool Lookup (Ipv4Address ipv4, Address &mac) const;
+
+  /**
+   * \brief Get the number of neighbours
+   * \return number of entries
+   */
+  uint32_t GetN (void) const;
+
+private:
+  /// Hardware addresses by IPv4 address
+  std::unordered_map<uint32_t, Address> m_entries;
+};
+
+} // namespace ns3
+
+#endif /* MOCK_ARP_TABLE_H */
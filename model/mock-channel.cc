@@ -22,7 +22,11 @@
 #include <ns3/log.h>
 #include <ns3/pointer.h>
 #include <ns3/enum.h>
+#include <ns3/boolean.h>
+#include <ns3/uinteger.h>
+#include <ns3/mac48-address.h>
 #include "mock-channel.h"
+#include "leo-mock-net-device.h"
 
 namespace ns3 {
 
@@ -46,6 +50,64 @@ MockChannel::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&MockChannel::m_propagationLoss),
                    MakePointerChecker<PropagationLossModel> ())
+    .AddAttribute ("CopyOnWrite",
+                   "Deliver the same immutable packet to all receivers of a "
+                   "transmission instead of a copy for each of them. Only the "
+                   "receivers that pass the packet up make a copy.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&MockChannel::m_copyOnWrite),
+                   MakeBooleanChecker ())
+    .AddAttribute ("ContactPlan",
+                   "Precomputed contacts used to select the receivers of a transmission",
+                   PointerValue (),
+                   MakePointerAccessor (&MockChannel::SetContactPlan,
+                                        &MockChannel::GetContactPlan),
+                   MakePointerChecker<LeoContactPlan> ())
+    .AddAttribute ("LinkCacheSize",
+                   "Number of links whose received power and propagation delay are "
+                   "cached until the position of one of the devices changes. Only "
+                   "for deterministic propagation models. 0 disables the cache.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MockChannel::SetLinkCacheSize,
+                                         &MockChannel::GetLinkCacheSize),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("LinkCacheInterval",
+                   "Maximum time for which the state of a link is cached, for mobility "
+                   "models that do not notify all of their course changes",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&MockChannel::m_linkCacheInterval),
+                   MakeTimeChecker (TimeStep (1)))
+    .AddAttribute ("DeliveriesAttempted",
+                   "Number of receivers to which a delivery has been attempted",
+                   TypeId::ATTR_GET,
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MockChannel::GetDeliveriesAttempted),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("DeliveriesUnreachable",
+                   "Number of receivers that could not be reached by a transmission",
+                   TypeId::ATTR_GET,
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MockChannel::GetDeliveriesUnreachable),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddAttribute ("DeliveriesSucceeded",
+                   "Number of receivers to which a packet has been delivered",
+                   TypeId::ATTR_GET,
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MockChannel::GetDeliveriesSucceeded),
+                   MakeUintegerChecker<uint64_t> ())
+    .AddTraceSource ("DeliveryAttempt",
+                     "A delivery to a receiver has been attempted",
+                     MakeTraceSourceAccessor (&MockChannel::m_deliveryAttempt),
+                     "ns3::MockChannel::DeliveryAttemptCallback")
+    .AddTraceSource ("LinkCacheHits",
+                     "Number of transmissions that used a cached link state",
+                     MakeTraceSourceAccessor (&MockChannel::m_linkCacheHits),
+                     "ns3::TracedValueCallback::Uint64")
+    .AddTraceSource ("CopiesAvoided",
+                     "Number of packet copies that have been avoided by "
+                     "sharing packets between the receivers",
+                     MakeTraceSourceAccessor (&MockChannel::m_copiesAvoided),
+                     "ns3::TracedValueCallback::Uint64")
     .AddTraceSource ("TxRxMockChannel",
                      "Trace source indicating transmission of packet "
                      "from the MockChannel, used by the Animation "
@@ -59,15 +121,33 @@ MockChannel::GetTypeId (void)
 //
 // By default, you get a channel that
 // has an "infitely" fast transmission speed and zero processing delay.
-MockChannel::MockChannel() : Channel (), m_link (0)
+MockChannel::MockChannel() : Channel (), m_link (0), m_copyOnWrite (false), m_copiesAvoided (0), m_linkCacheHits (0)
 {
   NS_LOG_FUNCTION_NOARGS ();
+  ResetDeliveryCounters ();
 }
 
 MockChannel::~MockChannel()
 {
 }
 
+void
+MockChannel::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  for (uint32_t id = 0; id < m_epochSources.size (); id ++)
+    {
+      if (m_epochSources[id] != 0)
+        {
+          m_epochSources[id]->TraceDisconnectWithoutContext ("CourseChange",
+                                                             MakeBoundCallback (&MockChannel::CourseChanged, this, id));
+        }
+    }
+  m_epochSources.clear ();
+  m_linkCache.clear ();
+  Channel::DoDispose ();
+}
+
 bool
 MockChannel::Detach (uint32_t deviceId)
 {
@@ -81,6 +161,12 @@ MockChannel::Detach (uint32_t deviceId)
     	}
 
       m_link[deviceId]->NotifyLinkDown ();
+
+      uint64_t key;
+      if (GetAddressKey (m_link[deviceId]->GetAddress (), key))
+        {
+          m_addressIndex.erase (key);
+        }
     }
   else
     {
@@ -95,9 +181,30 @@ MockChannel::Attach (Ptr<MockNetDevice> device)
   NS_LOG_FUNCTION (this << device);
   NS_ASSERT (device != 0);
   m_link.push_back(device);
+
+  uint64_t key;
+  if (GetAddressKey (device->GetAddress (), key))
+    {
+      m_addressIndex[key] = m_link.size () - 1;
+    }
+
+  // the plan has to include the new device
+  if (m_contactPlan != 0)
+    {
+      m_contactPlan->Clear ();
+    }
+
   return  m_link.size() - 1;
 }
 
+void
+MockChannel::Reserve (std::size_t n)
+{
+  NS_LOG_FUNCTION (this << n);
+  m_link.reserve (n);
+  m_addressIndex.reserve (n);
+}
+
 std::size_t
 MockChannel::GetNDevices (void) const
 {
@@ -128,19 +235,52 @@ MockChannel::GetPropagationDelay (Ptr<MobilityModel> srcMob, Ptr<MobilityModel>
     }
 }
 
-// TODO optimize
+bool
+MockChannel::GetAddressKey (const Address &addr, uint64_t &key)
+{
+  if (!Mac48Address::IsMatchingType (addr))
+    {
+      return false;
+    }
+
+  uint8_t buffer[6];
+  Mac48Address::ConvertFrom (addr).CopyTo (buffer);
+  key = 0;
+  for (size_t i = 0; i < 6; i ++)
+    {
+      key = (key << 8) | buffer[i];
+    }
+  return true;
+}
+
+int32_t
+MockChannel::GetDeviceId (const Address &addr) const
+{
+  uint64_t key;
+  if (!GetAddressKey (addr, key))
+    {
+      return -1;
+    }
+
+  std::unordered_map<uint64_t, uint32_t>::const_iterator it = m_addressIndex.find (key);
+  if (it == m_addressIndex.end ())
+    {
+      return -1;
+    }
+
+  return it->second;
+}
+
 Ptr<MockNetDevice>
-MockChannel::GetDevice (Address &addr) const
+MockChannel::GetDevice (const Address &addr) const
 {
-  for (Ptr<MockNetDevice> dev : m_link)
+  int32_t id = GetDeviceId (addr);
+  if (id < 0)
     {
-      if (dev->GetAddress () == addr)
-    	{
-      	  return dev;
-    	}
+      return 0;
     }
 
-  return 0;
+  return m_link[id];
 }
 
 Ptr<PropagationDelayModel>
@@ -180,37 +320,304 @@ MockChannel::Deliver (
   if (srcMob != 0 && dstMob != 0)
     {
       Ptr<PropagationLossModel> pLoss = GetPropagationLoss ();
-      if (pLoss != 0)
+      Time propagation;
+      if (!m_linkCache.empty ())
+        {
+          GetLinkState (src, dst, srcMob, dstMob, txPower, txTime, rxPower, propagation);
+        }
+      else if (pLoss != 0)
     	{
-      	  // check if signal reaches destination
       	  rxPower = pLoss->CalcRxPower (txPower, srcMob, dstMob);
-      	  if (rxPower < -900.0)
-    	    {
-      	      NS_LOG_WARN (this << "unable to reach destination " << dst->GetNode ()->GetId () << " from " << src->GetNode ()->GetId ());
-      	      return false;
-    	    }
     	}
-      delay += GetPropagationDelay (srcMob, dstMob, txTime);
+      // check if signal reaches destination
+      if (rxPower < -900.0)
+        {
+          NS_LOG_LOGIC (this << " unable to reach destination " << dst->GetNode ()->GetId () << " from " << src->GetNode ()->GetId ());
+          NotifyDeliveryAttempt (src, dst, rxPower, false);
+          return false;
+        }
+      if (m_linkCache.empty ())
+        {
+          propagation = GetPropagationDelay (srcMob, dstMob, txTime);
+        }
+      delay += propagation;
       NS_LOG_DEBUG ("delay = "<<delay);
     }
 
+  Ptr<const Packet> packet = p;
+  if (m_copyOnWrite)
+    {
+      m_copiesAvoided ++;
+    }
+  else
+    {
+      packet = p->Copy ();
+    }
+
   Simulator::ScheduleWithContext (dst->GetNode ()->GetId (),
         			  delay,
         			  &MockNetDevice::Receive,
         			  dst,
-        			  p->Copy (),
+        			  packet,
         			  src,
         			  rxPower);
 
+  NotifyDeliveryAttempt (src, dst, rxPower, true);
+
   // Call the tx anim callback on the net device
   m_txrxMock (p, src, dst, txTime, delay);
   return true;
 }
 
+void
+MockChannel::NotifyDeliveryAttempt (Ptr<MockNetDevice> src, Ptr<MockNetDevice> dst, double rxPower, bool delivered)
+{
+  DeliveryCounters &counters = m_deliveries[GetReceiverType (dst)];
+  counters.attempted ++;
+  if (delivered)
+    {
+      counters.delivered ++;
+    }
+  else
+    {
+      counters.unreachable ++;
+    }
+  m_deliveryAttempt (src, dst, rxPower, delivered);
+}
+
+void
+MockChannel::NotifyFiltered (ReceiverType type, uint64_t n)
+{
+  DeliveryCounters &counters = m_deliveries[type];
+  counters.attempted += n;
+  counters.unreachable += n;
+  counters.filtered += n;
+}
+
+MockChannel::ReceiverType
+MockChannel::GetReceiverType (Ptr<MockNetDevice> dev)
+{
+  Ptr<LeoMockNetDevice> leoDev = DynamicCast<LeoMockNetDevice> (dev);
+  if (leoDev == 0)
+    {
+      return OTHER;
+    }
+  return leoDev->GetDeviceType () == LeoMockNetDevice::GND ? GROUND : SATELLITE;
+}
+
+MockChannel::DeliveryCounters
+MockChannel::GetDeliveryCounters (ReceiverType type) const
+{
+  return m_deliveries[type];
+}
+
+MockChannel::DeliveryCounters
+MockChannel::GetDeliveryCounters (void) const
+{
+  DeliveryCounters total = { 0, 0, 0, 0 };
+  for (const DeliveryCounters &counters : m_deliveries)
+    {
+      total.attempted += counters.attempted;
+      total.unreachable += counters.unreachable;
+      total.delivered += counters.delivered;
+      total.filtered += counters.filtered;
+    }
+  return total;
+}
+
+void
+MockChannel::ResetDeliveryCounters (void)
+{
+  for (DeliveryCounters &counters : m_deliveries)
+    {
+      counters = { 0, 0, 0, 0 };
+    }
+}
+
+uint64_t
+MockChannel::GetDeliveriesAttempted (void) const
+{
+  return GetDeliveryCounters ().attempted;
+}
+
+uint64_t
+MockChannel::GetDeliveriesUnreachable (void) const
+{
+  return GetDeliveryCounters ().unreachable;
+}
+
+uint64_t
+MockChannel::GetDeliveriesSucceeded (void) const
+{
+  return GetDeliveryCounters ().delivered;
+}
+
 void
 MockChannel::SetPropagationDelay (Ptr<PropagationDelayModel> delay)
 {
   m_propagationDelay = delay;
 }
 
+void
+MockChannel::NotifyCopyAvoided (void)
+{
+  m_copiesAvoided ++;
+}
+
+Ptr<LeoContactPlan>
+MockChannel::GetContactPlan (void) const
+{
+  return m_contactPlan;
+}
+
+void
+MockChannel::SetContactPlan (Ptr<LeoContactPlan> plan)
+{
+  NS_LOG_FUNCTION (this << plan);
+  m_contactPlan = plan;
+  if (m_contactPlan != 0)
+    {
+      m_contactPlan->Clear ();
+    }
+}
+
+bool
+MockChannel::GetPlannedReceivers (uint32_t srcId, std::vector<uint32_t> &receivers)
+{
+  NS_LOG_FUNCTION (this << srcId);
+
+  if (m_contactPlan == 0)
+    {
+      return false;
+    }
+  if (!m_contactPlan->IsComputed ())
+    {
+      DoComputeContactPlan (m_contactPlan);
+    }
+  if (!m_contactPlan->GetPeers (srcId, Simulator::Now (), receivers))
+    {
+      return false;
+    }
+  for (uint32_t id : m_contactPlan->GetUnplanned ())
+    {
+      if (id != srcId)
+        {
+          receivers.push_back (id);
+        }
+    }
+  return true;
+}
+
+void
+MockChannel::SetLinkCacheSize (uint32_t size)
+{
+  NS_LOG_FUNCTION (this << size);
+  LinkState unused;
+  unused.bucket = -1;
+  m_linkCache.assign (size, unused);
+}
+
+uint32_t
+MockChannel::GetLinkCacheSize (void) const
+{
+  return m_linkCache.size ();
+}
+
+void
+MockChannel::CourseChanged (MockChannel *channel, uint32_t id, Ptr<const MobilityModel> mob)
+{
+  channel->m_positionEpochs[id] ++;
+}
+
+uint32_t
+MockChannel::GetPositionEpoch (uint32_t id, Ptr<MobilityModel> mob)
+{
+  if (id >= m_epochSources.size ())
+    {
+      m_epochSources.resize (id + 1);
+      m_positionEpochs.resize (id + 1, 0);
+    }
+  if (m_epochSources[id] != mob)
+    {
+      if (m_epochSources[id] != 0)
+        {
+          m_epochSources[id]->TraceDisconnectWithoutContext ("CourseChange",
+                                                             MakeBoundCallback (&MockChannel::CourseChanged, this, id));
+        }
+      mob->TraceConnectWithoutContext ("CourseChange",
+                                       MakeBoundCallback (&MockChannel::CourseChanged, this, id));
+      m_epochSources[id] = mob;
+      m_positionEpochs[id] ++;
+    }
+  return m_positionEpochs[id];
+}
+
+void
+MockChannel::GetLinkState (Ptr<MockNetDevice> src, Ptr<MockNetDevice> dst,
+                           Ptr<MobilityModel> srcMob, Ptr<MobilityModel> dstMob,
+                           double txPower, Time txTime,
+                           double &rxPower, Time &delay)
+{
+  int32_t srcId = GetDeviceId (src->GetAddress ());
+  int32_t dstId = GetDeviceId (dst->GetAddress ());
+  Ptr<PropagationLossModel> pLoss = GetPropagationLoss ();
+  if (srcId < 0 || dstId < 0)
+    {
+      rxPower = pLoss != 0 ? pLoss->CalcRxPower (txPower, srcMob, dstMob) : txPower;
+      delay = GetPropagationDelay (srcMob, dstMob, txTime);
+      return;
+    }
+
+  int64_t bucket = Simulator::Now ().GetTimeStep () / m_linkCacheInterval.GetTimeStep ();
+  uint32_t srcEpoch = GetPositionEpoch (srcId, srcMob);
+  uint32_t dstEpoch = GetPositionEpoch (dstId, dstMob);
+
+  LinkState &state = m_linkCache[((uint64_t) srcId * 2654435761u + dstId) % m_linkCache.size ()];
+  if (state.bucket == bucket
+      && state.src == (uint32_t) srcId && state.dst == (uint32_t) dstId
+      && state.srcEpoch == srcEpoch && state.dstEpoch == dstEpoch
+      && state.txPower == txPower)
+    {
+      m_linkCacheHits ++;
+      rxPower = state.rxPower;
+      delay = state.delay;
+      return;
+    }
+
+  rxPower = pLoss != 0 ? pLoss->CalcRxPower (txPower, srcMob, dstMob) : txPower;
+  delay = GetPropagationDelay (srcMob, dstMob, txTime);
+
+  state.src = srcId;
+  state.dst = dstId;
+  state.srcEpoch = srcEpoch;
+  state.dstEpoch = dstEpoch;
+  state.bucket = bucket;
+  state.txPower = txPower;
+  state.rxPower = rxPower;
+  state.delay = delay;
+}
+
+void
+MockChannel::DoComputeContactPlan (Ptr<LeoContactPlan> plan)
+{
+}
+
+std::vector<Ptr<MobilityModel> >
+MockChannel::GetMobilityModels (void) const
+{
+  std::vector<Ptr<MobilityModel> > mobility;
+  mobility.reserve (m_link.size ());
+  for (Ptr<MockNetDevice> dev : m_link)
+    {
+      Ptr<Node> node = dev->GetNode ();
+      Ptr<MobilityModel> mob;
+      if (node != 0)
+        {
+          mob = node->GetObject<MobilityModel> ();
+        }
+      mobility.push_back (mob);
+    }
+  return mobility;
+}
+
 } // namespace ns3
@@ -20,6 +20,7 @@
 #define MOCK_CHANNEL_H
 
 #include <string>
+#include <unordered_map>
 #include <stdint.h>
 
 #include "ns3/object.h"
@@ -29,10 +30,12 @@
 #include "ns3/net-device.h"
 #include "ns3/time-data-calculators.h"
 #include "ns3/traced-callback.h"
+#include "ns3/traced-value.h"
 #include "ns3/mobility-module.h"
 #include "ns3/propagation-delay-model.h"
 #include "ns3/propagation-loss-model.h"
 #include "mock-net-device.h"
+#include "leo-contact-plan.h"
 
 /**
  * \file
@@ -83,12 +86,34 @@ public:
    */
   virtual bool Detach (uint32_t deviceId);
 
+  /**
+   * \brief Reserve space for the devices that are about to be attached
+   *
+   * Avoids reallocating the device tables while a large constellation is
+   * being installed.
+   *
+   * \param n total number of devices
+   */
+  virtual void Reserve (std::size_t n);
+
   /**
    * \brief Get number of devices in channel
    * \return number of devices
    */
   std::size_t GetNDevices (void) const;
 
+  /**
+   * \brief Get the index of a device by its address
+   *
+   * The index stays the same for as long as the device is attached to the
+   * channel and may be cached.
+   *
+   * \param addr address of the device at the time it has been attached
+   * \return index of the device inside the devices list, or -1 if no device
+   * with this address is attached
+   */
+  int32_t GetDeviceId (const Address &addr) const;
+
   /**
    * \brief Start to transmit a packet
    *
@@ -120,7 +145,100 @@ public:
    */
   void SetPropagationDelay (Ptr<PropagationDelayModel> delay);
 
+  /**
+   * \brief Notify the channel that a receiver did not need to copy a packet
+   *
+   * Used by MockNetDevice to contribute to the CopiesAvoided trace.
+   */
+  void NotifyCopyAvoided (void);
+
+  /**
+   * \brief Get the contact plan of the channel
+   * \return contact plan, may be null
+   */
+  Ptr<LeoContactPlan> GetContactPlan (void) const;
+
+  /**
+   * \brief Set the contact plan of the channel
+   *
+   * The plan is computed for the attached devices on the first transmission
+   * and must not be shared with other channels.
+   *
+   * \param plan contact plan, null to always check all devices
+   */
+  void SetContactPlan (Ptr<LeoContactPlan> plan);
+
+  /**
+   * \brief Set the number of links whose state is cached
+   * \param size number of cached links, 0 to disable the cache
+   */
+  void SetLinkCacheSize (uint32_t size);
+
+  /**
+   * \brief Get the number of links whose state is cached
+   * \return number of cached links
+   */
+  uint32_t GetLinkCacheSize (void) const;
+
+  /// Type of the receiving device by which the deliveries are counted
+  enum ReceiverType
+  {
+    /// Ground station or user terminal
+    GROUND,
+    /// Satellite on a ground-to-satellite channel
+    SATELLITE,
+    /// Any other device, like the ones of inter-satellite links
+    OTHER
+  };
+
+  /// Numbers of deliveries of transmissions to receivers
+  struct DeliveryCounters
+  {
+    /// Receivers to which a delivery has been attempted
+    uint64_t attempted;
+    /// Receivers that could not be reached
+    uint64_t unreachable;
+    /// Receivers to which the packet has been delivered
+    uint64_t delivered;
+    /// Receivers that have been skipped before the propagation loss model
+    /// has been evaluated, also counted as attempted and unreachable
+    uint64_t filtered;
+  };
+
+  /**
+   * \brief Get the numbers of deliveries to a type of receiver
+   * \param type type of the receiving devices
+   * \return counters
+   */
+  DeliveryCounters GetDeliveryCounters (ReceiverType type) const;
+
+  /**
+   * \brief Get the numbers of deliveries to all receivers
+   * \return counters
+   */
+  DeliveryCounters GetDeliveryCounters (void) const;
+
+  /**
+   * \brief Reset all delivery counters to zero
+   */
+  void ResetDeliveryCounters (void);
+
+  /**
+   * TracedCallback signature for delivery attempts
+   *
+   * \param [in] src transmitting device
+   * \param [in] dst receiving device
+   * \param [in] rxPower received power in dBm
+   * \param [in] delivered true iff the packet has been delivered
+   */
+  typedef void (* DeliveryAttemptCallback) (Ptr<const MockNetDevice> src,
+                                            Ptr<const MockNetDevice> dst,
+                                            double rxPower,
+                                            bool delivered);
+
 protected:
+  virtual void DoDispose (void);
+
   TracedCallback<Ptr<const Packet>,     // Packet being transmitted
                  Ptr<NetDevice>,  // Transmitting NetDevice
                  Ptr<NetDevice>,  // Receiving NetDevice
@@ -142,7 +260,7 @@ protected:
    * \param addr address of the device
    * \return pointer to the device if it is attached to the channel, null otherwise
    */
-  Ptr<MockNetDevice> GetDevice (Address &addr) const;
+  Ptr<MockNetDevice> GetDevice (const Address &addr) const;
 
   /**
    * \brief Deliver a packet to a destination
@@ -154,17 +272,194 @@ protected:
    */
   bool Deliver ( Ptr<const Packet> p, Ptr<MockNetDevice> src, Ptr<MockNetDevice> dst, Time txTime);
 
+  /**
+   * \brief Count a delivery attempt and fire the DeliveryAttempt trace
+   *
+   * Called by Deliver and by subclasses that reject receivers before.
+   *
+   * \param src transmitting device
+   * \param dst receiving device
+   * \param rxPower received power in dBm
+   * \param delivered true iff the packet has been delivered
+   */
+  void NotifyDeliveryAttempt (Ptr<MockNetDevice> src, Ptr<MockNetDevice> dst, double rxPower, bool delivered);
+
+  /**
+   * \brief Count receivers that have been skipped as unreachable
+   *
+   * Called by subclasses that preselect the receivers of a transmission, so
+   * that the counters do not depend on the preselection. Does not fire the
+   * DeliveryAttempt trace.
+   *
+   * \param type type of the skipped receivers
+   * \param n number of skipped receivers
+   */
+  void NotifyFiltered (ReceiverType type, uint64_t n);
+
+  /**
+   * \brief Get the devices that may receive a transmission according to the
+   * contact plan
+   *
+   * Computes the contact plan if necessary. The receivers still have to be
+   * checked by the propagation loss model.
+   *
+   * \param srcId id of the transmitting device
+   * \param [out] receivers ids of the devices that may be in range, including
+   * the devices that are not covered by the plan, are appended to this vector
+   * \return false if the plan does not cover the device at the current time
+   */
+  bool GetPlannedReceivers (uint32_t srcId, std::vector<uint32_t> &receivers);
+
+  /**
+   * \brief Compute the contact plan for the attached devices
+   *
+   * Channels that do not know which devices may reach each other leave the
+   * plan empty, which is the default.
+   *
+   * \param plan contact plan
+   */
+  virtual void DoComputeContactPlan (Ptr<LeoContactPlan> plan);
+
+  /**
+   * \brief Get the mobility models of all attached devices
+   * \return mobility models by device id, null for devices without one
+   */
+  std::vector<Ptr<MobilityModel> > GetMobilityModels (void) const;
+
 private:
 
   /// All devices that are attached to the channel
   std::vector<Ptr<MockNetDevice> > m_link;
 
+  /// Addresses of the attached devices mapped to their index in m_link
+  std::unordered_map<uint64_t, uint32_t> m_addressIndex;
+
+  /**
+   * \brief Get the key of an address inside the address index
+   * \param addr address
+   * \param [out] key key of the address
+   * \return true iff the address is a Mac48Address
+   */
+  static bool GetAddressKey (const Address &addr, uint64_t &key);
+
   /// Propagation delay model to be used with this channel
   Ptr<PropagationDelayModel> m_propagationDelay;
 
   /// Propagation loss model to be used with this channel
   Ptr<PropagationLossModel> m_propagationLoss;
 
+  /// Share one immutable packet between all receivers of a transmission
+  bool m_copyOnWrite;
+
+  /// Number of packet copies that have been avoided
+  TracedValue<uint64_t> m_copiesAvoided;
+
+  /// Precomputed contacts between the attached devices
+  Ptr<LeoContactPlan> m_contactPlan;
+
+  /// Propagation of a transmission between two devices
+  struct LinkState
+  {
+    /// Id of the source device
+    uint32_t src;
+    /// Id of the destination device
+    uint32_t dst;
+    /// Position epoch of the source device
+    uint32_t srcEpoch;
+    /// Position epoch of the destination device
+    uint32_t dstEpoch;
+    /// Time bucket in which the state has been computed, negative if unused
+    int64_t bucket;
+    /// Transmission power in dBm
+    double txPower;
+    /// Received power in dBm
+    double rxPower;
+    /// Propagation delay
+    Time delay;
+  };
+
+  /// Cached link states, direct-mapped by source and destination
+  std::vector<LinkState> m_linkCache;
+
+  /// Maximum time for which a link state is cached
+  Time m_linkCacheInterval;
+
+  /// Number of transmissions that have used a cached link state
+  TracedValue<uint64_t> m_linkCacheHits;
+
+  /// Delivery counters by ReceiverType
+  DeliveryCounters m_deliveries[OTHER + 1];
+
+  /// Fired for every receiver to which a delivery is attempted
+  TracedCallback<Ptr<const MockNetDevice>, Ptr<const MockNetDevice>, double, bool> m_deliveryAttempt;
+
+  /**
+   * \brief Get the type of a receiving device
+   * \param dev device
+   * \return type
+   */
+  static ReceiverType GetReceiverType (Ptr<MockNetDevice> dev);
+
+  /**
+   * \brief Get the total number of attempted deliveries
+   * \return number of deliveries
+   */
+  uint64_t GetDeliveriesAttempted (void) const;
+
+  /**
+   * \brief Get the total number of unreachable receivers
+   * \return number of deliveries
+   */
+  uint64_t GetDeliveriesUnreachable (void) const;
+
+  /**
+   * \brief Get the total number of successful deliveries
+   * \return number of deliveries
+   */
+  uint64_t GetDeliveriesSucceeded (void) const;
+
+  /// Number of position changes of the devices by id
+  std::vector<uint32_t> m_positionEpochs;
+
+  /// Mobility models whose course changes are counted by device id
+  std::vector<Ptr<MobilityModel> > m_epochSources;
+
+  /**
+   * \brief Count a position change of a device
+   * \param channel channel
+   * \param id id of the device
+   * \param mob mobility model of the device
+   */
+  static void CourseChanged (MockChannel *channel, uint32_t id, Ptr<const MobilityModel> mob);
+
+  /**
+   * \brief Get the propagation between two devices from the cache
+   *
+   * Computes and caches it if it is unknown or outdated.
+   *
+   * \param src source device
+   * \param dst destination device
+   * \param srcMob mobility model of the source
+   * \param dstMob mobility model of the destination
+   * \param txPower transmission power in dBm
+   * \param txTime transmission time of the packet
+   * \param [out] rxPower received power in dBm
+   * \param [out] delay propagation delay
+   */
+  void GetLinkState (Ptr<MockNetDevice> src, Ptr<MockNetDevice> dst,
+                     Ptr<MobilityModel> srcMob, Ptr<MobilityModel> dstMob,
+                     double txPower, Time txTime,
+                     double &rxPower, Time &delay);
+
+  /**
+   * \brief Get the position epoch of a device, counting its course changes
+   * from now on
+   * \param id id of the device
+   * \param mob mobility model of the device
+   * \return epoch
+   */
+  uint32_t GetPositionEpoch (uint32_t id, Ptr<MobilityModel> mob);
+
 }; // class MockChannel
 
 } // namespace ns3
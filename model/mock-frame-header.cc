@@ -0,0 +1,247 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tim Schubert <ns-3-leo@timschubert.net>
+ */
+
+#include "ns3/log.h"
+#include "ns3/address-utils.h"
+
+#include "mock-frame-header.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MockFrameHeader");
+
+NS_OBJECT_ENSURE_REGISTERED (MockFrameHeader);
+NS_OBJECT_ENSURE_REGISTERED (MockBurstTag);
+
+TypeId
+MockFrameHeader::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MockFrameHeader")
+    .SetParent<Header> ()
+    .SetGroupName ("Leo")
+    .AddConstructor<MockFrameHeader> ()
+  ;
+  return tid;
+}
+
+TypeId
+MockFrameHeader::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+MockFrameHeader::MockFrameHeader ()
+  : m_protocol (0)
+{
+}
+
+void
+MockFrameHeader::SetSource (Mac48Address source)
+{
+  m_source = source;
+}
+
+Mac48Address
+MockFrameHeader::GetSource (void) const
+{
+  return m_source;
+}
+
+void
+MockFrameHeader::SetDestination (Mac48Address destination)
+{
+  m_destination = destination;
+}
+
+Mac48Address
+MockFrameHeader::GetDestination (void) const
+{
+  return m_destination;
+}
+
+void
+MockFrameHeader::SetProtocol (uint16_t protocol)
+{
+  m_protocol = protocol;
+}
+
+uint16_t
+MockFrameHeader::GetProtocol (void) const
+{
+  return m_protocol;
+}
+
+void
+MockFrameHeader::Print (std::ostream &os) const
+{
+  os << m_source << "->" << m_destination << " protocol=0x" << std::hex << m_protocol << std::dec;
+}
+
+uint32_t
+MockFrameHeader::GetSerializedSize (void) const
+{
+  return 6 + 6 + 2;
+}
+
+void
+MockFrameHeader::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  WriteTo (i, m_destination);
+  WriteTo (i, m_source);
+  i.WriteHtonU16 (m_protocol);
+}
+
+uint32_t
+MockFrameHeader::Deserialize (Buffer::Iterator start)
+{
+  Buffer::Iterator i = start;
+  ReadFrom (i, m_destination);
+  ReadFrom (i, m_source);
+  m_protocol = i.ReadNtohU16 ();
+  return GetSerializedSize ();
+}
+
+TypeId
+MockBurstTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MockBurstTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Leo")
+    .AddConstructor<MockBurstTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+MockBurstTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+void
+MockBurstTag::AddFrame (Ptr<const Packet> frame)
+{
+  Frame f;
+  f.size = frame->GetSize ();
+
+  PacketTagIterator it = frame->GetPacketTagIterator ();
+  while (it.HasNext ())
+    {
+      PacketTagIterator::Item item = it.Next ();
+      TypeId tid = item.GetTypeId ();
+      Callback<ObjectBase *> constructor = tid.GetConstructor ();
+      NS_ASSERT_MSG (!constructor.IsNull (), "Packet tag " << tid.GetName () << " has no constructor");
+      Tag *tag = dynamic_cast<Tag *> (constructor ());
+      NS_ASSERT (tag != 0);
+      item.GetTag (*tag);
+
+      std::string name = tid.GetName ();
+      uint32_t size = tag->GetSerializedSize ();
+      size_t offset = f.tags.size ();
+      f.tags.resize (offset + 2 + name.size () + 4 + size);
+      TagBuffer buffer (f.tags.data () + offset, f.tags.data () + f.tags.size ());
+      buffer.WriteU16 (name.size ());
+      buffer.Write ((const uint8_t *) name.data (), name.size ());
+      buffer.WriteU32 (size);
+      tag->Serialize (buffer);
+      delete tag;
+    }
+
+  m_frames.push_back (f);
+}
+
+uint32_t
+MockBurstTag::GetNFrames (void) const
+{
+  return m_frames.size ();
+}
+
+uint32_t
+MockBurstTag::GetFrameSize (uint32_t i) const
+{
+  return m_frames[i].size;
+}
+
+void
+MockBurstTag::RestorePacketTags (uint32_t i, Ptr<Packet> frame) const
+{
+  const std::vector<uint8_t> &tags = m_frames[i].tags;
+  size_t offset = 0;
+  while (offset < tags.size ())
+    {
+      uint8_t *start = (uint8_t *) tags.data () + offset;
+      TagBuffer buffer (start, (uint8_t *) tags.data () + tags.size ());
+      std::string name (buffer.ReadU16 (), ' ');
+      buffer.Read ((uint8_t *) &name[0], name.size ());
+      uint32_t size = buffer.ReadU32 ();
+      offset += 2 + name.size () + 4;
+
+      TypeId tid = TypeId::LookupByName (name);
+      Tag *tag = dynamic_cast<Tag *> (tid.GetConstructor () ());
+      NS_ASSERT (tag != 0);
+      tag->Deserialize (TagBuffer ((uint8_t *) tags.data () + offset,
+                                   (uint8_t *) tags.data () + offset + size));
+      frame->AddPacketTag (*tag);
+      delete tag;
+      offset += size;
+    }
+}
+
+uint32_t
+MockBurstTag::GetSerializedSize (void) const
+{
+  uint32_t size = 2;
+  for (const Frame &f : m_frames)
+    {
+      size += 4 + 4 + f.tags.size ();
+    }
+  return size;
+}
+
+void
+MockBurstTag::Serialize (TagBuffer i) const
+{
+  i.WriteU16 (m_frames.size ());
+  for (const Frame &f : m_frames)
+    {
+      i.WriteU32 (f.size);
+      i.WriteU32 (f.tags.size ());
+      i.Write (f.tags.data (), f.tags.size ());
+    }
+}
+
+void
+MockBurstTag::Deserialize (TagBuffer i)
+{
+  m_frames.resize (i.ReadU16 ());
+  for (Frame &f : m_frames)
+    {
+      f.size = i.ReadU32 ();
+      f.tags.resize (i.ReadU32 ());
+      i.Read (f.tags.data (), f.tags.size ());
+    }
+}
+
+void
+MockBurstTag::Print (std::ostream &os) const
+{
+  os << "frames=" << m_frames.size ();
+}
+
+};
@@ -0,0 +1,176 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tim Schubert <ns-3-leo@timschubert.net>
+ */
+
+#ifndef MOCK_FRAME_HEADER_H
+#define MOCK_FRAME_HEADER_H
+
+#include <vector>
+#include <stdint.h>
+
+#include "ns3/header.h"
+#include "ns3/tag.h"
+#include "ns3/packet.h"
+#include "ns3/mac48-address.h"
+
+/**
+ * \file
+ * \ingroup leo
+ *
+ * Declaration of MockFrameHeader and MockBurstTag
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup leo
+ * \brief Compact frame header of the minimal framing mode of MockNetDevice
+ *
+ * Carries only the source and destination addresses and the protocol
+ * number. Unlike an Ethernet frame, it has no LLC/SNAP header, no padding
+ * and no trailer.
+ */
+class MockFrameHeader : public Header
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  /// constructor
+  MockFrameHeader ();
+
+  /**
+   * \brief Set the source address
+   * \param source source address
+   */
+  void SetSource (Mac48Address source);
+
+  /**
+   * \brief Get the source address
+   * \return source address
+   */
+  Mac48Address GetSource (void) const;
+
+  /**
+   * \brief Set the destination address
+   * \param destination destination address
+   */
+  void SetDestination (Mac48Address destination);
+
+  /**
+   * \brief Get the destination address
+   * \return destination address
+   */
+  Mac48Address GetDestination (void) const;
+
+  /**
+   * \brief Set the protocol number of the payload
+   * \param protocol protocol number
+   */
+  void SetProtocol (uint16_t protocol);
+
+  /**
+   * \brief Get the protocol number of the payload
+   * \return protocol number
+   */
+  uint16_t GetProtocol (void) const;
+
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+
+private:
+  /// Source address
+  Mac48Address m_source;
+  /// Destination address
+  Mac48Address m_destination;
+  /// Protocol number of the payload
+  uint16_t m_protocol;
+};
+
+/**
+ * \ingroup leo
+ * \brief Marks a packet as a burst of frames that are transmitted at once
+ *
+ * The burst only consists of the bytes of its frames, so that it takes as
+ * long to transmit as the frames themselves. The tag lists the sizes of the
+ * frames in order, together with their packet tags, which are lost when the
+ * frames are appended to the burst. Byte tags are kept by the burst itself.
+ */
+class MockBurstTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+
+  /**
+   * \brief Append a frame to the burst
+   * \param frame frame, whose packet tags must have a registered constructor
+   */
+  void AddFrame (Ptr<const Packet> frame);
+
+  /**
+   * \brief Get the number of frames
+   * \return number of frames
+   */
+  uint32_t GetNFrames (void) const;
+
+  /**
+   * \brief Get the size of a frame
+   * \param i index of the frame
+   * \return size in bytes
+   */
+  uint32_t GetFrameSize (uint32_t i) const;
+
+  /**
+   * \brief Add the packet tags that a frame had when it was added to the burst
+   * \param i index of the frame
+   * \param frame frame split from the burst
+   */
+  void RestorePacketTags (uint32_t i, Ptr<Packet> frame) const;
+
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+private:
+  /// Frame of the burst
+  struct Frame
+  {
+    /// Size in bytes
+    uint32_t size;
+    /// Packet tags, each with the name of its type, its size and its data
+    std::vector<uint8_t> tags;
+  };
+
+  /// Frames of the burst
+  std::vector<Frame> m_frames;
+};
+
+};
+
+#endif
@@ -16,6 +16,8 @@
  * Author: Tim Schubert <ns-3-leo@timschubert.net>
  */
 
+#include <algorithm>
+
 #include "ns3/log.h"
 #include "ns3/queue.h"
 #include "ns3/simulator.h"
@@ -26,11 +28,20 @@
 #include "ns3/uinteger.h"
 #include "ns3/pointer.h"
 #include "ns3/net-device-queue-interface.h"
+#include "ns3/queue-item.h"
+#include "ns3/socket.h"
 #include "ns3/ethernet-header.h"
 #include "ns3/ethernet-trailer.h"
 #include "ns3/double.h"
+#include "ns3/enum.h"
+#include "ns3/boolean.h"
+#include "ns3/arp-header.h"
+#include "ns3/arp-l3-protocol.h"
+#include "mock-arp-table.h"
 #include "mock-channel.h"
+#include "mock-frame-header.h"
 #include "mock-net-device.h"
+#include "mock-tx-scheduler.h"
 
 namespace ns3 {
 
@@ -80,6 +91,35 @@ MockNetDevice::GetTypeId (void)
                    DoubleValue (1.0),
                    MakeDoubleAccessor (&MockNetDevice::m_txPower),
                    MakeDoubleChecker<double> ())
+    .AddAttribute ("EnableTracing",
+                   "Whether the trace sources of the device are fired. "
+                   "Disabling them saves the cost of calling them for every "
+                   "packet in simulations that do not trace the device.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&MockNetDevice::m_tracing),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaxBurstPackets",
+                   "Maximum number of queued frames to the same destination "
+                   "that are transmitted at once as a single burst. 1 "
+                   "transmits every frame on its own.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&MockNetDevice::m_maxBurstPackets),
+                   MakeUintegerChecker<uint32_t> (1, 65535))
+    .AddAttribute ("MaxBurstBytes",
+                   "Maximum size of a burst in bytes. The first frame is "
+                   "always sent, even if it is larger. 0 for no limit.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MockNetDevice::m_maxBurstBytes),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("FramingMode",
+                   "Framing of the packets on the channel. Ethernet frames "
+                   "are padded and carry an FCS, as expected in pcap files. "
+                   "Minimal frames only carry the addresses and the protocol "
+                   "number. All devices on a channel must use the same framing.",
+                   EnumValue (MockNetDevice::ETHERNET),
+                   MakeEnumAccessor (&MockNetDevice::m_framingMode),
+                   MakeEnumChecker (MockNetDevice::ETHERNET, "Ethernet",
+                                    MockNetDevice::MINIMAL, "Minimal"))
 
     //
     // Transmit queueing discipline for the device which includes its own set
@@ -90,6 +130,13 @@ MockNetDevice::GetTypeId (void)
                    PointerValue (),
                    MakePointerAccessor (&MockNetDevice::m_queue),
                    MakePointerChecker<Queue<Packet> > ())
+    .AddAttribute ("TxScheduler",
+                   "The scheduler that selects the next transmit queue to be "
+                   "served if the device has several queues. Strict priority "
+                   "by queue index if not set.",
+                   PointerValue (),
+                   MakePointerAccessor (&MockNetDevice::m_scheduler),
+                   MakePointerChecker<MockTxScheduler> ())
     //
     // Trace sources at the "top" of the net device, where packets transition
     // to/from higher layers.
@@ -183,7 +230,11 @@ MockNetDevice::MockNetDevice ()
   :
     m_txMachineState (READY),
     m_channel (0),
+    m_currentQueue (0),
     m_linkUp (false),
+    m_framingMode (ETHERNET),
+    m_checksumEnabled (Node::ChecksumEnabled ()),
+    m_tracing (true),
     m_currentPkt (0)
 {
   NS_LOG_FUNCTION (this);
@@ -201,6 +252,17 @@ MockNetDevice::AddHeader (Ptr<Packet> p,
 			  uint16_t protocolNumber)
 {
   NS_LOG_FUNCTION (this << p << protocolNumber);
+
+  if (m_framingMode == MINIMAL)
+    {
+      MockFrameHeader frame;
+      frame.SetSource (Mac48Address::ConvertFrom (src));
+      frame.SetDestination (Mac48Address::ConvertFrom (dst));
+      frame.SetProtocol (protocolNumber);
+      p->AddHeader (frame);
+      return;
+    }
+
   EthernetHeader header (false);
   header.SetSource (Mac48Address::ConvertFrom (src));
   header.SetDestination (Mac48Address::ConvertFrom (dst));
@@ -243,11 +305,12 @@ MockNetDevice::AddHeader (Ptr<Packet> p,
   header.SetLengthType (lengthType);
   p->AddHeader (header);
 
-  if (Node::ChecksumEnabled ())
+  // without checksums, the trailer is only added to keep the frame format
+  if (m_checksumEnabled)
     {
       trailer.EnableFcs (true);
+      trailer.CalcFcs (p);
     }
-  trailer.CalcFcs (p);
   p->AddTrailer (trailer);
 }
 
@@ -257,14 +320,26 @@ MockNetDevice::DoInitialize (void)
   if (m_queueInterface)
     {
       NS_ASSERT_MSG (m_queue != 0, "A Queue object has not been attached to the device");
+      NS_ASSERT_MSG (m_queueInterface->GetNTxQueues () == GetNQueues (),
+                     "The NetDeviceQueueInterface must have one transmission queue per device queue");
 
-      // connect the traced callbacks of m_queue to the static methods provided by
+      // connect the traced callbacks of the queues to the static methods provided by
       // the NetDeviceQueue class to support flow control and dynamic queue limits.
       // This could not be done in NotifyNewAggregate because at that time we are
       // not guaranteed that a queue has been attached to the netdevice
-      m_queueInterface->GetTxQueue (0)->ConnectQueueTraces (m_queue);
+      for (uint32_t i = 0; i < GetNQueues (); i ++)
+        {
+          m_queueInterface->GetTxQueue (i)->ConnectQueueTraces (GetQueue (i));
+        }
+      if (m_queues.size () > 1)
+        {
+          m_queueInterface->SetSelectQueueCallback (MakeCallback (&MockNetDevice::SelectTxQueue, this));
+        }
     }
 
+  // the global value may have been set after the device has been created
+  m_checksumEnabled = Node::ChecksumEnabled ();
+
   NetDevice::DoInitialize ();
 }
 
@@ -294,6 +369,10 @@ MockNetDevice::DoDispose ()
   m_receiveErrorModel = 0;
   m_currentPkt = 0;
   m_queue = 0;
+  m_queues.clear ();
+  m_scheduler = 0;
+  m_queueSelector = QueueSelectorCallback ();
+  m_arpTable = 0;
   m_queueInterface = 0;
   NetDevice::DoDispose ();
 }
@@ -326,18 +405,36 @@ MockNetDevice::TransmitStart (Ptr<Packet> p, const Address &dest)
   NS_ASSERT_MSG (m_txMachineState == READY, "Must be READY to transmit");
   m_txMachineState = BUSY;
   m_currentPkt = p;
-  m_phyTxBeginTrace (m_currentPkt);
+
+  if (m_maxBurstPackets > 1)
+    {
+      p = MakeBurst (Mac48Address::ConvertFrom (dest));
+    }
+  else if (m_tracing)
+    {
+      m_phyTxBeginTrace (m_currentPkt);
+    }
 
   Time txTime = m_bps.CalculateBytesTxTime (p->GetSize ());
   Time txCompleteTime = txTime + m_tInterframeGap;
 
   NS_LOG_LOGIC ("Schedule TransmitCompleteEvent in " << txCompleteTime.GetNanoSeconds () << " nsec");
-  Simulator::Schedule (txCompleteTime, &MockNetDevice::TransmitComplete, this, dest);
+  Simulator::Schedule (txCompleteTime, &MockNetDevice::TransmitComplete, this);
 
   bool result = m_channel->TransmitStart (p, m_channelDevId, dest, txTime);
   if (result == false)
     {
-      m_phyTxDropTrace (p);
+      if (m_tracing && m_burst.empty ())
+        {
+          m_phyTxDropTrace (p);
+        }
+      else if (m_tracing)
+        {
+          for (Ptr<Packet> frame : m_burst)
+            {
+              m_phyTxDropTrace (frame);
+            }
+        }
     }
   else
     {
@@ -346,8 +443,73 @@ MockNetDevice::TransmitStart (Ptr<Packet> p, const Address &dest)
   return result;
 }
 
+Ptr<Packet>
+MockNetDevice::MakeBurst (Mac48Address dest)
+{
+  NS_LOG_FUNCTION (this << dest);
+
+  m_burst.clear ();
+  m_burst.push_back (m_currentPkt);
+  uint32_t bytes = m_currentPkt->GetSize ();
+  // the burst continues with the queue of the current packet
+  Ptr<Queue<Packet> > queue = GetQueue (m_currentQueue);
+  while (m_burst.size () < m_maxBurstPackets)
+    {
+      Ptr<const Packet> next = queue->Peek ();
+      if (next == 0
+          || (m_maxBurstBytes > 0 && bytes + next->GetSize () > m_maxBurstBytes)
+          || GetDestination (next) != dest)
+        {
+          break;
+        }
+      Ptr<Packet> frame = queue->Dequeue ();
+      if (m_scheduler != 0)
+        {
+          m_scheduler->NotifyDequeue (m_currentQueue, frame->GetSize ());
+        }
+      if (m_tracing)
+        {
+          m_snifferTrace (frame);
+          m_promiscSnifferTrace (frame);
+        }
+      bytes += frame->GetSize ();
+      m_burst.push_back (frame);
+    }
+
+  // the frames are listed in a tag, so that only their own bytes take airtime
+  MockBurstTag tag;
+  Ptr<Packet> burst = Create<Packet> ();
+  for (Ptr<Packet> frame : m_burst)
+    {
+      if (m_tracing)
+        {
+          m_phyTxBeginTrace (frame);
+        }
+      tag.AddFrame (frame);
+      burst->AddAtEnd (frame);
+    }
+  burst->AddPacketTag (tag);
+
+  NS_LOG_LOGIC ("burst of " << m_burst.size () << " frames with " << bytes << " bytes");
+  return burst;
+}
+
+Mac48Address
+MockNetDevice::GetDestination (Ptr<const Packet> p) const
+{
+  if (m_framingMode == MINIMAL)
+    {
+      MockFrameHeader frame;
+      p->PeekHeader (frame);
+      return frame.GetDestination ();
+    }
+  EthernetHeader header;
+  p->PeekHeader (header);
+  return header.GetDestination ();
+}
+
 void
-MockNetDevice::TransmitComplete (const Address &dest)
+MockNetDevice::TransmitComplete (void)
 {
   NS_LOG_FUNCTION (this);
 
@@ -362,10 +524,21 @@ MockNetDevice::TransmitComplete (const Address &dest)
 
   NS_ASSERT_MSG (m_currentPkt != 0, "MockNetDevice::TransmitComplete(): m_currentPkt zero");
 
-  m_phyTxEndTrace (m_currentPkt);
+  if (m_tracing && m_burst.empty ())
+    {
+      m_phyTxEndTrace (m_currentPkt);
+    }
+  else if (m_tracing)
+    {
+      for (Ptr<Packet> frame : m_burst)
+        {
+          m_phyTxEndTrace (frame);
+        }
+    }
+  m_burst.clear ();
   m_currentPkt = 0;
 
-  Ptr<Packet> p = m_queue->Dequeue ();
+  Ptr<Packet> p = DequeueNext ();
   if (p == 0)
     {
       NS_LOG_LOGIC ("No pending packets in device queue after tx complete");
@@ -374,10 +547,14 @@ MockNetDevice::TransmitComplete (const Address &dest)
 
   //
   // Got another packet off of the queue, so start the transmit process again.
+  // The packet may be for another destination than the previous one.
   //
-  m_snifferTrace (p);
-  m_promiscSnifferTrace (p);
-  TransmitStart (p, dest);
+  if (m_tracing)
+    {
+      m_snifferTrace (p);
+      m_promiscSnifferTrace (p);
+    }
+  TransmitStart (p, GetDestination (p));
 }
 
 bool
@@ -403,6 +580,117 @@ MockNetDevice::SetQueue (Ptr<Queue<Packet> > q)
 {
   NS_LOG_FUNCTION (this << q);
   m_queue = q;
+  m_queues.clear ();
+}
+
+void
+MockNetDevice::SetQueues (const std::vector<Ptr<Queue<Packet> > > &queues)
+{
+  NS_LOG_FUNCTION (this << queues.size ());
+  NS_ASSERT_MSG (!queues.empty (), "A device needs at least one queue");
+  m_queue = queues[0];
+  m_queues.clear ();
+  if (queues.size () > 1)
+    {
+      m_queues = queues;
+      if (m_scheduler == 0)
+        {
+          m_scheduler = CreateObject<MockStrictPriorityTxScheduler> ();
+        }
+    }
+}
+
+uint32_t
+MockNetDevice::GetNQueues (void) const
+{
+  return m_queues.empty () ? 1 : m_queues.size ();
+}
+
+Ptr<Queue<Packet> >
+MockNetDevice::GetQueue (uint32_t i) const
+{
+  NS_ASSERT_MSG (i < GetNQueues (), "Queue index out of range");
+  return m_queues.empty () ? m_queue : m_queues[i];
+}
+
+void
+MockNetDevice::SetTxScheduler (Ptr<MockTxScheduler> scheduler)
+{
+  NS_LOG_FUNCTION (this << scheduler);
+  m_scheduler = scheduler;
+}
+
+Ptr<MockTxScheduler>
+MockNetDevice::GetTxScheduler (void) const
+{
+  return m_scheduler;
+}
+
+void
+MockNetDevice::SetQueueSelector (QueueSelectorCallback selector)
+{
+  m_queueSelector = selector;
+}
+
+uint32_t
+MockNetDevice::SelectQueue (Ptr<const Packet> p, uint16_t protocolNumber) const
+{
+  uint32_t n = GetNQueues ();
+  if (n == 1)
+    {
+      return 0;
+    }
+  if (!m_queueSelector.IsNull ())
+    {
+      uint32_t i = m_queueSelector (p, protocolNumber);
+      NS_ASSERT_MSG (i < n, "Queue selector returned an unknown queue");
+      return i;
+    }
+  if (protocolNumber == 0x0806)
+    {
+      return 0;
+    }
+  // the eight socket priorities are spread over the queues, highest first
+  SocketPriorityTag tag;
+  uint32_t priority = p->PeekPacketTag (tag) ? std::min<uint32_t> (tag.GetPriority (), 7) : 0;
+  return (7 - priority) * n / 8;
+}
+
+void
+MockNetDevice::SetArpTable (Ptr<MockArpTable> table)
+{
+  NS_LOG_FUNCTION (this << table);
+  m_arpTable = table;
+}
+
+Ptr<MockArpTable>
+MockNetDevice::GetArpTable (void) const
+{
+  return m_arpTable;
+}
+
+std::size_t
+MockNetDevice::SelectTxQueue (Ptr<QueueItem> item)
+{
+  Ptr<QueueDiscItem> qdItem = DynamicCast<QueueDiscItem> (item);
+  return SelectQueue (item->GetPacket (), qdItem != 0 ? qdItem->GetProtocol () : 0);
+}
+
+Ptr<Packet>
+MockNetDevice::DequeueNext (void)
+{
+  if (m_queues.empty ())
+    {
+      m_currentQueue = 0;
+      return m_queue->Dequeue ();
+    }
+  uint32_t i = m_scheduler->Select (m_queues);
+  if (i >= m_queues.size ())
+    {
+      return 0;
+    }
+  m_currentQueue = i;
+  return m_queues[i]->Dequeue ();
 }
 
 void
@@ -419,95 +707,117 @@ MockNetDevice::DoCalcRxPower (double rxPower) const
 }
 
 void
-MockNetDevice::Receive (Ptr<Packet> packet,
+MockNetDevice::Receive (Ptr<const Packet> packet,
 			Ptr<MockNetDevice> senderDevice,
 			double rxPower)
 {
   NS_LOG_FUNCTION (this << packet << senderDevice << rxPower);
 
+  MockBurstTag burstTag;
+  if (packet->PeekPacketTag (burstTag))
+    {
+      ReceiveBurst (packet, burstTag, senderDevice, rxPower);
+      return;
+    }
+
   if (senderDevice == this)
     {
-      m_macRxDropTrace (packet);
+      if (m_tracing)
+        {
+          m_macRxDropTrace (packet);
+        }
       return;
     }
 
-  m_phyRxEndTrace (packet);
+  if (m_tracing)
+    {
+      m_phyRxEndTrace (packet);
+    }
 
   rxPower = DoCalcRxPower (rxPower);
 
   if (rxPower < m_rxThreshold)
     {
       // Received power is below threshold
-      m_phyRxDropTrace (packet);
-      return;
-    }
-
-  if (m_receiveErrorModel && m_receiveErrorModel->IsCorrupt (packet) )
-    {
-      //
-      // If we have an error model and it indicates that it is time to lose a
-      // corrupted packet, don't forward this packet up, let it go.
-      //
-      m_phyRxDropTrace (packet);
-
+      if (m_tracing)
+        {
+          m_phyRxDropTrace (packet);
+        }
       return;
     }
 
   //
-  // Trace sinks will expect complete packets, not packets without some of the
-  // headers.
+  // The packet may be shared with the other receivers of the transmission, so
+  // a mutable copy is only made once it is clear that it will be modified.
   //
-  Ptr<Packet> originalPacket = packet->Copy ();
+  Ptr<Packet> copy;
 
-  EthernetTrailer trailer;
-  packet->RemoveTrailer (trailer);
-  if (Node::ChecksumEnabled ())
+  if (m_receiveErrorModel)
     {
-      trailer.EnableFcs (true);
+      copy = packet->Copy ();
+      if (m_receiveErrorModel->IsCorrupt (copy))
+        {
+          //
+          // If we have an error model and it indicates that it is time to lose a
+          // corrupted packet, don't forward this packet up, let it go.
+          //
+          if (m_tracing)
+            {
+              m_phyRxDropTrace (copy);
+            }
+          return;
+        }
     }
 
-  bool crcGood = trailer.CheckFcs (packet);
-  if (!crcGood)
+  EthernetHeader header;
+  MockFrameHeader frame;
+  Mac48Address destination;
+  bool trailerRemoved = false;
+  if (m_framingMode == MINIMAL)
     {
-      NS_LOG_INFO ("CRC error on Packet " << packet);
-      m_phyRxDropTrace (packet);
-      return;
+      packet->PeekHeader (frame);
+      destination = frame.GetDestination ();
     }
-
-  EthernetHeader header;
-  packet->RemoveHeader (header);
-
-  uint16_t protocol;
-
-  if (header.GetLengthType () <= 1500)
+  else
     {
-      NS_ASSERT (packet->GetSize () >= header.GetLengthType ());
-      uint32_t padlen = packet->GetSize () - header.GetLengthType ();
-      NS_ASSERT (padlen <= 46);
-      if (padlen > 0)
+      if (m_checksumEnabled)
         {
-          packet->RemoveAtEnd (padlen);
+          if (!copy)
+            {
+              copy = packet->Copy ();
+            }
+
+          EthernetTrailer trailer;
+          copy->RemoveTrailer (trailer);
+          trailerRemoved = true;
+          trailer.EnableFcs (true);
+
+          bool crcGood = trailer.CheckFcs (copy);
+          if (!crcGood)
+            {
+              NS_LOG_INFO ("CRC error on Packet " << packet);
+              if (m_tracing)
+                {
+                  m_phyRxDropTrace (packet);
+                }
+              return;
+            }
         }
 
-      LlcSnapHeader llc;
-      packet->RemoveHeader (llc);
-      protocol = llc.GetType ();
-    }
-  else
-    {
-      protocol = header.GetLengthType ();
+      packet->PeekHeader (header);
+      destination = header.GetDestination ();
     }
 
   PacketType packetType;
-  if (header.GetDestination ().IsBroadcast ())
+  if (destination.IsBroadcast ())
     {
       packetType = PACKET_BROADCAST;
     }
-  else if (header.GetDestination () == m_address)
+  else if (destination == m_address)
     {
       packetType = PACKET_HOST;
     }
-  else if (header.GetDestination ().IsGroup ())
+  else if (destination.IsGroup ())
     {
       packetType = PACKET_MULTICAST;
     }
@@ -516,20 +826,118 @@ MockNetDevice::Receive (Ptr<Packet> packet,
       packetType = PACKET_OTHERHOST;
     }
 
-  m_promiscSnifferTrace (originalPacket);
+  //
+  // Trace sinks will expect complete packets, not packets without some of the
+  // headers.
+  //
+  if (m_tracing)
+    {
+      m_promiscSnifferTrace (packet);
+    }
+
+  if (packetType == PACKET_OTHERHOST && m_promiscCallback.IsNull ())
+    {
+      // Nobody is going to look at the payload
+      if (!copy && m_channel)
+        {
+          m_channel->NotifyCopyAvoided ();
+        }
+      return;
+    }
+
+  uint16_t protocol;
+  Mac48Address source;
+
+  if (m_framingMode == MINIMAL)
+    {
+      if (!copy)
+        {
+          copy = packet->Copy ();
+        }
+      copy->RemoveHeader (frame);
+      protocol = frame.GetProtocol ();
+      source = frame.GetSource ();
+    }
+  else
+    {
+      if (!copy)
+        {
+          copy = packet->Copy ();
+        }
+      // the copy of the error model still carries the trailer
+      if (!trailerRemoved)
+        {
+          EthernetTrailer trailer;
+          copy->RemoveTrailer (trailer);
+        }
+      copy->RemoveHeader (header);
+
+      if (header.GetLengthType () <= 1500)
+        {
+          NS_ASSERT (copy->GetSize () >= header.GetLengthType ());
+          uint32_t padlen = copy->GetSize () - header.GetLengthType ();
+          NS_ASSERT (padlen <= 46);
+          if (padlen > 0)
+            {
+              copy->RemoveAtEnd (padlen);
+            }
+
+          LlcSnapHeader llc;
+          copy->RemoveHeader (llc);
+          protocol = llc.GetType ();
+        }
+      else
+        {
+          protocol = header.GetLengthType ();
+        }
+      source = header.GetSource ();
+    }
+
   if (!m_promiscCallback.IsNull ())
     {
-      m_macPromiscRxTrace (originalPacket);
-      m_promiscCallback (this, packet, protocol, header.GetSource (), header.GetDestination (), packetType);
+      if (m_tracing)
+        {
+          m_macPromiscRxTrace (packet);
+        }
+      m_promiscCallback (this, copy, protocol, source, destination, packetType);
     }
 
   if (packetType != PACKET_OTHERHOST) {
-      NS_LOG_INFO ("[node " << m_node->GetId () << "] received packet on " << m_ifIndex << " from " << header.GetSource () << " for " << header.GetDestination ());
-      m_macRxTrace (originalPacket);
-      m_rxCallback (this, packet, protocol, header.GetSource ());
+      NS_LOG_INFO ("[node " << m_node->GetId () << "] received packet on " << m_ifIndex << " from " << source << " for " << destination);
+      if (m_tracing)
+        {
+          m_macRxTrace (packet);
+        }
+      m_rxCallback (this, copy, protocol, source);
   }
 }
 
+void
+MockNetDevice::ReceiveBurst (Ptr<const Packet> burst,
+                             const MockBurstTag &burstTag,
+                             Ptr<MockNetDevice> senderDevice,
+                             double rxPower)
+{
+  NS_LOG_FUNCTION (this << burst << senderDevice << rxPower);
+
+  // the fragments get the packet tags of the burst, of which the ones that
+  // have been added to the whole burst, e.g. by the channel, apply to every
+  // frame
+  Ptr<Packet> frames = burst->Copy ();
+  MockBurstTag tag;
+  frames->RemovePacketTag (tag);
+
+  uint32_t offset = 0;
+  for (uint32_t i = 0; i < burstTag.GetNFrames (); i ++)
+    {
+      uint32_t size = burstTag.GetFrameSize (i);
+      Ptr<Packet> frame = frames->CreateFragment (offset, size);
+      burstTag.RestorePacketTags (i, frame);
+      Receive (frame, senderDevice, rxPower);
+      offset += size;
+    }
+}
+
 Ptr<Queue<Packet> >
 MockNetDevice::GetQueue (void) const
 {
@@ -665,6 +1073,16 @@ MockNetDevice::Send (Ptr<Packet> packet,
   		     uint16_t protocolNumber)
 {
   NS_LOG_FUNCTION (this << packet << dest << protocolNumber);
+  return SendFrom (packet, m_address, dest, protocolNumber);
+}
+
+bool
+MockNetDevice::SendFrom (Ptr<Packet> packet,
+                         const Address &source,
+                         const Address &dest,
+                         uint16_t protocolNumber)
+{
+  NS_LOG_FUNCTION (this << packet << source << dest << protocolNumber);
   NS_LOG_LOGIC ("p=" << packet << ", dest=" << &dest);
   NS_LOG_LOGIC ("UID is " << packet->GetUid ());
 
@@ -674,53 +1092,101 @@ MockNetDevice::Send (Ptr<Packet> packet,
   //
   if (IsLinkUp () == false)
     {
-      m_macTxDropTrace (packet);
+      if (m_tracing)
+        {
+          m_macTxDropTrace (packet);
+        }
       return false;
     }
 
+  if (AnswerArpRequest (packet, protocolNumber))
+    {
+      return true;
+    }
+
+  // classify the packet as traffic control sees it, before the headers are added
+  Ptr<Queue<Packet> > queue = GetQueue (SelectQueue (packet, protocolNumber));
+
   Mac48Address destination = Mac48Address::ConvertFrom (dest);
-  Mac48Address source = Mac48Address::ConvertFrom (m_address);
-  AddHeader (packet, source, destination, protocolNumber);
+  AddHeader (packet, Mac48Address::ConvertFrom (source), destination, protocolNumber);
 
-  m_macTxTrace (packet);
+  if (m_tracing)
+    {
+      m_macTxTrace (packet);
+    }
 
   //
   // We should enqueue and dequeue the packet to hit the tracing hooks.
   //
-  if (m_queue->Enqueue (packet))
+  if (queue->Enqueue (packet))
     {
       //
-      // If the channel is ready for transition we send the packet right now
+      // If the channel is ready for transition we send the packet right now.
+      // All queues are empty then, so the scheduler picks this packet.
       //
       if (m_txMachineState == READY)
         {
-          packet = m_queue->Dequeue ();
-          m_promiscSnifferTrace (packet);
-          m_snifferTrace (packet);
+          packet = DequeueNext ();
+          if (m_tracing)
+            {
+              m_promiscSnifferTrace (packet);
+              m_snifferTrace (packet);
+            }
           TransmitStart (packet, dest);
         }
       else
       	{
-      	  NS_LOG_LOGIC (this << "channel not ready, postponing transmit start: " << m_queue->GetCurrentSize () << "/" << m_queue->GetMaxSize ());
+      	  NS_LOG_LOGIC (this << "channel not ready, postponing transmit start: " << queue->GetCurrentSize () << "/" << queue->GetMaxSize ());
       	}
       return true;
     }
 
   // Enqueue may fail (overflow)
-  NS_LOG_WARN ("queue overflowed: " << m_queue->GetCurrentSize () << "/" << m_queue->GetMaxSize ());
+  NS_LOG_WARN ("queue overflowed: " << queue->GetCurrentSize () << "/" << queue->GetMaxSize ());
 
-  m_macTxDropTrace (packet);
+  if (m_tracing)
+    {
+      m_macTxDropTrace (packet);
+    }
   return false;
 }
 
 bool
-MockNetDevice::SendFrom (Ptr<Packet> packet,
-                                 const Address &source,
-                                 const Address &dest,
-                                 uint16_t protocolNumber)
+MockNetDevice::AnswerArpRequest (Ptr<const Packet> packet, uint16_t protocolNumber)
 {
-  NS_LOG_FUNCTION (this << packet << source << dest << protocolNumber);
-  return false;
+  if (m_arpTable == 0 || protocolNumber != ArpL3Protocol::PROT_NUMBER)
+    {
+      return false;
+    }
+
+  ArpHeader request;
+  packet->PeekHeader (request);
+  Address mac;
+  if (!request.IsRequest ()
+      || !m_arpTable->Lookup (request.GetDestinationIpv4Address (), mac))
+    {
+      // unknown neighbours are asked over the channel
+      return false;
+    }
+
+  NS_LOG_LOGIC ("answering ARP request for " << request.GetDestinationIpv4Address () << " locally");
+  ArpHeader reply;
+  reply.SetReply (mac,
+                  request.GetDestinationIpv4Address (),
+                  request.GetSourceHardwareAddress (),
+                  request.GetSourceIpv4Address ());
+  Ptr<Packet> p = Create<Packet> ();
+  p->AddHeader (reply);
+  // the ARP protocol must finish sending the request before it sees the reply
+  Simulator::ScheduleNow (&MockNetDevice::ReceiveArpReply, this, p, mac);
+  return true;
+}
+
+void
+MockNetDevice::ReceiveArpReply (Ptr<Packet> reply, Address from)
+{
+  NS_LOG_FUNCTION (this << reply << from);
+  m_rxCallback (this, reply, ArpL3Protocol::PROT_NUMBER, from);
 }
 
 Ptr<Node>
@@ -759,7 +1225,7 @@ bool
 MockNetDevice::SupportsSendFrom (void) const
 {
   NS_LOG_FUNCTION (this);
-  return false;
+  return true;
 }
 
 void
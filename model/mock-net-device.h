@@ -20,6 +20,7 @@
 #define MOCK_NET_DEVICE_H
 
 #include <cstring>
+#include <vector>
 
 #include "ns3/address.h"
 #include "ns3/node.h"
@@ -46,7 +47,11 @@ namespace ns3 {
 
 template <typename Item> class Queue;
 class NetDeviceQueueInterface;
+class QueueItem;
 class MockChannel;
+class MockTxScheduler;
+class MockBurstTag;
+class MockArpTable;
 class ErrorModel;
 
 /**
@@ -63,6 +68,23 @@ public:
    */
   static TypeId GetTypeId (void);
 
+  /// Framing of the packets that are sent over the channel
+  enum FramingMode
+  {
+    /// Ethernet frames with LLC/SNAP header, padding and FCS, as written to pcap files
+    ETHERNET,
+    /// Only a MockFrameHeader with the addresses and the protocol number
+    MINIMAL
+  };
+
+  /**
+   * \brief Callback to select the transmit queue of a packet
+   *
+   * Called with the packet before any header of the device is added and
+   * with its protocol number. Returns the index of the queue.
+   */
+  typedef Callback<uint32_t, Ptr<const Packet>, uint16_t> QueueSelectorCallback;
+
   /**
    * Construct a MockNetDevice
    *
@@ -141,6 +163,80 @@ public:
    */
   Ptr<Queue<Packet> > GetQueue (void) const;
 
+  /**
+   * Attach several transmit queues to the MockNetDevice.
+   *
+   * Packets are sorted into the queues by the queue selector, and the
+   * transmit scheduler decides which queue is served next. The first queue
+   * replaces the one set by SetQueue. If a NetDeviceQueueInterface is
+   * aggregated, it must have as many transmission queues.
+   *
+   * \param queues the transmit queues
+   */
+  void SetQueues (const std::vector<Ptr<Queue<Packet> > > &queues);
+
+  /**
+   * \brief Get the number of transmit queues
+   * \return number of transmit queues
+   */
+  uint32_t GetNQueues (void) const;
+
+  /**
+   * \brief Get a transmit queue
+   * \param i index of the queue
+   * \return the queue
+   */
+  Ptr<Queue<Packet> > GetQueue (uint32_t i) const;
+
+  /**
+   * \brief Set the scheduler that selects the next queue to be served
+   * \param scheduler the scheduler
+   */
+  void SetTxScheduler (Ptr<MockTxScheduler> scheduler);
+
+  /**
+   * \brief Get the scheduler of the transmit queues
+   * \return the scheduler
+   */
+  Ptr<MockTxScheduler> GetTxScheduler (void) const;
+
+  /**
+   * \brief Set the callback that selects the transmit queue of a packet
+   *
+   * By default, ARP packets are put into the first queue and all other
+   * packets into a queue according to their SocketPriorityTag, the highest
+   * priority being the first queue.
+   *
+   * \param selector the queue selector
+   */
+  void SetQueueSelector (QueueSelectorCallback selector);
+
+  /**
+   * \brief Select the transmit queue of a packet from the traffic control layer
+   *
+   * Installed as the select queue callback of the NetDeviceQueueInterface,
+   * so that traffic control and the device agree on the queue of a packet.
+   *
+   * \param item queue item
+   * \return index of the transmit queue
+   */
+  std::size_t SelectTxQueue (Ptr<QueueItem> item);
+
+  /**
+   * \brief Set the table of neighbours whose ARP requests are answered by
+   * the device itself
+   *
+   * \param table the neighbour table, or null to send all ARP requests
+   * over the channel
+   */
+  void SetArpTable (Ptr<MockArpTable> table);
+
+  /**
+   * \brief Get the table of neighbours
+   * \return the neighbour table
+   */
+  Ptr<MockArpTable> GetArpTable (void) const;
+
   /**
    * Attach a receive ErrorModel to the MockNetDevice.
    *
@@ -159,11 +255,15 @@ public:
    * used by the channel to indicate that the last bit of a packet has
    * arrived at the device.
    *
+   * The packet may be shared with other receivers and is not modified.
+   * A copy is only made if the packet is passed up the protocol stack or
+   * needs to be checked by the error model or the FCS.
+   *
    * \param p Ptr to the received packet.
    * \param senderDevice sender
    * \param rxPower RX power excluding receiver gain and loss
    */
-  void Receive (Ptr<Packet> p, Ptr<MockNetDevice> senderDevice, double rxPower);
+  void Receive (Ptr<const Packet> p, Ptr<MockNetDevice> senderDevice, double rxPower);
 
   // The remaining methods are documented in ns3::NetDevice*
 
@@ -277,6 +377,21 @@ private:
    */
   bool ProcessHeader (Ptr<Packet> p, uint16_t& param);
 
+  /**
+   * \brief Answer an ARP request from the neighbour table
+   * \param packet packet that is about to be sent
+   * \param protocolNumber protocol number of the packet
+   * \return whether the packet was an ARP request that has been answered
+   */
+  bool AnswerArpRequest (Ptr<const Packet> packet, uint16_t protocolNumber);
+
+  /**
+   * \brief Pass a locally created ARP reply up the stack
+   * \param reply the reply
+   * \param from hardware address of the neighbour
+   */
+  void ReceiveArpReply (Ptr<Packet> reply, Address from);
+
   /**
    * Start Sending a Packet Down the Wire.
    *
@@ -290,17 +405,63 @@ private:
    * \see MockChannel::TransmitStart ()
    * \see TransmitComplete()
    * \param p a reference to the packet to send
+   * \param dest destination of the packet
    * \returns true if success, false on failure
    */
   bool TransmitStart (Ptr<Packet> p, const Address &dest);
 
+  /**
+   * \brief Aggregate the current packet and the queued packets behind it
+   *
+   * Dequeues packets for the same destination until MaxBurstPackets or
+   * MaxBurstBytes is reached.
+   *
+   * \param dest destination of the current packet
+   * \return burst to transmit
+   */
+  Ptr<Packet> MakeBurst (Mac48Address dest);
+
+  /**
+   * \brief Select the transmit queue of a packet
+   * \param p packet without the headers of the device
+   * \param protocolNumber protocol number
+   * \return index of the queue
+   */
+  uint32_t SelectQueue (Ptr<const Packet> p, uint16_t protocolNumber) const;
+
+  /**
+   * \brief Dequeue the next packet chosen by the scheduler
+   * \return packet, or 0 if all queues are empty
+   */
+  Ptr<Packet> DequeueNext (void);
+
+  /**
+   * \brief Get the destination of a framed packet
+   * \param p packet with a frame header
+   * \return destination address
+   */
+  Mac48Address GetDestination (Ptr<const Packet> p) const;
+
+  /**
+   * \brief Receive every frame of a burst
+   * \param burst packet with a MockBurstTag
+   * \param burstTag tag of the burst
+   * \param senderDevice sender
+   * \param rxPower RX power excluding receiver gain and loss
+   */
+  void ReceiveBurst (Ptr<const Packet> burst,
+                     const MockBurstTag &burstTag,
+                     Ptr<MockNetDevice> senderDevice,
+                     double rxPower);
+
   /**
    * Stop Sending a Packet Down the Wire and Begin the Interframe Gap.
    *
    * The TransmitComplete method is used internally to finish the process
-   * of sending a packet out on the channel.
+   * of sending a packet out on the channel. The next packet is sent to the
+   * destination in its frame header.
    */
-  void TransmitComplete (const Address &dest);
+  void TransmitComplete (void);
 
   /**
    * \brief Make the link up and running
@@ -358,6 +519,24 @@ private:
    */
   Ptr<Queue<Packet> > m_queue;
 
+  /**
+   * All transmit queues if there are several of them, the first one being
+   * m_queue. Empty if the device has a single queue.
+   */
+  std::vector<Ptr<Queue<Packet> > > m_queues;
+
+  /// Selects the queue to serve next if there are several queues
+  Ptr<MockTxScheduler> m_scheduler;
+
+  /// Selects the queue of a packet, SelectQueue if null
+  QueueSelectorCallback m_queueSelector;
+
+  /// Neighbours whose ARP requests are answered locally
+  Ptr<MockArpTable> m_arpTable;
+
+  /// Queue of the packet that is being transmitted
+  uint32_t m_currentQueue;
+
   /**
    * Error model for receive packet events
    */
@@ -500,6 +679,33 @@ private:
    */
   uint32_t m_channelDevId;
 
+  /**
+   * \brief Framing of the packets
+   *
+   * All devices on a channel must use the same framing.
+   */
+  FramingMode m_framingMode;
+
+  /**
+   * \brief Whether the FCS of Ethernet frames is computed and checked
+   *
+   * Copy of Node::ChecksumEnabled (), which looks up a global value, taken
+   * at initialization.
+   */
+  bool m_checksumEnabled;
+
+  /// Whether the trace sources are fired
+  bool m_tracing;
+
+  /// Maximum number of frames in a burst, 1 if frames are sent one by one
+  uint32_t m_maxBurstPackets;
+
+  /// Maximum size of a burst in bytes, 0 for no limit
+  uint32_t m_maxBurstBytes;
+
+  /// Frames of the burst that is being transmitted
+  std::vector<Ptr<Packet> > m_burst;
+
   Ptr<Packet> m_currentPkt; //!< Current packet processed
 };
 
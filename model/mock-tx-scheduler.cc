@@ -0,0 +1,181 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tim Schubert <ns-3-leo@timschubert.net>
+ */
+
+#include "ns3/log.h"
+#include "ns3/queue.h"
+#include "ns3/uinteger.h"
+#include "mock-tx-scheduler.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MockTxScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (MockTxScheduler);
+
+TypeId
+MockTxScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MockTxScheduler")
+    .SetParent<Object> ()
+    .SetGroupName ("Leo")
+  ;
+  return tid;
+}
+
+MockTxScheduler::MockTxScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MockTxScheduler::~MockTxScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MockTxScheduler::NotifyDequeue (uint32_t queue, uint32_t bytes)
+{
+}
+
+NS_OBJECT_ENSURE_REGISTERED (MockStrictPriorityTxScheduler);
+
+TypeId
+MockStrictPriorityTxScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MockStrictPriorityTxScheduler")
+    .SetParent<MockTxScheduler> ()
+    .SetGroupName ("Leo")
+    .AddConstructor<MockStrictPriorityTxScheduler> ()
+  ;
+  return tid;
+}
+
+MockStrictPriorityTxScheduler::MockStrictPriorityTxScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MockStrictPriorityTxScheduler::~MockStrictPriorityTxScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+uint32_t
+MockStrictPriorityTxScheduler::Select (const std::vector<Ptr<Queue<Packet> > > &queues)
+{
+  uint32_t i = 0;
+  while (i < queues.size () && queues[i]->IsEmpty ())
+    {
+      i ++;
+    }
+  return i;
+}
+
+NS_OBJECT_ENSURE_REGISTERED (MockDrrTxScheduler);
+
+TypeId
+MockDrrTxScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MockDrrTxScheduler")
+    .SetParent<MockTxScheduler> ()
+    .SetGroupName ("Leo")
+    .AddConstructor<MockDrrTxScheduler> ()
+    .AddAttribute ("Quantum",
+                   "Number of bytes a queue may send per round",
+                   UintegerValue (1514),
+                   MakeUintegerAccessor (&MockDrrTxScheduler::m_quantum),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+MockDrrTxScheduler::MockDrrTxScheduler ()
+  : m_current (0),
+    m_newTurn (true)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+MockDrrTxScheduler::~MockDrrTxScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MockDrrTxScheduler::Next (void)
+{
+  m_current = (m_current + 1) % m_deficits.size ();
+  m_newTurn = true;
+}
+
+uint32_t
+MockDrrTxScheduler::Select (const std::vector<Ptr<Queue<Packet> > > &queues)
+{
+  uint32_t n = queues.size ();
+  bool empty = true;
+  for (uint32_t i = 0; i < n && empty; i ++)
+    {
+      empty = queues[i]->IsEmpty ();
+    }
+  if (empty)
+    {
+      return n;
+    }
+  if (m_deficits.size () != n)
+    {
+      m_deficits.assign (n, 0);
+      m_current = 0;
+      m_newTurn = true;
+    }
+
+  // terminates because every non-empty queue gains a quantum per round
+  while (true)
+    {
+      Ptr<const Packet> head = queues[m_current]->Peek ();
+      if (head == 0)
+        {
+          // idle queues do not accumulate credit
+          m_deficits[m_current] = 0;
+          Next ();
+          continue;
+        }
+      if (m_newTurn)
+        {
+          m_deficits[m_current] += m_quantum;
+          m_newTurn = false;
+        }
+      if (head->GetSize () <= m_deficits[m_current])
+        {
+          m_deficits[m_current] -= head->GetSize ();
+          NS_LOG_LOGIC ("queue " << m_current << " deficit " << m_deficits[m_current]);
+          return m_current;
+        }
+      Next ();
+    }
+}
+
+void
+MockDrrTxScheduler::NotifyDequeue (uint32_t queue, uint32_t bytes)
+{
+  if (queue < m_deficits.size ())
+    {
+      m_deficits[queue] -= bytes;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,145 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tim Schubert <ns-3-leo@timschubert.net>
+ */
+
+#ifndef MOCK_TX_SCHEDULER_H
+#define MOCK_TX_SCHEDULER_H
+
+#include <vector>
+#include <stdint.h>
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/packet.h"
+
+/**
+ * \file
+ * \ingroup leo
+ *
+ * Declaration of MockTxScheduler, MockStrictPriorityTxScheduler and
+ * MockDrrTxScheduler
+ */
+
+namespace ns3 {
+
+template <typename Item> class Queue;
+
+/**
+ * \ingroup leo
+ * \brief Selects the transmit queue of a MockNetDevice to be served next
+ */
+class MockTxScheduler : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /// constructor
+  MockTxScheduler ();
+  /// destructor
+  virtual ~MockTxScheduler ();
+
+  /**
+   * \brief Select the queue to send the next packet from
+   *
+   * The caller dequeues the head of the selected queue.
+   *
+   * \param queues transmit queues of the device
+   * \return index of the selected queue, or queues.size () if all queues
+   * are empty
+   */
+  virtual uint32_t Select (const std::vector<Ptr<Queue<Packet> > > &queues) = 0;
+
+  /**
+   * \brief Notify the scheduler of a packet dequeued without Select
+   *
+   * Called for the frames that are added to a burst.
+   *
+   * \param queue index of the queue
+   * \param bytes size of the packet
+   */
+  virtual void NotifyDequeue (uint32_t queue, uint32_t bytes);
+};
+
+/**
+ * \ingroup leo
+ * \brief Always serves the non-empty queue with the lowest index
+ */
+class MockStrictPriorityTxScheduler : public MockTxScheduler
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /// constructor
+  MockStrictPriorityTxScheduler ();
+  /// destructor
+  virtual ~MockStrictPriorityTxScheduler ();
+
+  virtual uint32_t Select (const std::vector<Ptr<Queue<Packet> > > &queues);
+};
+
+/**
+ * \ingroup leo
+ * \brief Deficit round robin over the transmit queues
+ *
+ * Each queue may send up to Quantum bytes per round, so that bulk traffic
+ * in one queue cannot starve the others.
+ */
+class MockDrrTxScheduler : public MockTxScheduler
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  /// constructor
+  MockDrrTxScheduler ();
+  /// destructor
+  virtual ~MockDrrTxScheduler ();
+
+  virtual uint32_t Select (const std::vector<Ptr<Queue<Packet> > > &queues);
+  virtual void NotifyDequeue (uint32_t queue, uint32_t bytes);
+
+private:
+  /// Advance to the next queue, which starts a new turn
+  void Next (void);
+
+  /// Bytes added to the deficit of a queue at the start of its turn
+  uint32_t m_quantum;
+
+  /// Deficit of each queue
+  std::vector<int64_t> m_deficits;
+
+  /// Queue whose turn it is
+  uint32_t m_current;
+
+  /// Whether the current queue has not yet received its quantum
+  bool m_newTurn;
+};
+
+} // namespace ns3
+
+#endif /* MOCK_TX_SCHEDULER_H */
@@ -16,6 +16,9 @@
  * Author: Tim Schubert <ns-3-leo@timschubert.net>
  */
 
+#include <map>
+#include <set>
+
 #include "ns3/core-module.h"
 #include "ns3/network-module.h"
 #include "ns3/internet-module.h"
@@ -100,6 +103,791 @@ private:
   }
 };
 
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Unit tests
+ */
+class IslMockChannelDeviceIdTestCase : public TestCase
+{
+public:
+  IslMockChannelDeviceIdTestCase () : TestCase ("devices are found by their address") {}
+  virtual ~IslMockChannelDeviceIdTestCase () {}
+private:
+  virtual void DoRun (void)
+  {
+    Ptr<IslMockChannel> channel = CreateObject<IslMockChannel> ();
+
+    std::vector<Ptr<MockNetDevice> > devs;
+    for (size_t i = 0; i < 10; i ++)
+      {
+        Ptr<MockNetDevice> dev = CreateObject<MockNetDevice> ();
+        dev->SetNode (CreateObject<Node> ());
+        dev->SetAddress (Mac48Address::Allocate ());
+        dev->Attach (channel);
+        devs.push_back (dev);
+      }
+
+    for (size_t i = 0; i < devs.size (); i ++)
+      {
+        NS_TEST_EXPECT_MSG_EQ (channel->GetDeviceId (devs[i]->GetAddress ()), (int32_t) i, "device not found by address");
+      }
+    NS_TEST_EXPECT_MSG_EQ (channel->GetDeviceId (Mac48Address::Allocate ()), -1, "unknown address found");
+    NS_TEST_EXPECT_MSG_EQ (channel->GetDeviceId (Address ()), -1, "invalid address found");
+
+    channel->Detach (3);
+    NS_TEST_EXPECT_MSG_EQ (channel->GetDeviceId (devs[3]->GetAddress ()), -1, "detached device found");
+
+    Ptr<Packet> p = Create<Packet> ();
+    bool result = channel->TransmitStart (p, 0, devs[3]->GetAddress (), Time ());
+    NS_TEST_EXPECT_MSG_EQ (result, false, "transmission to detached device succeeded");
+    result = channel->TransmitStart (p, 0, devs[4]->GetAddress (), Time ());
+    NS_TEST_EXPECT_MSG_EQ (result, true, "transmission to attached device failed");
+
+    Simulator::Destroy ();
+  }
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Unit tests
+ */
+class IslMockChannelCopyOnWriteTestCase : public TestCase
+{
+public:
+  IslMockChannelCopyOnWriteTestCase () : TestCase ("broadcast with shared packets reaches every receiver"), m_received (0) {}
+  virtual ~IslMockChannelCopyOnWriteTestCase () {}
+private:
+  bool Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+  {
+    NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 100, "headers have not been removed");
+    NS_TEST_EXPECT_MSG_EQ (protocol, 0x0800, "wrong protocol");
+    m_received ++;
+    return true;
+  }
+
+  void CountCopies (uint64_t oldValue, uint64_t newValue)
+  {
+    m_copiesAvoided = newValue;
+  }
+
+  virtual void DoRun (void)
+  {
+    Ptr<IslMockChannel> channel = CreateObject<IslMockChannel> ();
+    channel->SetAttribute ("CopyOnWrite", BooleanValue (true));
+    channel->TraceConnectWithoutContext ("CopiesAvoided",
+                                         MakeCallback (&IslMockChannelCopyOnWriteTestCase::CountCopies, this));
+    m_copiesAvoided = 0;
+
+    const size_t n = 10;
+    for (size_t i = 0; i < n; i ++)
+      {
+        Ptr<MockNetDevice> dev = CreateObject<MockNetDevice> ();
+        dev->SetNode (CreateObject<Node> ());
+        dev->SetAddress (Mac48Address::Allocate ());
+        dev->SetReceiveCallback (MakeCallback (&IslMockChannelCopyOnWriteTestCase::Receive, this));
+        dev->Attach (channel);
+      }
+
+    Ptr<Packet> p = Create<Packet> (100);
+    EthernetHeader header (false);
+    header.SetSource (Mac48Address::ConvertFrom (channel->GetDevice (0)->GetAddress ()));
+    header.SetDestination (Mac48Address::GetBroadcast ());
+    header.SetLengthType (0x0800);
+    p->AddHeader (header);
+    EthernetTrailer trailer;
+    trailer.CalcFcs (p);
+    p->AddTrailer (trailer);
+
+    bool result = channel->TransmitStart (p, 0, Mac48Address::GetBroadcast (), Time ());
+    NS_TEST_ASSERT_MSG_EQ (result, true, "broadcast failed");
+
+    Simulator::Run ();
+
+    NS_TEST_EXPECT_MSG_EQ (m_received, n - 1, "not all receivers got the packet");
+    NS_TEST_EXPECT_MSG_EQ (m_copiesAvoided, n - 1, "channel copied the packet");
+
+    Simulator::Destroy ();
+  }
+
+  uint32_t m_received;
+  uint64_t m_copiesAvoided;
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Unit tests
+ */
+class IslMockChannelLinkCacheTestCase : public TestCase
+{
+public:
+  IslMockChannelLinkCacheTestCase () : TestCase ("link states are cached until a device moves") {}
+  virtual ~IslMockChannelLinkCacheTestCase () {}
+private:
+  void CountHits (uint64_t oldValue, uint64_t newValue)
+  {
+    m_hits = newValue;
+  }
+
+  void Receive (Ptr<const Packet> p)
+  {
+    m_arrivals.push_back (Simulator::Now ());
+  }
+
+  void Send (Ptr<IslMockChannel> channel, Address dst)
+  {
+    channel->TransmitStart (Create<Packet> (100), 0, dst, Time ());
+  }
+
+  virtual void DoRun (void)
+  {
+    Ptr<IslMockChannel> channel = CreateObject<IslMockChannel> ();
+    channel->SetAttribute ("LinkCacheSize", UintegerValue (16));
+    channel->SetAttribute ("PropagationLoss", PointerValue (CreateObject<IslPropagationLossModel> ()));
+    channel->SetAttribute ("PropagationDelay", PointerValue (CreateObject<ConstantSpeedPropagationDelayModel> ()));
+    channel->TraceConnectWithoutContext ("LinkCacheHits",
+                                         MakeCallback (&IslMockChannelLinkCacheTestCase::CountHits, this));
+    m_hits = 0;
+
+    std::vector<Ptr<ConstantPositionMobilityModel> > mobs;
+    std::vector<Ptr<MockNetDevice> > devs;
+    for (double x : { 7e6, 7.1e6 })
+      {
+        Ptr<Node> node = CreateObject<Node> ();
+        Ptr<ConstantPositionMobilityModel> mob = CreateObject<ConstantPositionMobilityModel> ();
+        mob->SetPosition (Vector (x, 0, 0));
+        node->AggregateObject (mob);
+        Ptr<MockNetDevice> dev = CreateObject<MockNetDevice> ();
+        dev->SetNode (node);
+        dev->SetAddress (Mac48Address::Allocate ());
+        dev->Attach (channel);
+        mobs.push_back (mob);
+        devs.push_back (dev);
+      }
+    devs[1]->TraceConnectWithoutContext ("PhyRxEnd", MakeCallback (&IslMockChannelLinkCacheTestCase::Receive, this));
+
+    Address dst = devs[1]->GetAddress ();
+    for (uint32_t i = 0; i < 5; i ++)
+      {
+        Simulator::Schedule (MilliSeconds (10 * i), &IslMockChannelLinkCacheTestCase::Send, this, channel, dst);
+      }
+    // moving the destination away invalidates the link
+    Simulator::Schedule (MilliSeconds (45), &ConstantPositionMobilityModel::SetPosition, mobs[1], Vector (7.4e6, 0, 0));
+    Simulator::Schedule (MilliSeconds (50), &IslMockChannelLinkCacheTestCase::Send, this, channel, dst);
+    Simulator::Schedule (MilliSeconds (60), &IslMockChannelLinkCacheTestCase::Send, this, channel, dst);
+    Simulator::Run ();
+
+    NS_TEST_EXPECT_MSG_EQ (m_hits, 5, "link state not cached");
+    NS_TEST_ASSERT_MSG_EQ (m_arrivals.size (), 7, "not all packets have been received");
+    Time near = m_arrivals[0] - MilliSeconds (0);
+    Time far = m_arrivals[5] - MilliSeconds (50);
+    NS_TEST_EXPECT_MSG_EQ (m_arrivals[4] - MilliSeconds (40), near, "cached delay differs");
+    NS_TEST_EXPECT_MSG_GT (far, near, "delay not updated after course change");
+    NS_TEST_EXPECT_MSG_EQ (m_arrivals[6] - MilliSeconds (60), far, "cached delay differs after course change");
+
+    Simulator::Destroy ();
+  }
+
+  uint64_t m_hits;
+  std::vector<Time> m_arrivals;
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Unit tests
+ */
+class IslMockChannelMaxRangeTestCase : public TestCase
+{
+public:
+  IslMockChannelMaxRangeTestCase () : TestCase ("broadcasts only reach devices within range") {}
+  virtual ~IslMockChannelMaxRangeTestCase () {}
+private:
+  void Receive (Ptr<const Packet> p)
+  {
+    m_received ++;
+  }
+
+  void Broadcast (Ptr<IslMockChannel> channel, uint32_t expected)
+  {
+    m_received = 0;
+    channel->TransmitStart (Create<Packet> (100), 0, Mac48Address::GetBroadcast (), Time ());
+    Simulator::Schedule (MilliSeconds (100), &IslMockChannelMaxRangeTestCase::Check, this, expected);
+  }
+
+  void Check (uint32_t expected)
+  {
+    NS_TEST_EXPECT_MSG_EQ (m_received, expected, "wrong number of receivers at " << Simulator::Now ());
+  }
+
+  virtual void DoRun (void)
+  {
+    Ptr<IslMockChannel> channel = CreateObject<IslMockChannel> ();
+    channel->SetAttribute ("MaxRange", DoubleValue (500e3));
+    channel->SetAttribute ("NeighbourInterval", TimeValue (Seconds (1)));
+    channel->SetAttribute ("PropagationLoss", PointerValue (CreateObject<IslPropagationLossModel> ()));
+    channel->SetAttribute ("PropagationDelay", PointerValue (CreateObject<ConstantSpeedPropagationDelayModel> ()));
+
+    std::vector<Ptr<ConstantPositionMobilityModel> > mobs;
+    std::vector<Ptr<MockNetDevice> > devs;
+    for (double y : { 0.0, 1e5, 3e5, 1e6 })
+      {
+        Ptr<Node> node = CreateObject<Node> ();
+        Ptr<ConstantPositionMobilityModel> mob = CreateObject<ConstantPositionMobilityModel> ();
+        mob->SetPosition (Vector (7e6, y, 0));
+        node->AggregateObject (mob);
+        Ptr<MockNetDevice> dev = CreateObject<MockNetDevice> ();
+        dev->SetNode (node);
+        dev->SetAddress (Mac48Address::Allocate ());
+        dev->Attach (channel);
+        dev->TraceConnectWithoutContext ("PhyRxEnd", MakeCallback (&IslMockChannelMaxRangeTestCase::Receive, this));
+        mobs.push_back (mob);
+        devs.push_back (dev);
+      }
+
+    bool result = channel->TransmitStart (Create<Packet> (100), 0, devs[3]->GetAddress (), Time ());
+    NS_TEST_EXPECT_MSG_EQ (result, false, "delivered beyond range");
+
+    Simulator::Schedule (Seconds (0.1), &IslMockChannelMaxRangeTestCase::Broadcast, this, channel, 2);
+    // the neighbour sets are refreshed in the next interval
+    Simulator::Schedule (Seconds (1.5), &ConstantPositionMobilityModel::SetPosition, mobs[3], Vector (7e6, 2e5, 0));
+    Simulator::Schedule (Seconds (2.1), &IslMockChannelMaxRangeTestCase::Broadcast, this, channel, 3);
+    Simulator::Run ();
+    Simulator::Destroy ();
+  }
+
+  uint32_t m_received;
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Unit tests
+ */
+class IslMockChannelDeliveryCountersTestCase : public TestCase
+{
+public:
+  IslMockChannelDeliveryCountersTestCase () : TestCase ("deliveries are counted and traced"), m_traced (0), m_tracedDelivered (0) {}
+  virtual ~IslMockChannelDeliveryCountersTestCase () {}
+private:
+  void DeliveryAttempt (Ptr<const MockNetDevice> src, Ptr<const MockNetDevice> dst, double rxPower, bool delivered)
+  {
+    m_traced ++;
+    m_tracedDelivered += delivered;
+  }
+
+  virtual void DoRun (void)
+  {
+    Ptr<IslMockChannel> channel = CreateObject<IslMockChannel> ();
+    channel->SetAttribute ("PropagationLoss", PointerValue (CreateObject<IslPropagationLossModel> ()));
+    channel->SetAttribute ("PropagationDelay", PointerValue (CreateObject<ConstantSpeedPropagationDelayModel> ()));
+    channel->TraceConnectWithoutContext ("DeliveryAttempt",
+                                         MakeCallback (&IslMockChannelDeliveryCountersTestCase::DeliveryAttempt, this));
+
+    std::vector<Ptr<MockNetDevice> > devs;
+    // the last satellite is behind earth
+    for (Vector pos : { Vector (7e6, 0, 0), Vector (7e6, 1e5, 0), Vector (-7e6, 0, 0) })
+      {
+        Ptr<Node> node = CreateObject<Node> ();
+        Ptr<ConstantPositionMobilityModel> mob = CreateObject<ConstantPositionMobilityModel> ();
+        mob->SetPosition (pos);
+        node->AggregateObject (mob);
+        Ptr<MockNetDevice> dev = CreateObject<MockNetDevice> ();
+        dev->SetNode (node);
+        dev->SetAddress (Mac48Address::Allocate ());
+        dev->Attach (channel);
+        devs.push_back (dev);
+      }
+
+    channel->TransmitStart (Create<Packet> (100), 0, devs[1]->GetAddress (), Time ());
+    channel->TransmitStart (Create<Packet> (100), 0, devs[2]->GetAddress (), Time ());
+    Simulator::Run ();
+
+    UintegerValue attempted, unreachable, succeeded;
+    channel->GetAttribute ("DeliveriesAttempted", attempted);
+    channel->GetAttribute ("DeliveriesUnreachable", unreachable);
+    channel->GetAttribute ("DeliveriesSucceeded", succeeded);
+    NS_TEST_EXPECT_MSG_EQ (attempted.Get (), 2, "wrong number of attempted deliveries");
+    NS_TEST_EXPECT_MSG_EQ (unreachable.Get (), 1, "wrong number of unreachable receivers");
+    NS_TEST_EXPECT_MSG_EQ (succeeded.Get (), 1, "wrong number of deliveries");
+    NS_TEST_EXPECT_MSG_EQ (channel->GetDeliveryCounters (MockChannel::OTHER).attempted, 2, "deliveries counted for wrong receiver type");
+    NS_TEST_EXPECT_MSG_EQ (channel->GetDeliveryCounters (MockChannel::SATELLITE).attempted, 0, "deliveries counted for wrong receiver type");
+    NS_TEST_EXPECT_MSG_EQ (m_traced, 2, "delivery attempts not traced");
+    NS_TEST_EXPECT_MSG_EQ (m_tracedDelivered, 1, "deliveries not traced");
+
+    channel->ResetDeliveryCounters ();
+    NS_TEST_EXPECT_MSG_EQ (channel->GetDeliveryCounters ().attempted, 0, "counters not reset");
+
+    // the satellite behind earth is skipped by the line-of-sight check
+    channel->TransmitStart (Create<Packet> (100), 0, Mac48Address::GetBroadcast (), Time ());
+    Simulator::Run ();
+    MockChannel::DeliveryCounters counters = channel->GetDeliveryCounters ();
+    NS_TEST_EXPECT_MSG_EQ (counters.attempted, 2, "skipped receiver not counted");
+    NS_TEST_EXPECT_MSG_EQ (counters.unreachable, 1, "skipped receiver not counted as unreachable");
+    NS_TEST_EXPECT_MSG_EQ (counters.filtered, 1, "skipped receiver not counted as filtered");
+    NS_TEST_EXPECT_MSG_EQ (counters.delivered, 1, "wrong number of deliveries");
+    NS_TEST_EXPECT_MSG_EQ (m_traced, 3, "skipped receiver traced");
+
+    Simulator::Destroy ();
+  }
+
+  uint32_t m_traced;
+  uint32_t m_tracedDelivered;
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Unit tests
+ */
+class IslMockChannelMinimalFramingTestCase : public TestCase
+{
+public:
+  IslMockChannelMinimalFramingTestCase () : TestCase ("minimal frames carry addresses and protocol without padding"), m_received (0), m_frameSize (0) {}
+  virtual ~IslMockChannelMinimalFramingTestCase () {}
+private:
+  bool Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+  {
+    NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 10, "header has not been removed");
+    NS_TEST_EXPECT_MSG_EQ (protocol, 0x0800, "wrong protocol");
+    NS_TEST_EXPECT_MSG_EQ (from, m_source, "wrong source");
+    m_received ++;
+    return true;
+  }
+
+  void Sniff (Ptr<const Packet> p)
+  {
+    m_frameSize = p->GetSize ();
+  }
+
+  virtual void DoRun (void)
+  {
+    Ptr<IslMockChannel> channel = CreateObject<IslMockChannel> ();
+
+    std::vector<Ptr<MockNetDevice> > devs;
+    for (uint32_t i = 0; i < 2; i ++)
+      {
+        Ptr<MockNetDevice> dev = CreateObject<MockNetDevice> ();
+        dev->SetAttribute ("FramingMode", StringValue ("Minimal"));
+        dev->SetNode (CreateObject<Node> ());
+        dev->SetAddress (Mac48Address::Allocate ());
+        dev->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+        dev->SetReceiveCallback (MakeCallback (&IslMockChannelMinimalFramingTestCase::Receive, this));
+        dev->Attach (channel);
+        devs.push_back (dev);
+      }
+    m_source = devs[0]->GetAddress ();
+    devs[0]->TraceConnectWithoutContext ("Sniffer", MakeCallback (&IslMockChannelMinimalFramingTestCase::Sniff, this));
+
+    bool result = devs[0]->Send (Create<Packet> (10), devs[1]->GetAddress (), 0x0800);
+    NS_TEST_ASSERT_MSG_EQ (result, true, "send failed");
+    Simulator::Run ();
+
+    NS_TEST_EXPECT_MSG_EQ (m_frameSize, 10 + MockFrameHeader ().GetSerializedSize (), "frame has been padded");
+    NS_TEST_EXPECT_MSG_EQ (m_received, 1, "packet not received");
+
+    Simulator::Destroy ();
+  }
+
+  uint32_t m_received;
+  uint32_t m_frameSize;
+  Address m_source;
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Unit tests
+ */
+class IslMockChannelErrorModelFramingTestCase : public TestCase
+{
+public:
+  IslMockChannelErrorModelFramingTestCase () : TestCase ("frames checked by an error model lose header and trailer"), m_received (0) {}
+  virtual ~IslMockChannelErrorModelFramingTestCase () {}
+private:
+  bool Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+  {
+    NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 100, "header or trailer has not been removed");
+    NS_TEST_EXPECT_MSG_EQ (protocol, 0x0800, "wrong protocol");
+    m_received ++;
+    return true;
+  }
+
+  virtual void DoRun (void)
+  {
+    Ptr<IslMockChannel> channel = CreateObject<IslMockChannel> ();
+
+    std::vector<Ptr<MockNetDevice> > devs;
+    for (uint32_t i = 0; i < 2; i ++)
+      {
+        Ptr<RateErrorModel> em = CreateObject<RateErrorModel> ();
+        em->SetAttribute ("ErrorRate", DoubleValue (0.0));
+        Ptr<MockNetDevice> dev = CreateObject<MockNetDevice> ();
+        dev->SetAttribute ("ReceiveErrorModel", PointerValue (em));
+        dev->SetNode (CreateObject<Node> ());
+        dev->SetAddress (Mac48Address::Allocate ());
+        dev->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+        dev->SetReceiveCallback (MakeCallback (&IslMockChannelErrorModelFramingTestCase::Receive, this));
+        dev->Attach (channel);
+        devs.push_back (dev);
+      }
+
+    bool result = devs[0]->Send (Create<Packet> (100), devs[1]->GetAddress (), 0x0800);
+    NS_TEST_ASSERT_MSG_EQ (result, true, "send failed");
+    Simulator::Run ();
+
+    NS_TEST_EXPECT_MSG_EQ (m_received, 1, "packet not received");
+
+    Simulator::Destroy ();
+  }
+
+  uint32_t m_received;
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Unit tests
+ */
+class IslMockChannelBurstTestCase : public TestCase
+{
+public:
+  IslMockChannelBurstTestCase () : TestCase ("queued frames are sent in bursts to their own destinations"), m_attempts (0), m_frameBytes (0), m_burstBytes (0) {}
+  virtual ~IslMockChannelBurstTestCase () {}
+private:
+  bool Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+  {
+    m_received[dev].push_back (p->GetSize ());
+    FlowIdTag tag;
+    NS_TEST_EXPECT_MSG_EQ (p->PeekPacketTag (tag), true, "packet tag of the frame has been lost");
+    NS_TEST_EXPECT_MSG_EQ (tag.GetFlowId (), p->GetSize (), "frame has the packet tag of another frame");
+    return true;
+  }
+
+  void DeliveryAttempt (Ptr<const MockNetDevice> src, Ptr<const MockNetDevice> dst, double rxPower, bool delivered)
+  {
+    m_attempts ++;
+  }
+
+  void TxBegin (Ptr<const Packet> p)
+  {
+    m_frameBytes += p->GetSize ();
+  }
+
+  void Transmitted (Ptr<const Packet> p, Ptr<NetDevice> src, Ptr<NetDevice> dst, Time txTime, Time delay)
+  {
+    m_burstBytes += p->GetSize ();
+  }
+
+  void Send (Ptr<MockNetDevice> src, Ptr<MockNetDevice> dst, uint32_t size)
+  {
+    Ptr<Packet> p = Create<Packet> (size);
+    p->AddPacketTag (FlowIdTag (size));
+    src->Send (p, dst->GetAddress (), 0x0800);
+  }
+
+  virtual void DoRun (void)
+  {
+    Ptr<IslMockChannel> channel = CreateObject<IslMockChannel> ();
+    channel->TraceConnectWithoutContext ("DeliveryAttempt",
+                                         MakeCallback (&IslMockChannelBurstTestCase::DeliveryAttempt, this));
+    channel->TraceConnectWithoutContext ("TxRxMockChannel",
+                                         MakeCallback (&IslMockChannelBurstTestCase::Transmitted, this));
+
+    std::vector<Ptr<MockNetDevice> > devs;
+    for (uint32_t i = 0; i < 3; i ++)
+      {
+        Ptr<MockNetDevice> dev = CreateObject<MockNetDevice> ();
+        dev->SetAttribute ("MaxBurstPackets", UintegerValue (4));
+        dev->SetNode (CreateObject<Node> ());
+        dev->SetAddress (Mac48Address::Allocate ());
+        dev->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+        dev->SetReceiveCallback (MakeCallback (&IslMockChannelBurstTestCase::Receive, this));
+        dev->Attach (channel);
+        devs.push_back (dev);
+      }
+
+    devs[0]->TraceConnectWithoutContext ("PhyTxBegin", MakeCallback (&IslMockChannelBurstTestCase::TxBegin, this));
+
+    // the first frame is sent right away, the others are queued behind it
+    Send (devs[0], devs[1], 100);
+    for (uint32_t i = 0; i < 6; i ++)
+      {
+        Send (devs[0], devs[1], 101 + i);
+      }
+    for (uint32_t i = 0; i < 2; i ++)
+      {
+        Send (devs[0], devs[2], 200 + i);
+      }
+    Simulator::Run ();
+
+    // 100 | 101-104 | 105-106 | 200-201
+    NS_TEST_EXPECT_MSG_EQ (m_attempts, 4, "frames have not been aggregated");
+    NS_TEST_EXPECT_MSG_EQ (m_burstBytes, m_frameBytes, "bursts take longer to transmit than their frames");
+    NS_TEST_ASSERT_MSG_EQ (m_received[devs[1]].size (), 7, "wrong number of frames for the first destination");
+    NS_TEST_ASSERT_MSG_EQ (m_received[devs[2]].size (), 2, "wrong number of frames for the second destination");
+    for (uint32_t i = 0; i < 7; i ++)
+      {
+        NS_TEST_EXPECT_MSG_EQ (m_received[devs[1]][i], 100 + i, "frames reordered");
+      }
+    NS_TEST_EXPECT_MSG_EQ (m_received[devs[2]][0], 200, "frames reordered");
+    NS_TEST_EXPECT_MSG_EQ (m_received[devs[2]][1], 201, "frames reordered");
+
+    Simulator::Destroy ();
+  }
+
+  std::map<Ptr<NetDevice>, std::vector<uint32_t> > m_received;
+  uint32_t m_attempts;
+  uint32_t m_frameBytes;
+  uint32_t m_burstBytes;
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Unit tests
+ */
+class IslMockChannelTxSchedulerTestCase : public TestCase
+{
+public:
+  IslMockChannelTxSchedulerTestCase () : TestCase ("transmit queues are served by the scheduler") {}
+  virtual ~IslMockChannelTxSchedulerTestCase () {}
+private:
+  bool Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+  {
+    m_received.push_back (p->GetUid ());
+    return true;
+  }
+
+  /**
+   * Send three control and three bulk packets, the first control packet
+   * being sent right away
+   *
+   * \param scheduler scheduler of the sender
+   * \return UIDs of the packets in the order they have been sent
+   */
+  std::vector<uint64_t> Run (Ptr<MockTxScheduler> scheduler)
+  {
+    m_received.clear ();
+    Ptr<IslMockChannel> channel = CreateObject<IslMockChannel> ();
+
+    std::vector<Ptr<MockNetDevice> > devs;
+    for (uint32_t i = 0; i < 2; i ++)
+      {
+        Ptr<MockNetDevice> dev = CreateObject<MockNetDevice> ();
+        dev->SetNode (CreateObject<Node> ());
+        dev->SetAddress (Mac48Address::Allocate ());
+        std::vector<Ptr<Queue<Packet> > > queues;
+        queues.push_back (CreateObject<DropTailQueue<Packet> > ());
+        queues.push_back (CreateObject<DropTailQueue<Packet> > ());
+        dev->SetQueues (queues);
+        dev->SetTxScheduler (scheduler);
+        dev->SetReceiveCallback (MakeCallback (&IslMockChannelTxSchedulerTestCase::Receive, this));
+        dev->Attach (channel);
+        devs.push_back (dev);
+      }
+
+    // ARP and high priority packets go to the first queue, the others to the second
+    std::vector<Ptr<Packet> > control;
+    std::vector<Ptr<Packet> > bulk;
+    for (uint32_t i = 0; i < 3; i ++)
+      {
+        control.push_back (Create<Packet> (100));
+        bulk.push_back (Create<Packet> (100));
+      }
+    SocketPriorityTag tag;
+    tag.SetPriority (6);
+    control[1]->AddPacketTag (tag);
+
+    devs[0]->Send (control[0], devs[1]->GetAddress (), 0x0806);
+    for (uint32_t i = 0; i < 3; i ++)
+      {
+        devs[0]->Send (bulk[i], devs[1]->GetAddress (), 0x0800);
+      }
+    devs[0]->Send (control[1], devs[1]->GetAddress (), 0x0800);
+    devs[0]->Send (control[2], devs[1]->GetAddress (), 0x0806);
+    Simulator::Run ();
+    Simulator::Destroy ();
+
+    std::vector<uint64_t> uids;
+    for (Ptr<Packet> p : control)
+      {
+        uids.push_back (p->GetUid ());
+      }
+    for (Ptr<Packet> p : bulk)
+      {
+        uids.push_back (p->GetUid ());
+      }
+    return uids;
+  }
+
+  virtual void DoRun (void)
+  {
+    // control packets overtake the queued bulk packets
+    std::vector<uint64_t> uids = Run (CreateObject<MockStrictPriorityTxScheduler> ());
+    NS_TEST_ASSERT_MSG_EQ (m_received.size (), 6, "packets lost");
+    for (uint32_t i = 0; i < 6; i ++)
+      {
+        NS_TEST_EXPECT_MSG_EQ (m_received[i], uids[i], "wrong order with strict priority");
+      }
+
+    // with equal frame sizes, the queues take turns
+    Ptr<MockDrrTxScheduler> drr = CreateObject<MockDrrTxScheduler> ();
+    drr->SetAttribute ("Quantum", UintegerValue (1));
+    uids = Run (drr);
+    NS_TEST_ASSERT_MSG_EQ (m_received.size (), 6, "packets lost");
+    for (uint32_t i = 0; i < 3; i ++)
+      {
+        NS_TEST_EXPECT_MSG_EQ (m_received[2 * i], uids[i], "wrong order with deficit round robin");
+        NS_TEST_EXPECT_MSG_EQ (m_received[2 * i + 1], uids[3 + i], "wrong order with deficit round robin");
+      }
+  }
+
+  std::vector<uint64_t> m_received;
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Unit tests
+ */
+class IslMockChannelNoTracingTestCase : public TestCase
+{
+public:
+  IslMockChannelNoTracingTestCase () : TestCase ("devices without tracing deliver packets but fire no traces"), m_received (0), m_traced (0) {}
+  virtual ~IslMockChannelNoTracingTestCase () {}
+private:
+  bool Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+  {
+    m_received ++;
+    return true;
+  }
+
+  void Trace (Ptr<const Packet> p)
+  {
+    m_traced ++;
+  }
+
+  virtual void DoRun (void)
+  {
+    Ptr<IslMockChannel> channel = CreateObject<IslMockChannel> ();
+
+    std::vector<Ptr<MockNetDevice> > devs;
+    for (uint32_t i = 0; i < 2; i ++)
+      {
+        Ptr<MockNetDevice> dev = CreateObject<MockNetDevice> ();
+        dev->SetAttribute ("EnableTracing", BooleanValue (false));
+        dev->SetNode (CreateObject<Node> ());
+        dev->SetAddress (Mac48Address::Allocate ());
+        dev->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+        dev->SetReceiveCallback (MakeCallback (&IslMockChannelNoTracingTestCase::Receive, this));
+        dev->Attach (channel);
+        for (std::string name : { "MacTx", "PhyTxBegin", "PhyTxEnd", "PhyRxEnd", "MacRx", "Sniffer", "PromiscSniffer" })
+          {
+            dev->TraceConnectWithoutContext (name, MakeCallback (&IslMockChannelNoTracingTestCase::Trace, this));
+          }
+        devs.push_back (dev);
+      }
+
+    for (uint32_t i = 0; i < 3; i ++)
+      {
+        devs[0]->Send (Create<Packet> (100), devs[1]->GetAddress (), 0x0800);
+      }
+    Simulator::Run ();
+    Simulator::Destroy ();
+
+    NS_TEST_EXPECT_MSG_EQ (m_received, 3, "packets have not been received");
+    NS_TEST_EXPECT_MSG_EQ (m_traced, 0, "traces have been fired");
+  }
+
+  uint32_t m_received;
+  uint32_t m_traced;
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Unit tests
+ */
+class IslHelperGridTestCase : public TestCase
+{
+public:
+  IslHelperGridTestCase () : TestCase ("+Grid connects each satellite to its four neighbors") {}
+  virtual ~IslHelperGridTestCase () {}
+private:
+  std::set<uint32_t> GetPeers (Ptr<Node> node)
+  {
+    std::set<uint32_t> peers;
+    for (uint32_t i = 0; i < node->GetNDevices (); i ++)
+      {
+        Ptr<Channel> channel = node->GetDevice (i)->GetChannel ();
+        NS_TEST_EXPECT_MSG_EQ (channel->GetNDevices (), 2, "link is not point-to-point");
+        for (uint32_t j = 0; j < channel->GetNDevices (); j ++)
+          {
+            uint32_t peer = channel->GetDevice (j)->GetNode ()->GetId ();
+            if (peer != node->GetId ())
+              {
+                peers.insert (peer);
+              }
+          }
+      }
+    return peers;
+  }
+
+  virtual void DoRun (void)
+  {
+    LeoOrbitNodeHelper orbit;
+    NodeContainer satellites = orbit.Install (LeoOrbit (550, 53, 4, 5));
+    uint32_t first = satellites.Get (0)->GetId ();
+
+    IslHelper isl;
+    NetDeviceContainer devices = isl.InstallGrid (satellites, 4, 5);
+    NS_TEST_ASSERT_MSG_EQ (devices.GetN (), 2 * 2 * 20, "not two links per satellite");
+    for (uint32_t i = 0; i < devices.GetN (); i += 2)
+      {
+        NS_TEST_EXPECT_MSG_EQ (devices.Get (i)->GetChannel (), devices.Get (i + 1)->GetChannel (),
+                               "devices of a link are not adjacent");
+      }
+
+    for (uint32_t i = 0; i < satellites.GetN (); i ++)
+      {
+        Ptr<Node> node = satellites.Get (i);
+        NS_TEST_EXPECT_MSG_EQ (node->GetNDevices (), 4, "not four laser terminals");
+        uint32_t p = i / 5;
+        uint32_t s = i % 5;
+        std::set<uint32_t> expected = { first + p * 5 + (s + 1) % 5,
+                                        first + p * 5 + (s + 4) % 5,
+                                        first + ((p + 1) % 4) * 5 + s,
+                                        first + ((p + 3) % 4) * 5 + s };
+        NS_TEST_EXPECT_MSG_EQ ((GetPeers (node) == expected), true, "wrong neighbors of satellite " << i);
+      }
+
+    // two planes are only connected once
+    NodeContainer small = orbit.Install (LeoOrbit (1200, 70, 2, 3));
+    devices = isl.InstallGrid (small, 2, 3);
+    NS_TEST_EXPECT_MSG_EQ (devices.GetN (), 2 * (2 * 3 + 3), "neighbors connected twice");
+    for (uint32_t i = 0; i < small.GetN (); i ++)
+      {
+        NS_TEST_EXPECT_MSG_EQ (small.Get (i)->GetNDevices (), 3, "wrong number of laser terminals");
+      }
+
+    Simulator::Destroy ();
+  }
+};
+
 /**
  * \ingroup leo-test
  * \ingroup tests
@@ -118,6 +906,17 @@ IslMockChannelTestSuite::IslMockChannelTestSuite ()
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new IslMockChannelTransmitUnknownTestCase, TestCase::QUICK);
   AddTestCase (new IslMockChannelTransmitKnownTestCase, TestCase::QUICK);
+  AddTestCase (new IslMockChannelDeviceIdTestCase, TestCase::QUICK);
+  AddTestCase (new IslMockChannelCopyOnWriteTestCase, TestCase::QUICK);
+  AddTestCase (new IslMockChannelLinkCacheTestCase, TestCase::QUICK);
+  AddTestCase (new IslMockChannelMaxRangeTestCase, TestCase::QUICK);
+  AddTestCase (new IslMockChannelDeliveryCountersTestCase, TestCase::QUICK);
+  AddTestCase (new IslMockChannelMinimalFramingTestCase, TestCase::QUICK);
+  AddTestCase (new IslMockChannelErrorModelFramingTestCase, TestCase::QUICK);
+  AddTestCase (new IslMockChannelBurstTestCase, TestCase::QUICK);
+  AddTestCase (new IslMockChannelTxSchedulerTestCase, TestCase::QUICK);
+  AddTestCase (new IslMockChannelNoTracingTestCase, TestCase::QUICK);
+  AddTestCase (new IslHelperGridTestCase, TestCase::QUICK);
   // TODO more test
 }
 
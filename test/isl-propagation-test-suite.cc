@@ -16,6 +16,9 @@
  * Author: Tim Schubert <ns-3-leo@timschubert.net>
  */
 
+#include <math.h>
+#include <vector>
+
 #include "ns3/core-module.h"
 #include "ns3/test.h"
 
@@ -77,6 +80,53 @@ private:
   }
 };
 
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Batch line-of-sight check agrees with the single check
+ */
+class IslPropagationBatchTestCase : public TestCase
+{
+public:
+  IslPropagationBatchTestCase () : TestCase ("batch line-of-sight matches single checks") {}
+  virtual ~IslPropagationBatchTestCase () {}
+private:
+  virtual void DoRun (void)
+  {
+    // odd number of positions at different altitudes, so that the remainder
+    // of the blocks is checked as well
+    uint32_t n = 1001;
+    std::vector<double> x, y, z;
+    for (uint32_t i = 0; i < n; i ++)
+      {
+        double radius = EARTH_RAD + (i % 5) * 500e3;
+        double v = 1.0 - (i + 0.5) * 2.0 / n;
+        double r = sqrt (1.0 - v*v);
+        double phi = 2.39996 * i;
+        x.push_back (cos (phi) * r * radius);
+        y.push_back (v * radius);
+        z.push_back (sin (phi) * r * radius);
+      }
+    // duplicate of the source, which has no line-of-sight
+    Vector src (x[500], y[500], z[500]);
+
+    std::vector<uint64_t> mask ((n + 63) / 64, ~(uint64_t) 0);
+    IslPropagationLossModel::GetLos (src, x.data (), y.data (), z.data (), n, mask.data ());
+
+    uint32_t visible = 0;
+    for (uint32_t i = 0; i < n; i ++)
+      {
+        bool los = IslPropagationLossModel::GetLos (src, Vector (x[i], y[i], z[i]));
+        bool batch = (mask[i / 64] >> (i % 64)) & 1;
+        NS_TEST_ASSERT_MSG_EQ (batch, los, "batch differs for position " << i);
+        visible += los;
+      }
+    NS_TEST_ASSERT_MSG_GT (visible, 0, "no position is visible");
+    NS_TEST_ASSERT_MSG_LT (visible, n - 1, "all positions are visible");
+  }
+};
+
 /**
  * \ingroup leo-test
  * \ingroup tests
@@ -95,6 +145,7 @@ IslPropagationTestSuite::IslPropagationTestSuite ()
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new IslPropagationAngleTestCase1, TestCase::QUICK);
   AddTestCase (new IslPropagationAngleTestCase2, TestCase::QUICK);
+  AddTestCase (new IslPropagationBatchTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -0,0 +1,290 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tim Schubert <ns-3-leo@timschubert.net>
+ */
+
+#include <algorithm>
+#include <math.h>
+
+#include "ns3/core-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/leo-module.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup leo
+ * \defgroup leo-test LEO module tests
+ */
+
+namespace {
+
+/**
+ * \brief Ground stations and satellites for the contact plan tests
+ */
+struct Constellation
+{
+  /// Mobility models by id
+  std::vector<Ptr<MobilityModel> > mobility;
+  /// Ids of the ground stations
+  std::vector<uint32_t> ground;
+  /// Ids of the satellites
+  std::vector<uint32_t> satellites;
+  /// Range of the satellites by id
+  std::vector<double> range;
+};
+
+/**
+ * \brief Create a small constellation
+ * \return constellation
+ */
+Constellation
+CreateConstellation (void)
+{
+  Constellation c;
+  Ptr<LeoPropagationLossModel> loss = CreateObject<LeoPropagationLossModel> ();
+
+  for (double lat : { 0.0, 0.5, -0.5 })
+    {
+      Ptr<ConstantPositionMobilityModel> mob = CreateObject<ConstantPositionMobilityModel> ();
+      mob->SetPosition (Vector (LEO_PROP_EARTH_RAD * cos (lat), 0, LEO_PROP_EARTH_RAD * sin (lat)));
+      c.ground.push_back (c.mobility.size ());
+      c.mobility.push_back (mob);
+      c.range.push_back (-1.0);
+    }
+
+  for (uint32_t plane = 0; plane < 4; plane ++)
+    {
+      for (uint32_t sat = 0; sat < 6; sat ++)
+        {
+          Ptr<LeoCircularOrbitMobilityModel> mob = CreateObject<LeoCircularOrbitMobilityModel> ();
+          mob->SetAttribute ("Altitude", DoubleValue (550.0));
+          mob->SetAttribute ("Inclination", DoubleValue (53.0));
+          mob->SetPosition (Vector (2 * M_PI * plane / 4.0, 2 * M_PI * sat / 6.0, 0));
+          c.satellites.push_back (c.mobility.size ());
+          c.mobility.push_back (mob);
+          c.range.push_back (loss->GetCutoffDistance (mob->GetPosition ().GetLength ()));
+        }
+    }
+
+  return c;
+}
+
+/**
+ * \brief Check if a ground station can reach a satellite
+ * \param c constellation
+ * \return visibility function
+ */
+LeoContactPlan::VisibilityFunction
+GetVisibility (const Constellation &c)
+{
+  std::vector<double> range = c.range;
+  return [range] (uint32_t gnd, const Vector &gndPos, uint32_t sat, const Vector &satPos)
+    {
+      return CalculateDistance (gndPos, satPos) <= range[sat];
+    };
+}
+
+} // namespace
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Unit tests
+ */
+class LeoContactPlanVisibilityTestCase : public TestCase
+{
+public:
+  LeoContactPlanVisibilityTestCase () : TestCase ("contact plan reports every visible satellite") {}
+  virtual ~LeoContactPlanVisibilityTestCase () {}
+private:
+  virtual void DoRun (void)
+  {
+    Constellation c = CreateConstellation ();
+    LeoContactPlan::VisibilityFunction visible = GetVisibility (c);
+
+    Ptr<LeoContactPlan> plan = CreateObject<LeoContactPlan> ();
+    plan->SetAttribute ("Duration", TimeValue (Hours (2)));
+    plan->SetAttribute ("Interval", TimeValue (Seconds (10)));
+    plan->Compute (c.mobility, c.ground, c.satellites, visible, "test");
+    NS_TEST_ASSERT_MSG_EQ (plan->IsComputed (), true, "plan has not been computed");
+
+    uint32_t contacts = 0;
+    for (Time t = Seconds (0); t < Hours (2) - Seconds (10); t += Seconds (3))
+      {
+        for (uint32_t gnd : c.ground)
+          {
+            std::vector<uint32_t> peers;
+            bool planned = plan->GetPeers (gnd, t, peers);
+            NS_TEST_ASSERT_MSG_EQ (planned, true, "plan does not cover ground station");
+            // contacts are guaranteed to be found if they have been sampled
+            Time before = Seconds (10 * floor (t.GetSeconds () / 10));
+            Time after = before + Seconds (10);
+            for (uint32_t sat : c.satellites)
+              {
+                Ptr<LeoCircularOrbitMobilityModel> orbit = DynamicCast<LeoCircularOrbitMobilityModel> (c.mobility[sat]);
+                Vector gndPos = c.mobility[gnd]->GetPosition ();
+                if (visible (gnd, gndPos, sat, orbit->GetPositionAt (before))
+                    || visible (gnd, gndPos, sat, orbit->GetPositionAt (after)))
+                  {
+                    contacts ++;
+                    bool found = std::find (peers.begin (), peers.end (), sat) != peers.end ();
+                    NS_TEST_EXPECT_MSG_EQ (found, true, "visible satellite " << sat << " missing at " << t);
+                  }
+              }
+          }
+      }
+    NS_TEST_EXPECT_MSG_GT (contacts, 0, "no satellite has been visible at all");
+
+    std::vector<uint32_t> peers;
+    NS_TEST_EXPECT_MSG_EQ (plan->GetPeers (c.ground[0], Hours (3), peers), false, "time outside of plan");
+
+    Simulator::Destroy ();
+  }
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Unit tests
+ */
+class LeoContactPlanThreadsTestCase : public TestCase
+{
+public:
+  LeoContactPlanThreadsTestCase () : TestCase ("contact plan does not depend on number of threads") {}
+  virtual ~LeoContactPlanThreadsTestCase () {}
+private:
+  virtual void DoRun (void)
+  {
+    Constellation c = CreateConstellation ();
+
+    // all pairs of satellites
+    LeoContactPlan::VisibilityFunction los = [] (uint32_t a, const Vector &aPos, uint32_t b, const Vector &bPos)
+      {
+        return IslPropagationLossModel::GetLos (aPos, bPos);
+      };
+
+    Ptr<LeoContactPlan> single = CreateObject<LeoContactPlan> ();
+    single->SetAttribute ("Threads", UintegerValue (1));
+    single->SetAttribute ("Duration", TimeValue (Minutes (30)));
+    single->Compute (c.mobility, c.satellites, c.satellites, los, "test");
+
+    Ptr<LeoContactPlan> multi = CreateObject<LeoContactPlan> ();
+    multi->SetAttribute ("Threads", UintegerValue (3));
+    multi->SetAttribute ("Duration", TimeValue (Minutes (30)));
+    multi->Compute (c.mobility, c.satellites, c.satellites, los, "test");
+
+    for (uint32_t sat : c.satellites)
+      {
+        const std::vector<LeoContactPlan::Contact> &a = single->GetContacts (sat);
+        const std::vector<LeoContactPlan::Contact> &b = multi->GetContacts (sat);
+        NS_TEST_ASSERT_MSG_EQ (a.size (), b.size (), "different number of contacts");
+        for (size_t i = 0; i < a.size (); i ++)
+          {
+            NS_TEST_EXPECT_MSG_EQ (a[i].peer, b[i].peer, "different peer");
+            NS_TEST_EXPECT_MSG_EQ (a[i].start, b[i].start, "different start");
+            NS_TEST_EXPECT_MSG_EQ (a[i].end, b[i].end, "different end");
+            NS_TEST_EXPECT_MSG_NE (a[i].peer, sat, "contact with itself");
+          }
+      }
+
+    Simulator::Destroy ();
+  }
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Unit tests
+ */
+class LeoContactPlanFileTestCase : public TestCase
+{
+public:
+  LeoContactPlanFileTestCase () : TestCase ("contact plan is reused from file for same constellation") {}
+  virtual ~LeoContactPlanFileTestCase () {}
+private:
+  virtual void DoRun (void)
+  {
+    Constellation c = CreateConstellation ();
+    std::string file = CreateTempDirFilename ("leo-contact-plan.bin");
+    LeoContactPlan::VisibilityFunction never = [] (uint32_t a, const Vector &aPos, uint32_t b, const Vector &bPos)
+      {
+        return false;
+      };
+
+    Ptr<LeoContactPlan> computed = CreateObject<LeoContactPlan> ();
+    computed->SetAttribute ("File", StringValue (file));
+    computed->Compute (c.mobility, c.ground, c.satellites, GetVisibility (c), "test");
+
+    // would not find any contacts if it had to compute them
+    Ptr<LeoContactPlan> loaded = CreateObject<LeoContactPlan> ();
+    loaded->SetAttribute ("File", StringValue (file));
+    loaded->Compute (c.mobility, c.ground, c.satellites, never, "test");
+
+    size_t total = 0;
+    for (uint32_t gnd : c.ground)
+      {
+        const std::vector<LeoContactPlan::Contact> &a = computed->GetContacts (gnd);
+        const std::vector<LeoContactPlan::Contact> &b = loaded->GetContacts (gnd);
+        NS_TEST_ASSERT_MSG_EQ (a.size (), b.size (), "plan has not been loaded");
+        for (size_t i = 0; i < a.size (); i ++)
+          {
+            NS_TEST_EXPECT_MSG_EQ (a[i].peer, b[i].peer, "different peer");
+            NS_TEST_EXPECT_MSG_EQ (a[i].start, b[i].start, "different start");
+            NS_TEST_EXPECT_MSG_EQ (a[i].end, b[i].end, "different end");
+          }
+        total += a.size ();
+      }
+    NS_TEST_EXPECT_MSG_GT (total, 0, "no contacts to compare");
+
+    // other parameters invalidate the file
+    Ptr<LeoContactPlan> recomputed = CreateObject<LeoContactPlan> ();
+    recomputed->SetAttribute ("File", StringValue (file));
+    recomputed->Compute (c.mobility, c.ground, c.satellites, never, "other");
+    for (uint32_t gnd : c.ground)
+      {
+        NS_TEST_EXPECT_MSG_EQ (recomputed->GetContacts (gnd).size (), 0, "plan for other parameters has been loaded");
+      }
+
+    Simulator::Destroy ();
+  }
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Unit tests
+ */
+class LeoContactPlanTestSuite : public TestSuite
+{
+public:
+  LeoContactPlanTestSuite ();
+};
+
+LeoContactPlanTestSuite::LeoContactPlanTestSuite ()
+  : TestSuite ("leo-contact-plan", UNIT)
+{
+  AddTestCase (new LeoContactPlanVisibilityTestCase, TestCase::QUICK);
+  AddTestCase (new LeoContactPlanThreadsTestCase, TestCase::QUICK);
+  AddTestCase (new LeoContactPlanFileTestCase, TestCase::QUICK);
+}
+
+static LeoContactPlanTestSuite leoContactPlanTestSuite;
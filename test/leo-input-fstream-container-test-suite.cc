@@ -16,6 +16,9 @@
  * Author: Tim Schubert <ns-3-leo@timschubert.net>
  */
 
+#include <fstream>
+
+#include "ns3/core-module.h"
 #include "ns3/leo-module.h"
 #include "ns3/test.h"
 
@@ -111,6 +114,237 @@ LeoWaypointSomeEntriesTestCase::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ ((i > 0), true, "Reading from non-empty stream succeeds");
 }
 
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Test that binary files yield the same waypoints as text files
+ */
+class LeoWaypointBinaryFileTestCase : public TestCase
+{
+public:
+  LeoWaypointBinaryFileTestCase ();
+  virtual ~LeoWaypointBinaryFileTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+LeoWaypointBinaryFileTestCase::LeoWaypointBinaryFileTestCase ()
+  : TestCase ("Test reading from binary file")
+{
+}
+
+LeoWaypointBinaryFileTestCase::~LeoWaypointBinaryFileTestCase ()
+{
+}
+
+void
+LeoWaypointBinaryFileTestCase::DoRun (void)
+{
+  std::string text = "contrib/leo/data/test/waypoints.txt";
+  std::string binary = CreateTempDirFilename ("waypoints.bin");
+  uint64_t n = LeoWaypointBinaryFile::Convert (text, binary);
+  NS_TEST_ASSERT_MSG_GT (n, 0, "Converted waypoints");
+  NS_TEST_ASSERT_MSG_EQ (LeoWaypointBinaryFile::IsBinary (binary), true, "Converted file is binary");
+  NS_TEST_ASSERT_MSG_EQ (LeoWaypointBinaryFile::IsBinary (text), false, "Text file is not binary");
+
+  Ptr<LeoWaypointInputFileStreamContainer> textContainer = CreateObject<LeoWaypointInputFileStreamContainer> ();
+  textContainer->SetFile (text);
+  Ptr<LeoWaypointInputFileStreamContainer> binaryContainer = CreateObject<LeoWaypointInputFileStreamContainer> ();
+  binaryContainer->SetFile (binary);
+
+  Waypoint expected;
+  Waypoint wp;
+  uint64_t i = 0;
+  while (textContainer->GetNextSample (expected))
+    {
+      NS_TEST_ASSERT_MSG_EQ (binaryContainer->GetNextSample (wp), true, "Binary file has waypoint " << i);
+      NS_TEST_ASSERT_MSG_EQ (wp.time, expected.time, "Same time of waypoint " << i);
+      NS_TEST_ASSERT_MSG_EQ (wp.position, expected.position, "Same position of waypoint " << i);
+      i ++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (binaryContainer->GetNextSample (wp), false, "No more waypoints in binary file");
+  NS_TEST_ASSERT_MSG_EQ (i, n, "All waypoints have been read");
+
+  // seeking back yields the same waypoint from both files
+  textContainer->SetLastTime (Seconds (100));
+  binaryContainer->SetLastTime (Seconds (100));
+  NS_TEST_ASSERT_MSG_EQ (textContainer->GetNextSample (expected), true, "Text file has waypoint after seek");
+  NS_TEST_ASSERT_MSG_EQ (binaryContainer->GetNextSample (wp), true, "Binary file has waypoint after seek");
+  NS_TEST_ASSERT_MSG_EQ (wp.time, expected.time, "Same time after seek");
+}
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Test seeking in text files with recorded and stored offsets
+ */
+class LeoWaypointIndexTestCase : public TestCase
+{
+public:
+  LeoWaypointIndexTestCase ();
+  virtual ~LeoWaypointIndexTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Seek to some points in time and compare the next waypoint
+   * \param container container to seek in
+   * \param waypoints all waypoints of the file
+   */
+  void Seek (Ptr<LeoWaypointInputFileStreamContainer> container, const std::vector<Waypoint> &waypoints);
+};
+
+LeoWaypointIndexTestCase::LeoWaypointIndexTestCase ()
+  : TestCase ("Test seeking in text file")
+{
+}
+
+LeoWaypointIndexTestCase::~LeoWaypointIndexTestCase ()
+{
+}
+
+void
+LeoWaypointIndexTestCase::Seek (Ptr<LeoWaypointInputFileStreamContainer> container, const std::vector<Waypoint> &waypoints)
+{
+  // forwards and backwards, before the first and between the recorded offsets
+  for (double t : { 5000.0, 100.0, 3000.5, 0.0, 6000.0, 1.0, 2000.0 })
+    {
+      container->SetLastTime (Seconds (t));
+      Waypoint wp;
+      NS_TEST_ASSERT_MSG_EQ (container->GetNextSample (wp), true, "Waypoint after " << t << "s");
+      uint32_t i = 0;
+      while (waypoints[i].time <= Seconds (t))
+        {
+          i ++;
+        }
+      NS_TEST_ASSERT_MSG_EQ (wp.time, waypoints[i].time, "First waypoint after " << t << "s");
+      NS_TEST_ASSERT_MSG_EQ (wp.position, waypoints[i].position, "Position of first waypoint after " << t << "s");
+      NS_TEST_ASSERT_MSG_EQ (container->GetNextSample (wp), true, "Second waypoint after " << t << "s");
+      NS_TEST_ASSERT_MSG_EQ (wp.time, waypoints[i + 1].time, "Second waypoint after " << t << "s");
+    }
+}
+
+void
+LeoWaypointIndexTestCase::DoRun (void)
+{
+  std::string path = CreateTempDirFilename ("waypoints.txt");
+  {
+    std::ifstream input ("contrib/leo/data/test/waypoints.txt");
+    std::ofstream output (path);
+    output << input.rdbuf ();
+  }
+
+  std::vector<Waypoint> waypoints;
+  Ptr<LeoWaypointInputFileStreamContainer> reference = CreateObject<LeoWaypointInputFileStreamContainer> ();
+  reference->SetFile (path);
+  Waypoint wp;
+  while (reference->GetNextSample (wp))
+    {
+      waypoints.push_back (wp);
+    }
+
+  // offsets are recorded on the way
+  Ptr<LeoWaypointInputFileStreamContainer> container =
+    CreateObjectWithAttributes<LeoWaypointInputFileStreamContainer> ("IndexInterval", UintegerValue (16),
+                                                                      "IndexFile", BooleanValue (true));
+  container->SetFile (path);
+  Seek (container, waypoints);
+
+  container->SetLastTime (Seconds (6000));
+  while (container->GetNextSample (wp))
+    {
+    }
+  NS_TEST_ASSERT_MSG_EQ (std::ifstream (path + ".idx").good (), true, "Index file has been written");
+
+  // all offsets are known
+  Seek (container, waypoints);
+
+  // offsets are loaded from the index file
+  Ptr<LeoWaypointInputFileStreamContainer> restarted =
+    CreateObjectWithAttributes<LeoWaypointInputFileStreamContainer> ("IndexInterval", UintegerValue (16),
+                                                                      "IndexFile", BooleanValue (true));
+  restarted->SetFile (path);
+  Seek (restarted, waypoints);
+}
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Test that suspended text files continue at the same waypoint
+ */
+class LeoWaypointSuspendTestCase : public TestCase
+{
+public:
+  LeoWaypointSuspendTestCase ();
+  virtual ~LeoWaypointSuspendTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+LeoWaypointSuspendTestCase::LeoWaypointSuspendTestCase ()
+  : TestCase ("Test suspending text file")
+{
+}
+
+LeoWaypointSuspendTestCase::~LeoWaypointSuspendTestCase ()
+{
+}
+
+void
+LeoWaypointSuspendTestCase::DoRun (void)
+{
+  std::string path = "contrib/leo/data/test/waypoints.txt";
+
+  std::vector<Waypoint> waypoints;
+  Ptr<LeoWaypointInputFileStreamContainer> reference = CreateObject<LeoWaypointInputFileStreamContainer> ();
+  reference->SetFile (path);
+  Waypoint wp;
+  while (reference->GetNextSample (wp))
+    {
+      waypoints.push_back (wp);
+    }
+
+  Ptr<LeoWaypointInputFileStreamContainer> container = CreateObject<LeoWaypointInputFileStreamContainer> ();
+  container->SetFile (path);
+  container->Suspend ();
+  for (uint32_t i = 0; i < waypoints.size (); i ++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (container->GetNextSample (wp), true, "Suspended file has waypoint " << i);
+      NS_TEST_ASSERT_MSG_EQ (wp.time, waypoints[i].time, "Same time of waypoint " << i);
+      NS_TEST_ASSERT_MSG_EQ (wp.position, waypoints[i].position, "Same position of waypoint " << i);
+      container->Suspend ();
+    }
+  NS_TEST_ASSERT_MSG_EQ (container->GetNextSample (wp), false, "No more waypoints in suspended file");
+  container->Suspend ();
+  NS_TEST_ASSERT_MSG_EQ (container->GetNextSample (wp), false, "No more waypoints after the end");
+
+  // seeking opens the file again
+  container->Suspend ();
+  container->SetLastTime (Seconds (100));
+  reference->SetLastTime (Seconds (100));
+  Waypoint expected;
+  NS_TEST_ASSERT_MSG_EQ (reference->GetNextSample (expected), true, "Waypoint after seek");
+  NS_TEST_ASSERT_MSG_EQ (container->GetNextSample (wp), true, "Suspended file has waypoint after seek");
+  NS_TEST_ASSERT_MSG_EQ (wp.time, expected.time, "Same time after seek");
+
+  // more streams than the usual limit of open files
+  std::vector<Ptr<LeoWaypointInputFileStreamContainer> > containers;
+  for (uint32_t i = 0; i < 2048; i ++)
+    {
+      Ptr<LeoWaypointInputFileStreamContainer> c = CreateObject<LeoWaypointInputFileStreamContainer> ();
+      c->SetFile (path);
+      NS_TEST_ASSERT_MSG_EQ (c->GetNextSample (wp), true, "Stream " << i << " has a waypoint");
+      c->Suspend ();
+      containers.push_back (c);
+    }
+}
+
 /**
  * \ingroup leo-test
  * \ingroup tests
@@ -129,6 +363,9 @@ LeoWaypointsTestSuite::LeoWaypointsTestSuite ()
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new LeoWaypointFileEmptyTestCase, TestCase::QUICK);
   AddTestCase (new LeoWaypointSomeEntriesTestCase, TestCase::QUICK);
+  AddTestCase (new LeoWaypointBinaryFileTestCase, TestCase::QUICK);
+  AddTestCase (new LeoWaypointIndexTestCase, TestCase::QUICK);
+  AddTestCase (new LeoWaypointSuspendTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -16,6 +16,9 @@
  * Author: Tim Schubert <ns-3-leo@timschubert.net>
  */
 
+#include <map>
+#include <math.h>
+
 #include "ns3/core-module.h"
 #include "ns3/network-module.h"
 #include "ns3/internet-module.h"
@@ -233,6 +236,547 @@ private:
   }
 };
 
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Unit tests
+ */
+class LeoMockChannelSpatialIndexTestCase : public TestCase
+{
+public:
+  LeoMockChannelSpatialIndexTestCase () : TestCase ("transmission with spatial index only reaches devices in range"), m_deliveries (0) {}
+  virtual ~LeoMockChannelSpatialIndexTestCase () {}
+private:
+  void Delivered (Ptr<const Packet> p, Ptr<NetDevice> src, Ptr<NetDevice> dst, Time txTime, Time delay)
+  {
+    m_deliveries ++;
+  }
+
+  int32_t AddDevice (Ptr<LeoMockChannel> channel, LeoMockNetDevice::DeviceType type, Vector pos)
+  {
+    Ptr<Node> node = CreateObject<Node> ();
+    Ptr<ConstantPositionMobilityModel> mob = CreateObject<ConstantPositionMobilityModel> ();
+    mob->SetPosition (pos);
+    node->AggregateObject (mob);
+    Ptr<LeoMockNetDevice> dev = CreateObject<LeoMockNetDevice> ();
+    dev->SetNode (node);
+    dev->SetDeviceType (type);
+    dev->SetAddress (Mac48Address::Allocate ());
+    return channel->Attach (dev);
+  }
+
+  virtual void DoRun (void)
+  {
+    Ptr<LeoMockChannel> channel = CreateObject<LeoMockChannel> ();
+    channel->SetAttribute ("PropagationDelay", StringValue ("ns3::ConstantSpeedPropagationDelayModel"));
+    channel->SetAttribute ("PropagationLoss", StringValue ("ns3::LeoPropagationLossModel"));
+    channel->SetSpatialIndex (CreateObject<LeoGridSpatialIndex> (), CreateObject<LeoGridSpatialIndex> ());
+    channel->TraceConnectWithoutContext ("TxRxMockChannel",
+                                         MakeCallback (&LeoMockChannelSpatialIndexTestCase::Delivered, this));
+
+    int32_t gnd = AddDevice (channel, LeoMockNetDevice::GND, Vector (LEO_PROP_EARTH_RAD, 0, 0));
+    int32_t near = AddDevice (channel, LeoMockNetDevice::SAT, Vector (LEO_PROP_EARTH_RAD + 550e3, 0, 0));
+    AddDevice (channel, LeoMockNetDevice::SAT, Vector (- LEO_PROP_EARTH_RAD - 550e3, 0, 0));
+
+    Ptr<Packet> p = Create<Packet> ();
+    bool result = channel->TransmitStart (p, gnd, channel->GetDevice (near)->GetAddress (), Time ());
+    NS_TEST_ASSERT_MSG_EQ (result, true, "ground to space transmission failed");
+    NS_TEST_ASSERT_MSG_EQ (m_deliveries, 1, "packet has to reach exactly the satellite in range");
+
+    result = channel->TransmitStart (p, near, channel->GetDevice (gnd)->GetAddress (), Time ());
+    NS_TEST_ASSERT_MSG_EQ (result, true, "space to ground transmission failed");
+    NS_TEST_ASSERT_MSG_EQ (m_deliveries, 2, "packet has to reach the ground station");
+
+    Simulator::Destroy ();
+  }
+
+  uint32_t m_deliveries;
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Unit tests
+ */
+class LeoMockChannelPreFilterTestCase : public TestCase
+{
+public:
+  LeoMockChannelPreFilterTestCase () : TestCase ("pre-filter reaches moving satellites at the cutoff distance"), m_all (0), m_filtered (0), m_last (0), m_changes (0) {}
+  virtual ~LeoMockChannelPreFilterTestCase () {}
+private:
+  void DeliveredAll (Ptr<const Packet> p, Ptr<NetDevice> src, Ptr<NetDevice> dst, Time txTime, Time delay)
+  {
+    m_all ++;
+  }
+
+  void DeliveredFiltered (Ptr<const Packet> p, Ptr<NetDevice> src, Ptr<NetDevice> dst, Time txTime, Time delay)
+  {
+    m_filtered ++;
+  }
+
+  Ptr<LeoMockChannel> CreateChannel (void)
+  {
+    Ptr<LeoMockChannel> channel = CreateObject<LeoMockChannel> ();
+    channel->SetAttribute ("PropagationDelay", StringValue ("ns3::ConstantSpeedPropagationDelayModel"));
+    channel->SetAttribute ("PropagationLoss", StringValue ("ns3::LeoPropagationLossModel"));
+    return channel;
+  }
+
+  int32_t AddDevice (Ptr<LeoMockChannel> channel, Ptr<Node> node, LeoMockNetDevice::DeviceType type)
+  {
+    Ptr<LeoMockNetDevice> dev = CreateObject<LeoMockNetDevice> ();
+    dev->SetNode (node);
+    dev->SetDeviceType (type);
+    dev->SetAddress (Mac48Address::Allocate ());
+    return channel->Attach (dev);
+  }
+
+  void Send (void)
+  {
+    m_all = 0;
+    m_filtered = 0;
+    Ptr<Packet> p = Create<Packet> (100);
+    m_channels[0]->TransmitStart (p, m_sources[0], Mac48Address::GetBroadcast (), Time ());
+    m_channels[1]->TransmitStart (p, m_sources[1], Mac48Address::GetBroadcast (), Time ());
+
+    NS_TEST_EXPECT_MSG_EQ (m_filtered, m_all, "pre-filter missed a satellite in range at " << Simulator::Now ().GetSeconds () << "s");
+    if (m_all != m_last)
+      {
+        m_changes ++;
+      }
+    m_last = m_all;
+  }
+
+  virtual void DoRun (void)
+  {
+    m_channels[0] = CreateChannel ();
+    m_channels[1] = CreateChannel ();
+    // the cached positions are outdated by up to ten seconds
+    m_channels[1]->SetAttribute ("PreFilter", BooleanValue (true));
+    m_channels[1]->SetAttribute ("SpatialIndexInterval", TimeValue (Seconds (10)));
+    m_channels[0]->TraceConnectWithoutContext ("TxRxMockChannel",
+                                               MakeCallback (&LeoMockChannelPreFilterTestCase::DeliveredAll, this));
+    m_channels[1]->TraceConnectWithoutContext ("TxRxMockChannel",
+                                               MakeCallback (&LeoMockChannelPreFilterTestCase::DeliveredFiltered, this));
+
+    Ptr<Node> gnd = CreateObject<Node> ();
+    Ptr<ConstantPositionMobilityModel> gndMob = CreateObject<ConstantPositionMobilityModel> ();
+    gndMob->SetPosition (Vector (LEO_PROP_EARTH_RAD, 0, 0));
+    gnd->AggregateObject (gndMob);
+    for (uint32_t i = 0; i < 2; i ++)
+      {
+        m_sources[i] = AddDevice (m_channels[i], gnd, LeoMockNetDevice::GND);
+      }
+
+    // the satellites move faster than the velocity reported by the model
+    for (uint32_t sat = 0; sat < 12; sat ++)
+      {
+        Ptr<Node> node = CreateObject<Node> ();
+        Ptr<LeoCircularOrbitMobilityModel> mob = CreateObject<LeoCircularOrbitMobilityModel> ();
+        mob->SetAttribute ("Altitude", DoubleValue (1325.0));
+        mob->SetAttribute ("Inclination", DoubleValue (53.0));
+        mob->SetAttribute ("Precision", TimeValue (Seconds (0)));
+        mob->SetPosition (Vector (0, 2 * M_PI * sat / 12.0, 0));
+        node->AggregateObject (mob);
+        for (uint32_t i = 0; i < 2; i ++)
+          {
+            AddDevice (m_channels[i], node, LeoMockNetDevice::SAT);
+          }
+      }
+
+    for (uint32_t s = 1; s <= 1200; s ++)
+      {
+        Simulator::Schedule (Seconds (s), &LeoMockChannelPreFilterTestCase::Send, this);
+      }
+    Simulator::Run ();
+
+    NS_TEST_ASSERT_MSG_GT (m_changes, 2, "no satellite crossed the cutoff distance");
+
+    m_channels[0] = 0;
+    m_channels[1] = 0;
+    Simulator::Destroy ();
+  }
+
+  /// Channels without and with pre-filter
+  Ptr<LeoMockChannel> m_channels[2];
+  /// Ground station on each channel
+  int32_t m_sources[2];
+  uint32_t m_all;
+  uint32_t m_filtered;
+  uint32_t m_last;
+  uint32_t m_changes;
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Unit tests
+ */
+class LeoMockChannelContactPlanTestCase : public TestCase
+{
+public:
+  LeoMockChannelContactPlanTestCase () : TestCase ("transmission with contact plan only reaches devices in range"), m_deliveries (0) {}
+  virtual ~LeoMockChannelContactPlanTestCase () {}
+private:
+  void Delivered (Ptr<const Packet> p, Ptr<NetDevice> src, Ptr<NetDevice> dst, Time txTime, Time delay)
+  {
+    m_deliveries ++;
+  }
+
+  int32_t AddDevice (Ptr<LeoMockChannel> channel, LeoMockNetDevice::DeviceType type, Vector pos)
+  {
+    Ptr<Node> node = CreateObject<Node> ();
+    Ptr<ConstantPositionMobilityModel> mob = CreateObject<ConstantPositionMobilityModel> ();
+    mob->SetPosition (pos);
+    node->AggregateObject (mob);
+    Ptr<LeoMockNetDevice> dev = CreateObject<LeoMockNetDevice> ();
+    dev->SetNode (node);
+    dev->SetDeviceType (type);
+    dev->SetAddress (Mac48Address::Allocate ());
+    return channel->Attach (dev);
+  }
+
+  virtual void DoRun (void)
+  {
+    Ptr<LeoMockChannel> channel = CreateObject<LeoMockChannel> ();
+    channel->SetAttribute ("PropagationDelay", StringValue ("ns3::ConstantSpeedPropagationDelayModel"));
+    channel->SetAttribute ("PropagationLoss", StringValue ("ns3::LeoPropagationLossModel"));
+    Ptr<LeoContactPlan> plan = CreateObject<LeoContactPlan> ();
+    plan->SetAttribute ("Duration", TimeValue (Seconds (10)));
+    channel->SetContactPlan (plan);
+    channel->TraceConnectWithoutContext ("TxRxMockChannel",
+                                         MakeCallback (&LeoMockChannelContactPlanTestCase::Delivered, this));
+
+    int32_t gnd = AddDevice (channel, LeoMockNetDevice::GND, Vector (LEO_PROP_EARTH_RAD, 0, 0));
+    int32_t near = AddDevice (channel, LeoMockNetDevice::SAT, Vector (LEO_PROP_EARTH_RAD + 550e3, 0, 0));
+    int32_t far = AddDevice (channel, LeoMockNetDevice::SAT, Vector (- LEO_PROP_EARTH_RAD - 550e3, 0, 0));
+
+    Ptr<Packet> p = Create<Packet> ();
+    bool result = channel->TransmitStart (p, gnd, channel->GetDevice (near)->GetAddress (), Time ());
+    NS_TEST_ASSERT_MSG_EQ (plan->IsComputed (), true, "contact plan has not been computed");
+    NS_TEST_ASSERT_MSG_EQ (result, true, "ground to space transmission failed");
+    NS_TEST_ASSERT_MSG_EQ (m_deliveries, 1, "packet has to reach exactly the satellite in range");
+    NS_TEST_ASSERT_MSG_EQ (plan->GetContacts (far).size (), 0, "satellite on the other side has contacts");
+
+    result = channel->TransmitStart (p, near, channel->GetDevice (gnd)->GetAddress (), Time ());
+    NS_TEST_ASSERT_MSG_EQ (result, true, "space to ground transmission failed");
+    NS_TEST_ASSERT_MSG_EQ (m_deliveries, 2, "packet has to reach the ground station");
+
+    result = channel->TransmitStart (p, far, channel->GetDevice (gnd)->GetAddress (), Time ());
+    NS_TEST_ASSERT_MSG_EQ (result, false, "transmission from satellite without contacts succeeded");
+
+    Simulator::Destroy ();
+  }
+
+  uint32_t m_deliveries;
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Unit tests
+ */
+class LeoGridSpatialIndexQueryTestCase : public TestCase
+{
+public:
+  LeoGridSpatialIndexQueryTestCase () : TestCase ("grid spatial index finds exactly the positions within range") {}
+  virtual ~LeoGridSpatialIndexQueryTestCase () {}
+private:
+  virtual void DoRun (void)
+  {
+    Ptr<LeoGridSpatialIndex> index = CreateObject<LeoGridSpatialIndex> ();
+    index->SetAttribute ("CellSize", DoubleValue (100.0));
+
+    std::vector<Vector> positions;
+    for (int i = 0; i < 20; i ++)
+      {
+        positions.push_back (Vector (i * 50.0 - 500.0, 0, 0));
+      }
+    index->Build (positions);
+    NS_TEST_ASSERT_MSG_EQ (index->GetN (), positions.size (), "all positions have to be indexed");
+
+    std::vector<uint32_t> result;
+    index->Query (Vector (0, 0, 0), 120.0, result);
+    std::sort (result.begin (), result.end ());
+
+    std::vector<uint32_t> expected = { 8, 9, 10, 11, 12 };
+    NS_TEST_ASSERT_MSG_EQ (result.size (), expected.size (), "wrong number of positions in range");
+    for (size_t i = 0; i < expected.size (); i ++)
+      {
+        NS_TEST_EXPECT_MSG_EQ (result[i], expected[i], "wrong position in range");
+      }
+  }
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Unit tests
+ */
+class LeoGridSpatialIndexSmallCellsTestCase : public TestCase
+{
+public:
+  LeoGridSpatialIndexSmallCellsTestCase () : TestCase ("grid spatial index with small cells finds each position once") {}
+  virtual ~LeoGridSpatialIndexSmallCellsTestCase () {}
+private:
+  virtual void DoRun (void)
+  {
+    Ptr<LeoGridSpatialIndex> index = CreateObject<LeoGridSpatialIndex> ();
+    index->SetAttribute ("CellSize", DoubleValue (1.0));
+
+    // more than 2^21 cells apart on every axis
+    std::vector<Vector> positions = {
+      Vector (LEO_PROP_EARTH_RAD, 0, 0),
+      Vector (- LEO_PROP_EARTH_RAD, 0, 0),
+      Vector (0, LEO_PROP_EARTH_RAD, 0),
+      Vector (0, 0, - LEO_PROP_EARTH_RAD)
+    };
+    index->Build (positions);
+
+    std::vector<uint32_t> result;
+    index->Query (Vector (0, 0, 0), 2 * LEO_PROP_EARTH_RAD, result);
+    std::sort (result.begin (), result.end ());
+    NS_TEST_ASSERT_MSG_EQ (result.size (), positions.size (), "positions found more than once");
+    for (uint32_t i = 0; i < result.size (); i ++)
+      {
+        NS_TEST_EXPECT_MSG_EQ (result[i], i, "wrong position in range");
+      }
+
+    result.clear ();
+    index->Query (positions[1], 10.0, result);
+    NS_TEST_ASSERT_MSG_EQ (result.size (), 1, "wrong number of positions in range");
+    NS_TEST_EXPECT_MSG_EQ (result[0], 1, "wrong position in range");
+  }
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Unit tests
+ */
+class LeoL2RelayTestCase : public TestCase
+{
+public:
+  LeoL2RelayTestCase (bool index)
+    : TestCase (index ? "one satellite relays frames between ground stations at layer 2 with spatial index"
+                      : "one satellite relays frames between ground stations at layer 2"),
+      m_index (index)
+  {
+  }
+  virtual ~LeoL2RelayTestCase () {}
+private:
+  bool Receive (Ptr<NetDevice> dev, Ptr<const Packet> p, uint16_t protocol, const Address &from)
+  {
+    m_received[dev].push_back (Mac48Address::ConvertFrom (from));
+    return true;
+  }
+
+  void Relay (std::string context, Ptr<const Packet> p)
+  {
+    m_relayed[context] ++;
+  }
+
+  virtual void DoRun (void)
+  {
+    Ptr<LeoMockChannel> channel = CreateObject<LeoMockChannel> ();
+    channel->SetAttribute ("PropagationDelay", StringValue ("ns3::ConstantSpeedPropagationDelayModel"));
+    channel->SetAttribute ("PropagationLoss", StringValue ("ns3::LeoPropagationLossModel"));
+    if (m_index)
+      {
+        channel->SetSpatialIndex (CreateObject<LeoGridSpatialIndex> (), CreateObject<LeoGridSpatialIndex> ());
+      }
+
+    // two ground stations on the equator, two satellites above them and one
+    // on the other side of the earth
+    NetDeviceContainer devices;
+    std::vector<LeoMockNetDevice::DeviceType> types = { LeoMockNetDevice::GND, LeoMockNetDevice::GND,
+                                                        LeoMockNetDevice::SAT, LeoMockNetDevice::SAT, LeoMockNetDevice::SAT };
+    std::vector<double> angles = { 0.0, 0.02, 0.005, 0.015, M_PI };
+    for (uint32_t i = 0; i < types.size (); i ++)
+      {
+        double radius = LEO_PROP_EARTH_RAD + (types[i] == LeoMockNetDevice::SAT ? 550e3 : 0.0);
+        Ptr<Node> node = CreateObject<Node> ();
+        Ptr<ConstantPositionMobilityModel> mob = CreateObject<ConstantPositionMobilityModel> ();
+        mob->SetPosition (Vector (radius * cos (angles[i]), radius * sin (angles[i]), 0));
+        node->AggregateObject (mob);
+        Ptr<LeoMockNetDevice> dev = CreateObject<LeoMockNetDevice> ();
+        dev->SetDeviceType (types[i]);
+        dev->SetAddress (Mac48Address::Allocate ());
+        dev->SetQueue (CreateObject<DropTailQueue<Packet> > ());
+        node->AddDevice (dev);
+        dev->Attach (channel);
+        devices.Add (dev);
+      }
+    for (uint32_t i = 0; i < 2; i ++)
+      {
+        devices.Get (i)->SetReceiveCallback (MakeCallback (&LeoL2RelayTestCase::Receive, this));
+      }
+
+    LeoL2RelayHelper relayHelper;
+    relayHelper.Install (devices);
+    NS_TEST_ASSERT_MSG_EQ (devices.Get (0)->GetNode ()->GetObject<LeoL2Relay> (), 0, "relay on a ground station");
+    for (uint32_t i = 2; i < devices.GetN (); i ++)
+      {
+        Ptr<LeoL2Relay> relay = devices.Get (i)->GetNode ()->GetObject<LeoL2Relay> ();
+        NS_TEST_ASSERT_MSG_NE (relay, 0, "no relay on the satellite");
+        relay->TraceConnect ("Relay", std::to_string (i), MakeCallback (&LeoL2RelayTestCase::Relay, this));
+      }
+
+    Ptr<NetDevice> src = devices.Get (0);
+    Ptr<NetDevice> dst = devices.Get (1);
+    src->Send (Create<Packet> (100), dst->GetAddress (), 0x0800);
+    // frames for satellites must not be sent to the ground
+    src->Send (Create<Packet> (100), devices.Get (4)->GetAddress (), 0x0800);
+    Simulator::Run ();
+
+    NS_TEST_EXPECT_MSG_EQ (m_relayed.size (), 1, "frame has been relayed by more than one satellite");
+    NS_TEST_EXPECT_MSG_EQ (m_relayed["3"], 1, "frame has not been relayed once by the satellite closest to the destination");
+    NS_TEST_ASSERT_MSG_EQ (m_received[dst].size (), 1, "frame has not been received exactly once");
+    NS_TEST_EXPECT_MSG_EQ (m_received[dst][0], Mac48Address::ConvertFrom (src->GetAddress ()), "source address has not been kept");
+    NS_TEST_EXPECT_MSG_EQ (m_received[src].size (), 0, "frame has been received by its source");
+
+    // broadcasts are relayed by the satellite closest to the source, but not
+    // back to the source
+    m_relayed.clear ();
+    m_received.clear ();
+    src->Send (Create<Packet> (100), src->GetBroadcast (), 0x0800);
+    Simulator::Run ();
+    Simulator::Destroy ();
+
+    NS_TEST_EXPECT_MSG_EQ (m_relayed.size (), 1, "broadcast has been relayed by more than one satellite");
+    NS_TEST_EXPECT_MSG_EQ (m_relayed["2"], 1, "broadcast has not been relayed once by the satellite closest to the source");
+    NS_TEST_ASSERT_MSG_EQ (m_received[dst].size (), 1, "broadcast has not been received exactly once");
+    NS_TEST_EXPECT_MSG_EQ (m_received[dst][0], Mac48Address::ConvertFrom (src->GetAddress ()), "source address of broadcast has not been kept");
+    NS_TEST_EXPECT_MSG_EQ (m_received[src].size (), 0, "broadcast has been received by its source");
+  }
+
+  bool m_index;
+  std::map<Ptr<NetDevice>, std::vector<Mac48Address> > m_received;
+  std::map<std::string, uint32_t> m_relayed;
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Traffic between nodes with ARP caches filled by ArpCacheHelper
+ *
+ * The last ground station is not passed to the helper, so its packets need
+ * an ARP request over the channel, which is answered by a prepared node.
+ * Packets to it from a prepared node need an ARP request as well.
+ */
+class ArpCacheHelperTestCase : public TestCase
+{
+public:
+  ArpCacheHelperTestCase () : TestCase ("traffic with ARP caches filled on demand") {}
+  virtual ~ArpCacheHelperTestCase () {}
+private:
+  void CountArp (Ptr<const Packet> packet)
+  {
+    Ptr<Packet> frame = packet->Copy ();
+    EthernetHeader header;
+    frame->RemoveHeader (header);
+    LlcSnapHeader llc;
+    frame->PeekHeader (llc);
+    if (llc.GetType () == ArpL3Protocol::PROT_NUMBER)
+      {
+        m_arpFrames ++;
+      }
+  }
+
+  void Receive (Ptr<Socket> socket)
+  {
+    while (socket->Recv ())
+      {
+        m_received[socket->GetNode ()->GetId ()] ++;
+      }
+  }
+
+  void Send (Ptr<Node> src, Ipv4Address dst)
+  {
+    Ptr<Socket> socket = Socket::CreateSocket (src, UdpSocketFactory::GetTypeId ());
+    socket->SendTo (Create<Packet> (100), 0, InetSocketAddress (dst, 9));
+    socket->Close ();
+  }
+
+  virtual void DoRun (void)
+  {
+    NodeContainer satellites;
+    satellites.Create (2);
+    NodeContainer stations;
+    stations.Create (3);
+
+    LeoChannelHelper utCh;
+    NetDeviceContainer utNet = utCh.Install (satellites, stations);
+    InternetStackHelper stack;
+    stack.Install (satellites);
+    stack.Install (stations);
+    Ipv4AddressHelper address;
+    address.SetBase ("10.1.0.0", "255.255.255.0");
+    Ipv4InterfaceContainer interfaces = address.Assign (utNet);
+
+    // all devices but the one of the last ground station
+    NetDeviceContainer prepared;
+    Ipv4InterfaceContainer preparedIfs;
+    for (uint32_t i = 0; i + 1 < utNet.GetN (); i ++)
+      {
+        prepared.Add (utNet.Get (i));
+        preparedIfs.Add (interfaces.Get (i));
+      }
+    ArpCacheHelper arpCache;
+    arpCache.Install (prepared, preparedIfs);
+
+    Ptr<MockNetDevice> sat0Dev = DynamicCast<MockNetDevice> (utNet.Get (0));
+    Ptr<MockNetDevice> gnd0Dev = DynamicCast<MockNetDevice> (utNet.Get (2));
+    NS_TEST_ASSERT_MSG_EQ (sat0Dev->GetArpTable ()->GetN (), 2, "satellites do not know the prepared ground stations");
+    NS_TEST_ASSERT_MSG_EQ (gnd0Dev->GetArpTable ()->GetN (), 2, "ground stations do not know the satellites");
+    NS_TEST_ASSERT_MSG_EQ (DynamicCast<MockNetDevice> (utNet.Get (4))->GetArpTable (), 0, "device outside of the container has a table");
+
+    for (uint32_t i = 0; i < utNet.GetN (); i ++)
+      {
+        Ptr<Socket> sink = Socket::CreateSocket (utNet.Get (i)->GetNode (), UdpSocketFactory::GetTypeId ());
+        sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), 9));
+        sink->SetRecvCallback (MakeCallback (&ArpCacheHelperTestCase::Receive, this));
+        utNet.Get (i)->TraceConnectWithoutContext ("PhyTxBegin", MakeCallback (&ArpCacheHelperTestCase::CountArp, this));
+      }
+
+    Ptr<Node> sat0 = satellites.Get (0);
+    Ptr<Node> sat1 = satellites.Get (1);
+    // from the ground to a satellite
+    Simulator::Schedule (Seconds (1), &ArpCacheHelperTestCase::Send, this, stations.Get (0), interfaces.GetAddress (1));
+    // from a satellite to the ground
+    Simulator::Schedule (Seconds (2), &ArpCacheHelperTestCase::Send, this, sat1, interfaces.GetAddress (3));
+    // cache miss of the ground station without prepared cache, one request
+    // and one reply
+    Simulator::Schedule (Seconds (3), &ArpCacheHelperTestCase::Send, this, stations.Get (2), interfaces.GetAddress (1));
+    // destination outside of the container, one request and one reply
+    Simulator::Schedule (Seconds (4), &ArpCacheHelperTestCase::Send, this, sat0, interfaces.GetAddress (4));
+    Simulator::Stop (Seconds (10));
+    Simulator::Run ();
+
+    Ptr<ArpCache> cache = sat0->GetObject<Ipv4L3Protocol> ()->GetInterface (1)->GetArpCache ();
+    NS_TEST_EXPECT_MSG_EQ (cache->Lookup (interfaces.GetAddress (3)), 0, "cache has an entry for an unused neighbour");
+    ArpCache::Entry *entry = cache->Lookup (interfaces.GetAddress (4));
+    NS_TEST_ASSERT_MSG_NE (entry, 0, "cache has no entry for the used neighbour");
+    NS_TEST_EXPECT_MSG_EQ (entry->GetMacAddress (), utNet.Get (4)->GetAddress (), "wrong hardware address");
+    Simulator::Destroy ();
+
+    NS_TEST_EXPECT_MSG_EQ (m_received[sat1->GetId ()], 2, "satellite did not receive both packets");
+    NS_TEST_EXPECT_MSG_EQ (m_received[stations.Get (1)->GetId ()], 1, "ground station did not receive the packet");
+    NS_TEST_EXPECT_MSG_EQ (m_received[stations.Get (2)->GetId ()], 1, "ground station outside of the container did not receive the packet");
+    NS_TEST_EXPECT_MSG_EQ (m_arpFrames, 4, "ARP requests for prepared neighbours were sent over the channel");
+  }
+
+  std::map<uint32_t, uint32_t> m_received;
+  uint32_t m_arpFrames = 0;
+};
+
 /**
  * \ingroup leo-test
  * \ingroup tests
@@ -253,6 +797,14 @@ LeoMockChannelTestSuite::LeoMockChannelTestSuite ()
   AddTestCase (new LeoMockChannelTransmitSpaceGroundTestCase, TestCase::QUICK);
   AddTestCase (new LeoMockChannelTransmitSpaceSpaceTestCase, TestCase::QUICK);
   AddTestCase (new LeoMockChannelTransmitGroundGroundTestCase, TestCase::QUICK);
+  AddTestCase (new LeoMockChannelSpatialIndexTestCase, TestCase::QUICK);
+  AddTestCase (new LeoMockChannelPreFilterTestCase, TestCase::QUICK);
+  AddTestCase (new LeoMockChannelContactPlanTestCase, TestCase::QUICK);
+  AddTestCase (new LeoGridSpatialIndexQueryTestCase, TestCase::QUICK);
+  AddTestCase (new LeoGridSpatialIndexSmallCellsTestCase, TestCase::QUICK);
+  AddTestCase (new LeoL2RelayTestCase (false), TestCase::QUICK);
+  AddTestCase (new LeoL2RelayTestCase (true), TestCase::QUICK);
+  AddTestCase (new ArpCacheHelperTestCase, TestCase::QUICK);
 }
 
 static LeoMockChannelTestSuite islMockChannelTestSuite;
@@ -24,6 +24,8 @@
 #include "ns3/nstime.h"
 
 #include "../model/leo-circular-orbit-mobility-model.h"
+#include "../model/leo-constellation-propagator.h"
+#include "../model/leo-constellation-clock.h"
 
 using namespace ns3;
 
@@ -220,6 +222,194 @@ void LeoOrbitTracingTestCase::CourseChange (std::string context, Ptr<const Mobil
   }
 
 
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Unit tests
+ */
+class LeoOrbitPropagatorTestCase : public TestCase
+{
+public:
+  LeoOrbitPropagatorTestCase () : TestCase ("constellation propagator computes the same positions as the satellites") {}
+  virtual ~LeoOrbitPropagatorTestCase () {}
+private:
+  virtual void DoRun (void)
+  {
+    Ptr<LeoConstellationPropagator> propagator = CreateObject<LeoConstellationPropagator> ();
+    std::vector<Ptr<LeoCircularOrbitMobilityModel> > sats;
+    for (double inclination : { 53.0, 97.6 })
+      {
+        for (uint32_t plane = 0; plane < 3; plane ++)
+          {
+            for (uint32_t sat = 0; sat < 5; sat ++)
+              {
+                Ptr<LeoCircularOrbitMobilityModel> mob = CreateObject<LeoCircularOrbitMobilityModel> ();
+                mob->SetAttribute ("Altitude", DoubleValue (550.0));
+                mob->SetAttribute ("Inclination", DoubleValue (inclination));
+                mob->SetPosition (Vector (2 * M_PI * plane / 3.0, 2 * M_PI * sat / 5.0, 0));
+                NS_TEST_ASSERT_MSG_EQ (propagator->Add (mob), sats.size (), "unexpected slot");
+                sats.push_back (mob);
+              }
+          }
+      }
+    NS_TEST_ASSERT_MSG_EQ (propagator->GetNPlanes (), 6, "satellites have not been grouped by plane");
+
+    for (Time t : { Seconds (0), Seconds (123.4), Hours (3) })
+      {
+        propagator->Update (t);
+        for (uint32_t slot = 0; slot < sats.size (); slot ++)
+          {
+            Vector expected = sats[slot]->GetPositionAt (t);
+            Vector actual = propagator->GetPosition (slot, t);
+            NS_TEST_EXPECT_MSG_EQ_TOL (actual.x, expected.x, 1e-3, "wrong position of satellite " << slot);
+            NS_TEST_EXPECT_MSG_EQ_TOL (actual.y, expected.y, 1e-3, "wrong position of satellite " << slot);
+            NS_TEST_EXPECT_MSG_EQ_TOL (actual.z, expected.z, 1e-3, "wrong position of satellite " << slot);
+          }
+      }
+
+    // changing the orbit detaches the satellite from the propagator
+    sats[0]->SetPosition (Vector (1.0, 1.0, 0));
+    Vector expected = sats[0]->GetPositionAt (Simulator::Now ());
+    Vector actual = sats[0]->GetPosition ();
+    NS_TEST_EXPECT_MSG_EQ_TOL (actual.x, expected.x, 1e-3, "satellite still uses the propagator");
+    NS_TEST_EXPECT_MSG_EQ_TOL (actual.y, expected.y, 1e-3, "satellite still uses the propagator");
+    NS_TEST_EXPECT_MSG_EQ_TOL (actual.z, expected.z, 1e-3, "satellite still uses the propagator");
+
+    Simulator::Destroy ();
+  }
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Unit tests
+ */
+class LeoOrbitUpdateModeTestCase : public TestCase
+{
+public:
+  LeoOrbitUpdateModeTestCase () : TestCase ("lazy positions do not need simulation events") {}
+  virtual ~LeoOrbitUpdateModeTestCase () {}
+private:
+  virtual void DoRun (void)
+  {
+    // changing the orbit multiple times must not start multiple periodic updates
+    Ptr<LeoCircularOrbitMobilityModel> periodic = CreateObject<LeoCircularOrbitMobilityModel> ();
+    periodic->SetAttribute ("Altitude", DoubleValue (550.0));
+    periodic->SetAttribute ("Inclination", DoubleValue (53.0));
+    periodic->SetPosition (Vector (1.0, 2.0, 0));
+    periodic->TraceConnectWithoutContext ("CourseChange", MakeCallback (&LeoOrbitUpdateModeTestCase::CourseChange, this));
+    m_changes = 0;
+    Simulator::Stop (Seconds (10.5));
+    Simulator::Run ();
+    NS_TEST_EXPECT_MSG_EQ (m_changes, 10, "position not updated exactly once per precision");
+    Simulator::Destroy ();
+
+    Ptr<LeoCircularOrbitMobilityModel> lazy = CreateObject<LeoCircularOrbitMobilityModel> ();
+    lazy->SetAttribute ("UpdateMode", EnumValue (LeoCircularOrbitMobilityModel::LAZY));
+    lazy->SetAttribute ("Altitude", DoubleValue (550.0));
+    lazy->SetAttribute ("Inclination", DoubleValue (53.0));
+    lazy->SetPosition (Vector (1.0, 2.0, 0));
+    lazy->TraceConnectWithoutContext ("CourseChange", MakeCallback (&LeoOrbitUpdateModeTestCase::CourseChange, this));
+    m_changes = 0;
+    for (double t : { 0.5, 3.2, 3.7, 9.9 })
+      {
+        Simulator::Schedule (Seconds (t), &LeoOrbitUpdateModeTestCase::CheckLazy, this, lazy);
+      }
+    Simulator::Stop (Seconds (100));
+    Simulator::Run ();
+    // only the four checks and the stop event
+    NS_TEST_EXPECT_MSG_LT (Simulator::GetEventCount (), 6, "lazy mode scheduled events");
+    // the first interval has already been read when the orbit was set
+    NS_TEST_EXPECT_MSG_EQ (m_changes, 2, "course change not notified once per read interval");
+    Simulator::Destroy ();
+  }
+
+  void CheckLazy (Ptr<LeoCircularOrbitMobilityModel> mob)
+  {
+    Vector expected = mob->GetPositionAt (Seconds (floor (Simulator::Now ().GetSeconds ())));
+    Vector actual = mob->GetPosition ();
+    NS_TEST_EXPECT_MSG_EQ_TOL (actual.x, expected.x, 1e-3, "position not of the current interval");
+    NS_TEST_EXPECT_MSG_EQ_TOL (actual.y, expected.y, 1e-3, "position not of the current interval");
+    NS_TEST_EXPECT_MSG_EQ_TOL (actual.z, expected.z, 1e-3, "position not of the current interval");
+  }
+
+  void CourseChange (Ptr<const MobilityModel> mob)
+  {
+    m_changes ++;
+  }
+
+  uint32_t m_changes;
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Unit tests
+ */
+class LeoOrbitClockTestCase : public TestCase
+{
+public:
+  LeoOrbitClockTestCase () : TestCase ("constellation clock updates all satellites in one event") {}
+  virtual ~LeoOrbitClockTestCase () {}
+private:
+  virtual void DoRun (void)
+  {
+    Ptr<LeoConstellationPropagator> propagator = CreateObject<LeoConstellationPropagator> ();
+    Ptr<LeoConstellationClock> clock = CreateObject<LeoConstellationClock> ();
+    clock->SetAttribute ("Threads", UintegerValue (2));
+    clock->SetPropagator (propagator);
+
+    std::vector<Ptr<LeoCircularOrbitMobilityModel> > sats;
+    for (uint32_t plane = 0; plane < 4; plane ++)
+      {
+        for (uint32_t sat = 0; sat < 5; sat ++)
+          {
+            Ptr<LeoCircularOrbitMobilityModel> mob = CreateObject<LeoCircularOrbitMobilityModel> ();
+            mob->SetAttribute ("Altitude", DoubleValue (550.0));
+            mob->SetAttribute ("Inclination", DoubleValue (53.0));
+            mob->SetPosition (Vector (2 * M_PI * plane / 4.0, 2 * M_PI * sat / 5.0, 0));
+            mob->TraceConnectWithoutContext ("CourseChange", MakeCallback (&LeoOrbitClockTestCase::CourseChange, this));
+            propagator->Add (mob);
+            clock->Add (mob);
+            sats.push_back (mob);
+          }
+      }
+    NS_TEST_ASSERT_MSG_EQ (clock->GetN (), sats.size (), "satellites not added to clock");
+
+    m_changes = 0;
+    Simulator::Schedule (Seconds (5.5), &LeoOrbitClockTestCase::Check, this, sats);
+    Simulator::Stop (Seconds (10.5));
+    Simulator::Run ();
+    NS_TEST_EXPECT_MSG_EQ (m_changes, 10 * sats.size (), "satellites not updated once per precision");
+    // ten ticks, the check and the stop event
+    NS_TEST_EXPECT_MSG_LT (Simulator::GetEventCount (), 13, "satellites scheduled their own updates");
+
+    Simulator::Destroy ();
+  }
+
+  void Check (std::vector<Ptr<LeoCircularOrbitMobilityModel> > sats)
+  {
+    for (Ptr<LeoCircularOrbitMobilityModel> mob : sats)
+      {
+        Vector expected = mob->GetPositionAt (Seconds (5));
+        Vector actual = mob->GetPosition ();
+        NS_TEST_EXPECT_MSG_EQ_TOL (actual.x, expected.x, 1e-3, "position not updated by clock");
+        NS_TEST_EXPECT_MSG_EQ_TOL (actual.y, expected.y, 1e-3, "position not updated by clock");
+        NS_TEST_EXPECT_MSG_EQ_TOL (actual.z, expected.z, 1e-3, "position not updated by clock");
+      }
+  }
+
+  void CourseChange (Ptr<const MobilityModel> mob)
+  {
+    m_changes ++;
+  }
+
+  uint32_t m_changes;
+};
+
 /**
  * \ingroup leo-test
  * \ingroup tests
@@ -235,6 +425,9 @@ public:
       AddTestCase (new LeoOrbitProgressTestCase, TestCase::QUICK);
       AddTestCase (new LeoOrbitLatitudeTestCase, TestCase::QUICK);
       AddTestCase (new LeoOrbitOffsetTestCase, TestCase::QUICK);
+      AddTestCase (new LeoOrbitPropagatorTestCase, TestCase::QUICK);
+      AddTestCase (new LeoOrbitUpdateModeTestCase, TestCase::QUICK);
+      AddTestCase (new LeoOrbitClockTestCase, TestCase::QUICK);
       AddTestCase (new LeoOrbitTracingTestCase, TestCase::EXTENSIVE);
   }
 };
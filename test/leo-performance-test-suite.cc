@@ -0,0 +1,705 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Author: Tim Schubert <ns-3-leo@timschubert.net>
+ */
+
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <math.h>
+#include <thread>
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/leo-module.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup leo
+ * \defgroup leo-test LEO module tests
+ */
+
+namespace {
+
+/**
+ * \brief Wall clock stopwatch for the benchmarks
+ */
+class Stopwatch
+{
+public:
+  Stopwatch () : m_start (std::chrono::steady_clock::now ()) {}
+
+  /**
+   * \return elapsed time since construction in ns
+   */
+  double GetNs (void) const
+  {
+    return std::chrono::duration<double, std::nano> (std::chrono::steady_clock::now () - m_start).count ();
+  }
+
+private:
+  std::chrono::steady_clock::time_point m_start;
+};
+
+/**
+ * \brief Print a benchmark result
+ * \param name name of the benchmark
+ * \param ns total time in ns
+ * \param items number of processed items
+ * \param unit name of an item
+ */
+void
+Report (std::string name, double ns, uint64_t items, std::string unit)
+{
+  std::cout << std::left << std::setw (48) << name
+            << std::right << std::setw (12) << std::fixed << std::setprecision (2) << ns / items << " ns/" << unit
+            << std::setw (16) << std::setprecision (0) << items / (ns * 1e-9) << " " << unit << "/s"
+            << std::endl;
+}
+
+/**
+ * \brief Print the build profile and the number of hardware threads
+ *
+ * The results are only comparable for the same profile and machine, so
+ * they must be published together with this line.
+ */
+void
+ReportProfile (void)
+{
+#if defined (NS3_BUILD_PROFILE_OPTIMIZED)
+  std::string profile = "optimized";
+#elif defined (NS3_BUILD_PROFILE_RELEASE)
+  std::string profile = "release";
+#elif defined (NS3_BUILD_PROFILE_DEBUG)
+  std::string profile = "debug";
+#else
+  std::string profile = "unknown";
+#endif
+  std::cout << "build profile " << profile << ", "
+            << std::thread::hardware_concurrency () << " hardware threads" << std::endl;
+}
+
+/**
+ * \brief Evenly distribute positions on a sphere
+ * \param n number of positions
+ * \param radius radius of the sphere
+ * \return positions
+ */
+std::vector<Vector>
+GetSpherePositions (uint32_t n, double radius)
+{
+  std::vector<Vector> positions;
+  double golden = M_PI * (3.0 - sqrt (5.0));
+  for (uint32_t i = 0; i < n; i ++)
+    {
+      double y = 1.0 - (i + 0.5) * 2.0 / n;
+      double r = sqrt (1.0 - y*y);
+      double phi = golden * i;
+      positions.push_back (Vector (cos (phi) * r * radius, y * radius, sin (phi) * r * radius));
+    }
+  return positions;
+}
+
+} // namespace
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Compares the device layouts of LeoMockChannel
+ *
+ * The map layout is the one that has been used by the channel before
+ * the flat device tables.
+ */
+class LeoDeviceTableBenchmarkTestCase : public TestCase
+{
+public:
+  LeoDeviceTableBenchmarkTestCase () : TestCase ("Fan-out over map and flat device layouts") {}
+  virtual ~LeoDeviceTableBenchmarkTestCase () {}
+private:
+  virtual void DoRun (void)
+  {
+    for (uint32_t n : { 1000, 5000, 40000 })
+      {
+        Run (n);
+      }
+  }
+
+  void Run (uint32_t n)
+  {
+    std::vector<Vector> positions = GetSpherePositions (n, LEO_PROP_EARTH_RAD + 550e3);
+
+    std::map<Address, Ptr<MockNetDevice> > map;
+    std::vector<uint32_t> ids;
+    std::vector<double> x, y, z;
+    std::vector<Ptr<MockNetDevice> > devices;
+    for (uint32_t i = 0; i < n; i ++)
+      {
+        Ptr<Node> node = CreateObject<Node> ();
+        Ptr<ConstantPositionMobilityModel> mob = CreateObject<ConstantPositionMobilityModel> ();
+        mob->SetPosition (positions[i]);
+        node->AggregateObject (mob);
+        Ptr<LeoMockNetDevice> dev = CreateObject<LeoMockNetDevice> ();
+        dev->SetNode (node);
+        dev->SetAddress (Mac48Address::Allocate ());
+
+        map[dev->GetAddress ()] = dev;
+        devices.push_back (dev);
+        ids.push_back (i);
+        x.push_back (positions[i].x);
+        y.push_back (positions[i].y);
+        z.push_back (positions[i].z);
+      }
+
+    Vector src (LEO_PROP_EARTH_RAD, 0, 0);
+    double radius2 = 2000e3 * 2000e3;
+    uint32_t rounds = std::max (1u, 4000000 / n);
+
+    uint64_t mapHits = 0;
+    Stopwatch mapWatch;
+    for (uint32_t r = 0; r < rounds; r ++)
+      {
+        for (std::map<Address, Ptr<MockNetDevice> >::iterator it = map.begin (); it != map.end (); it ++)
+          {
+            Vector pos = it->second->GetNode ()->GetObject<MobilityModel> ()->GetPosition ();
+            double dx = pos.x - src.x;
+            double dy = pos.y - src.y;
+            double dz = pos.z - src.z;
+            if (dx*dx + dy*dy + dz*dz <= radius2)
+              {
+                mapHits ++;
+              }
+          }
+      }
+    double mapNs = mapWatch.GetNs ();
+
+    uint64_t flatHits = 0;
+    Stopwatch flatWatch;
+    for (uint32_t r = 0; r < rounds; r ++)
+      {
+        for (size_t i = 0; i < ids.size (); i ++)
+          {
+            double dx = x[i] - src.x;
+            double dy = y[i] - src.y;
+            double dz = z[i] - src.z;
+            if (dx*dx + dy*dy + dz*dz <= radius2)
+              {
+                flatHits ++;
+              }
+          }
+      }
+    double flatNs = flatWatch.GetNs ();
+
+    std::ostringstream name;
+    name << "leo-device-table/map/" << n;
+    Report (name.str (), mapNs, (uint64_t) rounds * n, "device");
+    name.str ("");
+    name << "leo-device-table/flat/" << n;
+    Report (name.str (), flatNs, (uint64_t) rounds * n, "device");
+
+    NS_TEST_EXPECT_MSG_EQ (mapHits, flatHits, "layouts disagree about the devices in range");
+
+    Simulator::Destroy ();
+  }
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Compares the positions computed per satellite and per plane
+ */
+class LeoPropagatorBenchmarkTestCase : public TestCase
+{
+public:
+  LeoPropagatorBenchmarkTestCase () : TestCase ("Positions of a constellation per satellite and per plane") {}
+  virtual ~LeoPropagatorBenchmarkTestCase () {}
+private:
+  virtual void DoRun (void)
+  {
+    // roughly the first shells of Starlink
+    std::vector<LeoOrbit> orbits = { LeoOrbit (550, 53, 72, 22),
+                                     LeoOrbit (540, 53.2, 72, 22),
+                                     LeoOrbit (570, 70, 36, 20),
+                                     LeoOrbit (560, 97.6, 6, 58) };
+    LeoOrbitNodeHelper helper;
+    NodeContainer satellites = helper.Install (orbits);
+    Ptr<LeoConstellationPropagator> propagator = helper.GetPropagator ();
+    uint32_t n = satellites.GetN ();
+
+    std::vector<Ptr<LeoCircularOrbitMobilityModel> > models;
+    for (uint32_t i = 0; i < n; i ++)
+      {
+        models.push_back (satellites.Get (i)->GetObject<LeoCircularOrbitMobilityModel> ());
+      }
+
+    uint32_t ticks = 200;
+    double sum = 0;
+    Stopwatch satWatch;
+    for (uint32_t k = 0; k < ticks; k ++)
+      {
+        Time t = Seconds (k);
+        for (uint32_t i = 0; i < n; i ++)
+          {
+            sum += models[i]->GetPositionAt (t).x;
+          }
+      }
+    double satNs = satWatch.GetNs ();
+
+    double planeSum = 0;
+    Stopwatch planeWatch;
+    for (uint32_t k = 0; k < ticks; k ++)
+      {
+        Time t = Seconds (k);
+        propagator->Update (t);
+        for (uint32_t i = 0; i < n; i ++)
+          {
+            planeSum += propagator->GetPosition (i, t).x;
+          }
+      }
+    double planeNs = planeWatch.GetNs ();
+
+    std::ostringstream name;
+    name << "leo-propagator/satellite/" << n;
+    Report (name.str (), satNs, (uint64_t) ticks * n, "position");
+    name.str ("");
+    name << "leo-propagator/plane/" << n << "/" << propagator->GetNPlanes ();
+    Report (name.str (), planeNs, (uint64_t) ticks * n, "position");
+
+    NS_TEST_EXPECT_MSG_EQ_TOL (planeSum, sum, 1e-6 * fabs (sum) + 1.0, "propagator computes other positions");
+
+    Simulator::Destroy ();
+  }
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Throughput of LeoPropagationLossModel::CalcRxPower
+ *
+ * The legacy variant repeats the computation of the cutoff distance as it has
+ * been done before the tangent and the distances have been cached.
+ */
+class LeoPropagationBenchmarkTestCase : public TestCase
+{
+public:
+  LeoPropagationBenchmarkTestCase () : TestCase ("CalcRxPower with and without cached cutoff distances") {}
+  virtual ~LeoPropagationBenchmarkTestCase () {}
+private:
+  virtual void DoRun (void)
+  {
+    uint32_t n = 1000;
+    std::vector<Ptr<MobilityModel> > satellites;
+    for (const Vector &pos : GetSpherePositions (n, LEO_PROP_EARTH_RAD + 550e3))
+      {
+        Ptr<ConstantPositionMobilityModel> mob = CreateObject<ConstantPositionMobilityModel> ();
+        mob->SetPosition (pos);
+        satellites.push_back (mob);
+      }
+    Ptr<ConstantPositionMobilityModel> gnd = CreateObject<ConstantPositionMobilityModel> ();
+    gnd->SetPosition (Vector (LEO_PROP_EARTH_RAD, 0, 0));
+
+    uint32_t rounds = 2000;
+    double elevation = 40.0;
+
+    uint64_t legacyHits = 0;
+    Stopwatch legacyWatch;
+    for (uint32_t r = 0; r < rounds; r ++)
+      {
+        for (Ptr<MobilityModel> sat : satellites)
+          {
+            Ptr<MobilityModel> a = gnd;
+            Ptr<MobilityModel> b = sat;
+            Ptr<MobilityModel> s = a->GetPosition ().GetLength () > b->GetPosition ().GetLength () ? a : b;
+            double distance = a->GetDistanceFrom (b);
+            double hs = s->GetPosition ().GetLength ();
+            double angle = elevation * (M_PI/180.0);
+            double qa = 1 + tan (angle) * tan (angle);
+            double qb = 2.0 * tan (angle) * hs;
+            double qc = hs*hs - LEO_PROP_EARTH_RAD*LEO_PROP_EARTH_RAD;
+            double disc = qb*qb + 4*qa*qc;
+            double t1 = (-qb - sqrt (disc)) / (2.0 * qa);
+            double t2 = (-qb + sqrt (disc)) / (2.0 * qa);
+            double cutOff = fmin (Vector2D (t1, - tan (angle) * t1).GetLength (),
+                                  Vector2D (t2, - tan (angle) * t2).GetLength ());
+            if (distance <= cutOff)
+              {
+                legacyHits ++;
+              }
+          }
+      }
+    double legacyNs = legacyWatch.GetNs ();
+    Report ("leo-propagation/legacy", legacyNs, (uint64_t) rounds * n, "call");
+
+    for (uint32_t size : { 0, 64 })
+      {
+        Ptr<LeoPropagationLossModel> model = CreateObject<LeoPropagationLossModel> ();
+        model->SetAttribute ("ElevationAngle", DoubleValue (elevation));
+        model->SetAttribute ("CutoffCacheSize", UintegerValue (size));
+
+        uint64_t hits = 0;
+        Stopwatch watch;
+        for (uint32_t r = 0; r < rounds; r ++)
+          {
+            for (Ptr<MobilityModel> sat : satellites)
+              {
+                if (model->CalcRxPower (0.0, gnd, sat) > -500.0)
+                  {
+                    hits ++;
+                  }
+              }
+          }
+        double ns = watch.GetNs ();
+
+        std::ostringstream name;
+        name << "leo-propagation/cache-" << size;
+        Report (name.str (), ns, (uint64_t) rounds * n, "call");
+        NS_TEST_EXPECT_MSG_EQ (hits, legacyHits, "cached cutoff distance changes the reception");
+      }
+
+    Simulator::Destroy ();
+  }
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Line-of-sight checks per second of IslPropagationLossModel
+ *
+ * Checks every satellite of a shell against all others, once pair by pair
+ * and once with the batch kernel.
+ */
+class IslLosBenchmarkTestCase : public TestCase
+{
+public:
+  IslLosBenchmarkTestCase () : TestCase ("Single and batch line-of-sight checks") {}
+  virtual ~IslLosBenchmarkTestCase () {}
+private:
+  virtual void DoRun (void)
+  {
+    for (uint32_t n : { 1000, 5000 })
+      {
+        Run (n);
+      }
+  }
+
+  void Run (uint32_t n)
+  {
+    std::vector<Vector> positions = GetSpherePositions (n, LEO_EARTH_RAD + 550e3);
+    std::vector<double> x, y, z;
+    for (const Vector &pos : positions)
+      {
+        x.push_back (pos.x);
+        y.push_back (pos.y);
+        z.push_back (pos.z);
+      }
+
+    uint64_t singleVisible = 0;
+    Stopwatch singleWatch;
+    for (uint32_t i = 0; i < n; i ++)
+      {
+        for (uint32_t j = 0; j < n; j ++)
+          {
+            singleVisible += IslPropagationLossModel::GetLos (positions[i], positions[j]);
+          }
+      }
+    double singleNs = singleWatch.GetNs ();
+
+    uint64_t batchVisible = 0;
+    std::vector<uint64_t> mask ((n + 63) / 64);
+    Stopwatch batchWatch;
+    for (uint32_t i = 0; i < n; i ++)
+      {
+        IslPropagationLossModel::GetLos (positions[i], x.data (), y.data (), z.data (), n, mask.data ());
+        for (uint64_t word : mask)
+          {
+            batchVisible += __builtin_popcountll (word);
+          }
+      }
+    double batchNs = batchWatch.GetNs ();
+
+    std::ostringstream name;
+    name << "isl-los/" << n << "/single";
+    Report (name.str (), singleNs, (uint64_t) n * n, "check");
+    name.str ("");
+    name << "isl-los/" << n << "/batch";
+    Report (name.str (), batchNs, (uint64_t) n * n, "check");
+
+    NS_TEST_EXPECT_MSG_EQ (batchVisible, singleVisible, "batch and single checks differ");
+  }
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Setup time and size of the ARP tables of ArpCacheHelper
+ *
+ * The number of entries is reported along with the time, it should grow
+ * linearly with the number of devices.
+ */
+class ArpCacheBenchmarkTestCase : public TestCase
+{
+public:
+  ArpCacheBenchmarkTestCase () : TestCase ("ARP cache pre-population") {}
+  virtual ~ArpCacheBenchmarkTestCase () {}
+private:
+  virtual void DoRun (void)
+  {
+    for (uint32_t n : { 1000, 4000 })
+      {
+        Run (n, n / 10);
+      }
+  }
+
+  void Run (uint32_t satellites, uint32_t stations)
+  {
+    NodeContainer satNodes;
+    satNodes.Create (satellites);
+    NodeContainer gndNodes;
+    gndNodes.Create (stations);
+
+    LeoChannelHelper utCh;
+    NetDeviceContainer devices = utCh.Install (satNodes, gndNodes);
+    InternetStackHelper stack;
+    stack.Install (satNodes);
+    stack.Install (gndNodes);
+    Ipv4AddressHelper address;
+    address.SetBase ("10.0.0.0", "255.0.0.0");
+    Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+    ArpCacheHelper arpCache;
+    Stopwatch watch;
+    arpCache.Install (devices, interfaces);
+    double ns = watch.GetNs ();
+
+    std::ostringstream name;
+    name << "arp-cache/" << satellites << "+" << stations;
+    Report (name.str (), ns, devices.GetN (), "device");
+
+    // the tables are shared by the devices of each side
+    Ptr<MockArpTable> satTable = DynamicCast<MockNetDevice> (devices.Get (0))->GetArpTable ();
+    Ptr<MockArpTable> gndTable = DynamicCast<MockNetDevice> (devices.Get (satellites))->GetArpTable ();
+    std::cout << name.str () << ": " << satTable->GetN () + gndTable->GetN () << " table entries" << std::endl;
+    NS_TEST_EXPECT_MSG_EQ (satTable->GetN () + gndTable->GetN (), devices.GetN (), "tables are not linear in the number of devices");
+
+    Simulator::Destroy ();
+  }
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Startup time of the Starlink and Telesat constellations
+ *
+ * Each phase of the setup is reported separately, so that the helper that
+ * dominates the startup can be identified.
+ */
+class ConstellationStartupBenchmarkTestCase : public TestCase
+{
+public:
+  ConstellationStartupBenchmarkTestCase () : TestCase ("Constellation startup")
+  {
+    SetDataDir (NS_TEST_SOURCEDIR);
+  }
+  virtual ~ConstellationStartupBenchmarkTestCase () {}
+private:
+  virtual void DoRun (void)
+  {
+    ReportProfile ();
+    Run ("starlink", 100);
+    Run ("telesat", 100);
+  }
+
+  void Run (std::string constellation, uint32_t stations)
+  {
+    Stopwatch total;
+
+    Stopwatch watch;
+    LeoOrbitNodeHelper orbit;
+    NodeContainer satellites = orbit.Install (CreateDataDirFilename ("../data/orbits/" + constellation + ".csv"));
+    Report ("startup/" + constellation + "/orbit-nodes", watch.GetNs (), satellites.GetN (), "node");
+
+    NodeContainer ground;
+    ground.Create (stations);
+
+    watch = Stopwatch ();
+    LeoChannelHelper utCh;
+    NetDeviceContainer utNet = utCh.Install (satellites, ground);
+    Report ("startup/" + constellation + "/leo-channel", watch.GetNs (), utNet.GetN (), "device");
+
+    watch = Stopwatch ();
+    IslHelper islCh;
+    NetDeviceContainer islNet = islCh.Install (satellites);
+    Report ("startup/" + constellation + "/isl", watch.GetNs (), islNet.GetN (), "device");
+
+    watch = Stopwatch ();
+    InternetStackHelper stack;
+    stack.Install (satellites);
+    stack.Install (ground);
+    Report ("startup/" + constellation + "/internet-stack", watch.GetNs (), satellites.GetN () + stations, "node");
+
+    Report ("startup/" + constellation + "/total", total.GetNs (), satellites.GetN () + stations, "node");
+
+    NS_TEST_ASSERT_MSG_GT (satellites.GetN (), 0, "constellation has no satellites");
+
+    Simulator::Destroy ();
+  }
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Compares relaying between two ground stations at layer 2 and by
+ * IPv4 forwarding on the satellite
+ *
+ * Both ground stations are below the same satellite. The wall time of the
+ * whole simulation is reported per packet, including the ARP exchange.
+ */
+class LeoL2RelayBenchmarkTestCase : public TestCase
+{
+public:
+  LeoL2RelayBenchmarkTestCase () : TestCase ("Relay by layer 2 and by IPv4 forwarding") {}
+  virtual ~LeoL2RelayBenchmarkTestCase () {}
+private:
+  virtual void DoRun (void)
+  {
+    for (uint32_t n : { 100, 1000, 4000 })
+      {
+        Run (n, false);
+        Run (n, true);
+      }
+  }
+
+  void Run (uint32_t n, bool relay)
+  {
+    double radius = LEO_PROP_EARTH_RAD + 550e3;
+    std::vector<Vector> positions = GetSpherePositions (n, radius);
+    // both stations are within a few km of the point below the first satellite
+    Vector below = Vector (positions[0].x * LEO_PROP_EARTH_RAD / radius,
+                           positions[0].y * LEO_PROP_EARTH_RAD / radius,
+                           positions[0].z * LEO_PROP_EARTH_RAD / radius);
+    positions.push_back (below);
+    positions.push_back (Vector (below.x, below.y, below.z + 5e3));
+
+    NodeContainer satellites;
+    satellites.Create (n);
+    NodeContainer stations;
+    stations.Create (2);
+    NodeContainer nodes (satellites, stations);
+    for (uint32_t i = 0; i < nodes.GetN (); i ++)
+      {
+        Ptr<ConstantPositionMobilityModel> mob = CreateObject<ConstantPositionMobilityModel> ();
+        mob->SetPosition (positions[i]);
+        nodes.Get (i)->AggregateObject (mob);
+      }
+
+    LeoChannelHelper utCh;
+    utCh.SetGndDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+    utCh.SetSatDeviceAttribute ("DataRate", StringValue ("1Gbps"));
+    NetDeviceContainer devices = utCh.Install (satellites, stations);
+    NetDeviceContainer gndDevices;
+    gndDevices.Add (devices.Get (n));
+    gndDevices.Add (devices.Get (n + 1));
+
+    InternetStackHelper stack;
+    stack.Install (stations);
+    Ipv4AddressHelper address;
+    address.SetBase ("10.0.0.0", "255.0.0.0");
+    Ipv4InterfaceContainer interfaces;
+    if (relay)
+      {
+        LeoL2RelayHelper relayHelper;
+        relayHelper.Install (devices);
+        interfaces = address.Assign (gndDevices);
+      }
+    else
+      {
+        stack.Install (satellites);
+        Ipv4InterfaceContainer satInterfaces = address.Assign (devices);
+        interfaces.Add (satInterfaces.Get (n));
+        interfaces.Add (satInterfaces.Get (n + 1));
+        Ipv4Address gateway = satInterfaces.GetAddress (0);
+        Ipv4StaticRoutingHelper routing;
+        for (uint32_t i = 0; i < 2; i ++)
+          {
+            Ptr<Ipv4StaticRouting> table = routing.GetStaticRouting (stations.Get (i)->GetObject<Ipv4> ());
+            table->AddHostRouteTo (interfaces.GetAddress (1 - i), gateway, 1);
+          }
+      }
+
+    uint32_t packets = 10000;
+    UdpServerHelper server (9);
+    ApplicationContainer serverApps = server.Install (stations.Get (1));
+    UdpClientHelper client (interfaces.GetAddress (1), 9);
+    client.SetAttribute ("MaxPackets", UintegerValue (packets));
+    client.SetAttribute ("Interval", TimeValue (MicroSeconds (100)));
+    client.SetAttribute ("PacketSize", UintegerValue (1000));
+    client.Install (stations.Get (0));
+    Simulator::Stop (Seconds (2.0));
+
+    Stopwatch watch;
+    Simulator::Run ();
+    double ns = watch.GetNs ();
+
+    std::ostringstream name;
+    name << (relay ? "relay/l2/" : "relay/ipv4-forwarding/") << n;
+    Report (name.str (), ns, packets, "packet");
+
+    uint64_t received = DynamicCast<UdpServer> (serverApps.Get (0))->GetReceived ();
+    NS_TEST_EXPECT_MSG_EQ (received, packets, "packets have been lost");
+
+    Simulator::Destroy ();
+  }
+};
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Performance tests and microbenchmarks
+ *
+ * Results are written to the standard output.
+ */
+class LeoPerformanceTestSuite : public TestSuite
+{
+public:
+  LeoPerformanceTestSuite ();
+};
+
+LeoPerformanceTestSuite::LeoPerformanceTestSuite ()
+  : TestSuite ("leo-performance", PERFORMANCE)
+{
+  AddTestCase (new LeoDeviceTableBenchmarkTestCase, TestCase::EXTENSIVE);
+  AddTestCase (new LeoPropagatorBenchmarkTestCase, TestCase::EXTENSIVE);
+  AddTestCase (new LeoPropagationBenchmarkTestCase, TestCase::EXTENSIVE);
+  AddTestCase (new IslLosBenchmarkTestCase, TestCase::EXTENSIVE);
+  AddTestCase (new ArpCacheBenchmarkTestCase, TestCase::EXTENSIVE);
+  AddTestCase (new ConstellationStartupBenchmarkTestCase, TestCase::EXTENSIVE);
+  AddTestCase (new LeoL2RelayBenchmarkTestCase, TestCase::EXTENSIVE);
+}
+
+static LeoPerformanceTestSuite leoPerformanceTestSuite;
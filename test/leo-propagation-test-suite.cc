@@ -139,6 +139,51 @@ private:
   }
 };
 
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Unit tests
+ */
+class LeoPropagationCutoffCacheTestCase : public TestCase
+{
+public:
+  LeoPropagationCutoffCacheTestCase () : TestCase ("cached cutoff distances do not change the reception") {}
+  virtual ~LeoPropagationCutoffCacheTestCase () {}
+private:
+  void DoRun ()
+  {
+    Ptr<LeoPropagationLossModel> cached = CreateObject<LeoPropagationLossModel> ();
+    cached->SetAttribute ("CutoffCacheSize", UintegerValue (4));
+    Ptr<LeoPropagationLossModel> exact = CreateObject<LeoPropagationLossModel> ();
+    exact->SetAttribute ("CutoffCacheSize", UintegerValue (0));
+
+    Ptr<ConstantPositionMobilityModel> gnd = CreateObject<ConstantPositionMobilityModel> ();
+    gnd->SetPosition (Vector3D (LEO_PROP_EARTH_RAD, 0, 0));
+    Ptr<ConstantPositionMobilityModel> sat = CreateObject<ConstantPositionMobilityModel> ();
+
+    // more satellite radii than entries in the cache
+    for (double altitude : { 550e3, 1150e3, 550e3, 340e3, 1325e3, 550e3 })
+      {
+        for (double angle = 0; angle < M_PI / 4; angle += M_PI / 200)
+          {
+            double r = LEO_PROP_EARTH_RAD + altitude;
+            sat->SetPosition (Vector3D (r * cos (angle), r * sin (angle), 0));
+            NS_TEST_EXPECT_MSG_EQ (cached->CalcRxPower (1.0, gnd, sat), exact->CalcRxPower (1.0, gnd, sat),
+                                   "different reception at altitude " << altitude << " and angle " << angle);
+          }
+      }
+
+    // directly above is always in range, but not too far off the zenith
+    double r = LEO_PROP_EARTH_RAD + 550e3;
+    sat->SetPosition (Vector3D (r * cos (0.1), r * sin (0.1), 0));
+    cached->SetAttribute ("ElevationAngle", DoubleValue (10.0));
+    NS_TEST_ASSERT_MSG_EQ (cached->CalcRxPower (1.0, gnd, sat), 1.0, "no reception at low elevation angle");
+    cached->SetAttribute ("ElevationAngle", DoubleValue (60.0));
+    NS_TEST_ASSERT_MSG_LT (cached->CalcRxPower (1.0, gnd, sat), -500.0, "cache not cleared for new elevation angle");
+  }
+};
+
 /**
  * \ingroup leo-test
  * \ingroup tests
@@ -159,6 +204,7 @@ LeoPropagationTestSuite::LeoPropagationTestSuite ()
   AddTestCase (new LeoPropagationRxLosTestCase, TestCase::QUICK);
   AddTestCase (new LeoPropagationBadAngleTestCase, TestCase::QUICK);
   AddTestCase (new LeoPropagationLossTestCase, TestCase::QUICK);
+  AddTestCase (new LeoPropagationCutoffCacheTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
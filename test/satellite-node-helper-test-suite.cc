@@ -114,6 +114,80 @@ SingleSatNodeHelperTestCase::DoRun (void)
   NS_ASSERT_MSG (mob != Ptr<MobilityModel> (), "Mobility model is valid");
 }
 
+// ------------------------------------------------------------------------- //
+
+/**
+ * \ingroup leo-test
+ * \ingroup tests
+ *
+ * \brief Test that streamed waypoints yield the same positions as loaded ones
+ */
+class StreamingSatNodeHelperTestCase : public TestCase
+{
+public:
+  StreamingSatNodeHelperTestCase ();
+  virtual ~StreamingSatNodeHelperTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Compare the positions of both models
+   * \param loaded model with all waypoints
+   * \param streamed model with a window of waypoints
+   */
+  void Compare (Ptr<MobilityModel> loaded, Ptr<LeoStreamingWaypointMobilityModel> streamed);
+};
+
+StreamingSatNodeHelperTestCase::StreamingSatNodeHelperTestCase ()
+  : TestCase ("Streamed waypoint file")
+{
+}
+
+StreamingSatNodeHelperTestCase::~StreamingSatNodeHelperTestCase ()
+{
+}
+
+void
+StreamingSatNodeHelperTestCase::Compare (Ptr<MobilityModel> loaded, Ptr<LeoStreamingWaypointMobilityModel> streamed)
+{
+  Vector expected = loaded->GetPosition ();
+  Vector actual = streamed->GetPosition ();
+  NS_TEST_EXPECT_MSG_EQ_TOL (actual.x, expected.x, 1e-3, "Same x at " << Simulator::Now ());
+  NS_TEST_EXPECT_MSG_EQ_TOL (actual.y, expected.y, 1e-3, "Same y at " << Simulator::Now ());
+  NS_TEST_EXPECT_MSG_EQ_TOL (actual.z, expected.z, 1e-3, "Same z at " << Simulator::Now ());
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (streamed->GetNWaypoints (), 4, "Window is bounded");
+}
+
+void
+StreamingSatNodeHelperTestCase::DoRun (void)
+{
+  std::vector<std::string> satWps =
+    {
+      "contrib/leo/data/test/waypoints.txt"
+    };
+
+  LeoSatNodeHelper satHelper;
+  NodeContainer loaded = satHelper.Install (satWps);
+
+  satHelper.SetStreaming (true);
+  NodeContainer streamed = satHelper.Install (satWps);
+
+  Ptr<MobilityModel> loadedMob = loaded.Get (0)->GetObject<MobilityModel> ();
+  Ptr<LeoStreamingWaypointMobilityModel> streamedMob = streamed.Get (0)->GetObject<LeoStreamingWaypointMobilityModel> ();
+  NS_TEST_ASSERT_MSG_NE (streamedMob, 0, "Streaming mobility model is installed");
+  streamedMob->SetAttribute ("WindowSize", UintegerValue (4));
+
+  // before the first waypoint, between waypoints, on a waypoint and after
+  // the last waypoint
+  for (double t : { 0.5, 2.0, 10.7, 11.574010, 500.3, 6000.0, 8000.0 })
+    {
+      Simulator::Schedule (Seconds (t), &StreamingSatNodeHelperTestCase::Compare, this, loadedMob, streamedMob);
+    }
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
 /**
  * \ingroup leo-test
  * \ingroup tests
@@ -132,6 +206,7 @@ SatNodeHelperTestSuite::SatNodeHelperTestSuite ()
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new EmptySatNodeHelperTestCase, TestCase::QUICK);
   AddTestCase (new SingleSatNodeHelperTestCase, TestCase::QUICK);
+  AddTestCase (new StreamingSatNodeHelperTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite